@@ -0,0 +1,349 @@
+/*
+ * ============================================================================
+ * FBXB BINARY FORMAT (v3) SPECIFICATION
+ * ============================================================================
+ *
+ * Every section starts on a 16-byte boundary and every offset is absolute from
+ * the start of the file, so a reader can map the file and point straight at
+ * any array without parsing what comes before it. All values little-endian.
+ *
+ * [ HEADER ]
+ * +--------------+----------+------------------------------------------------+
+ * | Magic        | char[4]  | "FBXB"                                         |
+ * | Version      | uint32   | 3                                              |
+ * | SectionCount | uint32   | Entries in the section table                   |
+ * | Flags        | uint32   | 0                                              |
+ * +--------------+----------+------------------------------------------------+
+ *
+ * [ SECTION TABLE ] x SectionCount (BinarySectionEntry, 32 bytes)
+ * +--------------+----------+------------------------------------------------+
+ * | Tag          | char[4]  | MATL, STRS, NODE, GEOM, DATA, MSLT, LODS       |
+ * | Flags        | uint32   | 0                                              |
+ * | Offset       | uint64   | Absolute, 16-byte aligned                      |
+ * | Size         | uint64   | Bytes                                          |
+ * | Reserved     | uint64   | 0                                              |
+ * +--------------+----------+------------------------------------------------+
+ *
+ * [ MATL ] Material count (uint64) followed by v2 material blocks.
+ * [ STRS ] Node names, referenced by offset/length from NODE records.
+ *
+ * [ NODE ] / [ GEOM ] tables
+ * +--------------+----------+------------------------------------------------+
+ * | Count        | uint32   | Number of records                              |
+ * | RecordSize   | uint32   | Stride; readers ignore trailing bytes          |
+ * | StreamCount  | uint32   | GEOM only: stream descriptors per record       |
+ * | Reserved     | uint32   | 0                                              |
+ * +--------------+----------+------------------------------------------------+
+ * | Records[Count]                                                          |
+ *
+ * NODE records (BinaryNodeRecord) are in DFS order, parents before children.
+ * Several nodes may name the same GeometryIndex; instanced meshes are stored
+ * once and records are numbered in order of first reference.
+ * GEOM records (BinaryGeometryRecord) are StreamCount BinaryStreamDesc
+ * entries, one per BinaryStream value, pointing into DATA, followed by the
+ * local-space bounds of the positions. Absent streams have Count 0. A
+ * RecordSize of exactly StreamCount * 32 means the record carries no bounds.
+ *
+ * NODE, GEOM and STRS together form the table of contents: hierarchy,
+ * transforms, bounds and the byte range of every stream are known without
+ * touching DATA, so geometry can be paged in per node on demand.
+ *
+ * [ DATA ] Stream payloads, each 16-byte aligned.
+ *
+ * [ MSLT ] Optional; written only when meshes were cooked with meshlets and
+ * skipped by readers that do not know the tag. Two tables with the NODE/GEOM
+ * header (StreamCount 0), back to back:
+ *   1. One BinaryMeshletRange per GEOM record: the first meshlet and the
+ *      meshlet count of that geometry in table 2.
+ *   2. BinaryMeshletRecords. A geometry's meshlets are sorted by IndexOffset,
+ *      each covers whole triangles of a single submesh, and together they
+ *      cover every submesh index of the geometry (not LOD indices).
+ *      Center/Radius bound the meshlet in local space; ConeAxis/ConeCutoff
+ *      are its normal cone, with a zero axis and cutoff 1 when the cone is
+ *      too wide to ever cull.
+ *
+ * [ LODS ] Optional; written only when meshes were cooked with LODs. Same
+ * layout as MSLT:
+ *   1. One BinaryLodRange per GEOM record: the first level and the level
+ *      count of that geometry in table 2.
+ *   2. BinaryLodRecords sorted by SubMeshIndex, then Level (1 up to
+ *      BinaryMaxLodLevel, each at most once; level 0 is the submesh itself). Each is a simplified index list of that
+ *      submesh, stored in the Indices stream after every submesh's indices.
+ *      Error is the object-space deviation from the submesh, so a viewer can
+ *      project it to pixels and pick a level per instance.
+ *
+ * A stream with Encoding ChunkedLz is split into ChunkSize pieces (the last
+ * one shorter) that are compressed independently with LzCodec, so a reader
+ * can decode them in parallel. ByteSize stays the decoded size; Offset points
+ * at a chunk table instead of the payload:
+ * +--------------+----------+------------------------------------------------+
+ * | ChunkCount   | uint32   | ceil(ByteSize / ChunkSize)                     |
+ * | ChunkSize    | uint32   | Decoded bytes per chunk, multiple of 4         |
+ * | Reserved     | uint64   | 0                                              |
+ * +--------------+----------+------------------------------------------------+
+ * | [ Chunk ] x ChunkCount (BinaryChunkEntry, 16 bytes)                     |
+ * |  | Offset     | uint64 | Absolute offset of the stored bytes            |
+ * |  | StoredSize | uint32 | Equal to RawSize: stored verbatim              |
+ * |  | RawSize    | uint32 | Decoded bytes                                  |
+ * +--------------+----------+------------------------------------------------+
+ * Compressed chunks hold the LZ block of the chunk after Shuffle4, which
+ * groups the n-th byte of every 32-bit word together; bytes after the last
+ * whole word follow unshuffled. SubMeshes are always Raw so the hierarchy can
+ * be loaded without decoding anything.
+ *
+ * QUANTISED VERTEX STREAMS
+ * A writer may store a vertex stream in a smaller Format than its float one,
+ * chosen per stream from the values it holds. Readers must accept both:
+ * +--------------+------------+----------------------------------------------+
+ * | Normals,     | OctSnorm16 | Unit vector folded onto an octahedron, x and |
+ * | Tangents,    |            | y as int16 / 32767                           |
+ * | Bitangents   |            |                                              |
+ * | TexCoordN    | Unorm16x2  | Every value in [0, 1]; uint16 / 65535        |
+ * | TexCoordN    | Half2      | Every value within +-2; IEEE half floats     |
+ * | Colors       | Unorm8x4   | Every value in [0, 1]; uint8 / 255           |
+ * | BoneWeights  | Unorm8x4   | uint8 / 255, renormalised to sum to 255      |
+ * | BoneIndices  | Uint8x4    | Every index below 256                        |
+ * +--------------+------------+----------------------------------------------+
+ * Positions stay Float3.
+ *
+ * 16-BIT INDICES
+ * The Indices stream is Uint32, or Uint16 when every submesh fits. Each
+ * BinarySubMeshRecord carries a BaseVertex: index I of the submesh, and of
+ * its LOD levels and meshlets, refers to vertex BaseVertex + I. Files with
+ * Uint32 indices may leave it 0; with Uint16 a writer picks it per submesh so
+ * that no submesh spans more than 65536 vertices.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "NumericTypes.h"
+
+namespace asset {
+    inline constexpr std::array<char, 4> BinaryMagic{ 'F', 'B', 'X', 'B' };
+    inline constexpr std::size_t BinarySectionAlignment{ 16 };
+    inline constexpr std::uint32_t BinaryNoGeometry{ 0xFFFFFFFFu };
+    // Highest BinaryLodRecord::Level a reader accepts.
+    inline constexpr std::uint32_t BinaryMaxLodLevel{ 16 };
+
+    constexpr std::uint32_t MakeBinaryTag(char A, char B, char C, char D) {
+        return static_cast<std::uint32_t>(static_cast<std::uint8_t>(A))
+            | (static_cast<std::uint32_t>(static_cast<std::uint8_t>(B)) << 8)
+            | (static_cast<std::uint32_t>(static_cast<std::uint8_t>(C)) << 16)
+            | (static_cast<std::uint32_t>(static_cast<std::uint8_t>(D)) << 24);
+    }
+
+    enum class BinarySection : std::uint32_t {
+        Materials  = MakeBinaryTag('M', 'A', 'T', 'L'),
+        Strings    = MakeBinaryTag('S', 'T', 'R', 'S'),
+        Nodes      = MakeBinaryTag('N', 'O', 'D', 'E'),
+        Geometries = MakeBinaryTag('G', 'E', 'O', 'M'),
+        Data       = MakeBinaryTag('D', 'A', 'T', 'A'),
+        Meshlets   = MakeBinaryTag('M', 'S', 'L', 'T'),
+        Lods       = MakeBinaryTag('L', 'O', 'D', 'S'),
+    };
+
+    enum class BinaryStream : std::uint32_t {
+        Positions,
+        Normals,
+        TexCoord0,
+        TexCoord1,
+        TexCoord2,
+        TexCoord3,
+        Colors,
+        Tangents,
+        Bitangents,
+        BoneIndices,
+        BoneWeights,
+        Indices,
+        SubMeshes,
+        Count,
+    };
+
+    enum class BinaryEncoding : std::uint16_t {
+        Raw       = 0,
+        ChunkedLz = 1,
+    };
+
+    enum class BinaryElementFormat : std::uint16_t {
+        None       = 0,
+        Float2     = 1,
+        Float3     = 2,
+        Float4     = 3,
+        Uint4      = 4,
+        Uint32     = 5,
+        SubMesh    = 6,
+        // Quantised vertex formats, four bytes per element; see QUANTISED
+        // VERTEX STREAMS above.
+        OctSnorm16 = 7,
+        Half2      = 8,
+        Unorm16x2  = 9,
+        Unorm8x4   = 10,
+        Uint8x4    = 11,
+        // Indices only; see 16-BIT INDICES above.
+        Uint16     = 12,
+    };
+
+    struct BinaryFileHeader final {
+    public:
+        std::array<char, 4> Magic{};
+        std::uint32_t Version{ 0 };
+        std::uint32_t SectionCount{ 0 };
+        std::uint32_t Flags{ 0 };
+    };
+
+    struct BinarySectionEntry final {
+    public:
+        std::uint32_t Tag{ 0 };
+        std::uint32_t Flags{ 0 };
+        std::uint64_t Offset{ 0 };
+        std::uint64_t Size{ 0 };
+        std::uint64_t Reserved{ 0 };
+    };
+
+    struct BinaryTableHeader final {
+    public:
+        std::uint32_t Count{ 0 };
+        std::uint32_t RecordSize{ 0 };
+        std::uint32_t StreamCount{ 0 };
+        std::uint32_t Reserved{ 0 };
+    };
+
+    struct BinaryNodeRecord final {
+    public:
+        std::uint32_t NameOffset{ 0 };
+        std::uint32_t NameLength{ 0 };
+        std::int32_t ParentIndex{ -1 };
+        std::uint32_t GeometryIndex{ BinaryNoGeometry };
+        Mat4 NodeToParent{};
+        Mat4 GeometryToNode{};
+    };
+
+    struct BinaryStreamDesc final {
+    public:
+        std::uint64_t Offset{ 0 };
+        std::uint64_t Count{ 0 };
+        std::uint64_t ByteSize{ 0 };
+        BinaryEncoding Encoding{ BinaryEncoding::Raw };
+        BinaryElementFormat Format{ BinaryElementFormat::None };
+        std::uint32_t Reserved{ 0 };
+    };
+
+    struct BinaryChunkHeader final {
+    public:
+        std::uint32_t ChunkCount{ 0 };
+        std::uint32_t ChunkSize{ 0 };
+        std::uint64_t Reserved{ 0 };
+    };
+
+    struct BinaryChunkEntry final {
+    public:
+        std::uint64_t Offset{ 0 };
+        std::uint32_t StoredSize{ 0 };
+        std::uint32_t RawSize{ 0 };
+    };
+
+    struct BinarySubMeshRecord final {
+    public:
+        std::uint64_t IndexOffset{ 0 };
+        std::uint64_t IndexCount{ 0 };
+        std::uint32_t MaterialIndex{ 0 };
+        // Occupies what was the high half of a 64-bit MaterialIndex, so
+        // older files read as 0.
+        std::uint32_t BaseVertex{ 0 };
+    };
+
+    struct BinaryGeometryBounds final {
+    public:
+        Vec3 Min{};
+        std::uint32_t Reserved0{ 0 };
+        Vec3 Max{};
+        std::uint32_t Reserved1{ 0 };
+    };
+
+    struct BinaryGeometryRecord final {
+    public:
+        std::array<BinaryStreamDesc, static_cast<std::size_t>(BinaryStream::Count)> Streams{};
+        BinaryGeometryBounds Bounds{};
+    };
+
+    struct BinaryMeshletRange final {
+    public:
+        std::uint64_t FirstMeshlet{ 0 };
+        std::uint64_t MeshletCount{ 0 };
+    };
+
+    struct BinaryMeshletRecord final {
+    public:
+        std::uint64_t IndexOffset{ 0 };
+        std::uint64_t IndexCount{ 0 };
+        Vec3 Center{};
+        float Radius{ 0.0f };
+        Vec3 ConeAxis{};
+        float ConeCutoff{ 1.0f };
+    };
+
+    struct BinaryLodRange final {
+    public:
+        std::uint64_t FirstLod{ 0 };
+        std::uint64_t LodCount{ 0 };
+    };
+
+    struct BinaryLodRecord final {
+    public:
+        std::uint32_t SubMeshIndex{ 0 };
+        std::uint32_t Level{ 0 };
+        std::uint64_t IndexOffset{ 0 };
+        std::uint64_t IndexCount{ 0 };
+        float Error{ 0.0f };
+        std::uint32_t Reserved{ 0 };
+    };
+
+    constexpr std::size_t BinaryElementSize(BinaryElementFormat Format) {
+        switch (Format) {
+        case BinaryElementFormat::Float2:
+            return sizeof(Vec2);
+        case BinaryElementFormat::Float3:
+            return sizeof(Vec3);
+        case BinaryElementFormat::Float4:
+            return sizeof(Vec4);
+        case BinaryElementFormat::Uint4:
+            return sizeof(UVec4);
+        case BinaryElementFormat::Uint32:
+            return sizeof(std::uint32_t);
+        case BinaryElementFormat::Uint16:
+            return sizeof(std::uint16_t);
+        case BinaryElementFormat::SubMesh:
+            return sizeof(BinarySubMeshRecord);
+        case BinaryElementFormat::OctSnorm16:
+        case BinaryElementFormat::Half2:
+        case BinaryElementFormat::Unorm16x2:
+        case BinaryElementFormat::Unorm8x4:
+        case BinaryElementFormat::Uint8x4:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    constexpr std::uint64_t AlignBinaryOffset(std::uint64_t Offset) {
+        return (Offset + (BinarySectionAlignment - 1)) & ~static_cast<std::uint64_t>(BinarySectionAlignment - 1);
+    }
+
+    static_assert(sizeof(BinaryFileHeader) == 16);
+    static_assert(sizeof(BinarySectionEntry) == 32);
+    static_assert(sizeof(BinaryTableHeader) == 16);
+    static_assert(sizeof(BinaryNodeRecord) == 144);
+    static_assert(sizeof(BinaryStreamDesc) == 32);
+    static_assert(sizeof(BinaryChunkHeader) == 16);
+    static_assert(sizeof(BinaryChunkEntry) == 16);
+    static_assert(sizeof(BinarySubMeshRecord) == 24);
+    static_assert(sizeof(BinaryGeometryBounds) == 32);
+    static_assert(sizeof(BinaryGeometryRecord) == 448);
+    static_assert(sizeof(BinaryMeshletRange) == 16);
+    static_assert(sizeof(BinaryMeshletRecord) == 48);
+    static_assert(sizeof(BinaryLodRange) == 16);
+    static_assert(sizeof(BinaryLodRecord) == 32);
+}
@@ -6,13 +6,25 @@
 using namespace asset;
 
 namespace {
-    constexpr std::uint32_t FormatVersion{ 2 };
+    constexpr std::uint32_t LegacyFormatVersion{ 2 };
     constexpr std::array<char, 4> FormatMagic{ 'F', 'B', 'X', 'B' };
 }
 
 AssetBinaryReader::AssetBinaryReader() = default;
 
 bool AssetBinaryReader::ReadFromFile(const std::string& Path, AssetBundle& Bundle) {
+    AssetBinaryView View{};
+    if (View.Open(Path)) {
+        View.LoadHierarchy(Bundle);
+        ModelResult& Result{ Bundle.GetModelResult() };
+        for (std::uint32_t Index{ 0 }; Index < View.GetGeometryCount(); ++Index) {
+            if (!View.CopyGeometry(Index, Result.GetMesh(Index))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     mStream = std::ifstream{ Path, std::ios::binary };
     if (!mStream.is_open()) {
         return false;
@@ -26,6 +38,33 @@ bool AssetBinaryReader::ReadFromFile(const std::string& Path, AssetBundle& Bundl
     return static_cast<bool>(mStream);
 }
 
+bool AssetBinaryReader::ReadHierarchyFromFile(const std::string& Path, AssetBundle& Bundle) {
+    if (!mView.Open(Path)) {
+        return ReadFromFile(Path, Bundle);
+    }
+    mView.LoadHierarchy(Bundle);
+    return true;
+}
+
+bool AssetBinaryReader::LoadGeometry(ModelResult& Result, const ModelNode& Node) {
+    ModelMesh* Mesh{ Result.FindMesh(Node) };
+    if (Mesh == nullptr) {
+        return false;
+    }
+    if (!Mesh->Vertices().Empty()) {
+        return true;
+    }
+    // LoadHierarchy numbers meshes after the file's geometry records.
+    if (!mView.IsOpen() || !mView.CopyGeometry(Node.GetMeshIndex(), *Mesh)) {
+        return false;
+    }
+    return !Mesh->Vertices().Empty();
+}
+
+const AssetBinaryView& AssetBinaryReader::GetView() const {
+    return mView;
+}
+
 bool AssetBinaryReader::ReadHeader() {
     std::array<char, 4> Magic{};
     ReadBytes(Magic.data(), Magic.size());
@@ -33,7 +72,7 @@ bool AssetBinaryReader::ReadHeader() {
         return false;
     }
     const std::uint32_t Version{ ReadUint32() };
-    if (Version != 1 && Version != FormatVersion) {
+    if (Version != 1 && Version != LegacyFormatVersion) {
         return false;
     }
     mFormatVersion = Version;
@@ -114,26 +153,32 @@ void AssetBinaryReader::ReadNodes(ModelResult& Result, std::uint64_t NodeCount,
         ModelNode& Node{ Result.CreateNode(Name, Parent) };
         Node.SetNodeToParent(ReadMat4());
         Node.SetGeometryToNode(ReadMat4());
-        ReadVertexAttributes(Node.Vertices());
-        Node.Indices() = ReadUint32Array();
+        ModelMesh Mesh{};
+        ReadVertexAttributes(Mesh.Vertices());
+        Mesh.Indices() = ReadUint32Array();
         if (mFormatVersion == 1) {
             const std::vector<std::uint64_t> MaterialIndices{ ReadUint64Array() };
             std::size_t MaterialIndex{ 0 };
             if (!MaterialIndices.empty()) {
                 MaterialIndex = static_cast<std::size_t>(MaterialIndices.front());
             }
-            if (!Node.Indices().empty()) {
-                std::vector<ModelNode::SubMesh> SubMeshes{};
-                ModelNode::SubMesh SubMesh{};
+            if (!Mesh.Indices().empty()) {
+                std::vector<ModelMesh::SubMesh> SubMeshes{};
+                ModelMesh::SubMesh SubMesh{};
                 SubMesh.IndexOffset = 0;
-                SubMesh.IndexCount = Node.Indices().size();
+                SubMesh.IndexCount = Mesh.Indices().size();
                 SubMesh.MaterialIndex = MaterialIndex;
                 SubMeshes.push_back(SubMesh);
-                Node.SetSubMeshes(std::move(SubMeshes));
+                Mesh.SetSubMeshes(std::move(SubMeshes));
             }
         }
         else {
-            Node.SetSubMeshes(ReadSubMeshes());
+            Mesh.SetSubMeshes(ReadSubMeshes());
+        }
+        if (!Mesh.Empty()) {
+            const std::uint32_t MeshIndex{ Result.CreateMesh() };
+            Result.GetMesh(MeshIndex) = std::move(Mesh);
+            Node.SetMeshIndex(MeshIndex);
         }
         Nodes.push_back(&Node);
     }
@@ -152,12 +197,12 @@ void AssetBinaryReader::ReadVertexAttributes(VertexAttributes& Attributes) {
     Attributes.BoneWeights = ReadVec4Array();
 }
 
-std::vector<ModelNode::SubMesh> AssetBinaryReader::ReadSubMeshes() {
+std::vector<ModelMesh::SubMesh> AssetBinaryReader::ReadSubMeshes() {
     const std::uint64_t Count{ ReadUint64() };
-    std::vector<ModelNode::SubMesh> SubMeshes{};
+    std::vector<ModelMesh::SubMesh> SubMeshes{};
     SubMeshes.reserve(static_cast<std::size_t>(Count));
     for (std::uint64_t Index{ 0 }; Index < Count; ++Index) {
-        ModelNode::SubMesh SubMesh{};
+        ModelMesh::SubMesh SubMesh{};
         SubMesh.IndexOffset = static_cast<std::size_t>(ReadUint64());
         SubMesh.IndexCount = static_cast<std::size_t>(ReadUint64());
         SubMesh.MaterialIndex = static_cast<std::size_t>(ReadUint64());
@@ -3,6 +3,9 @@
  * FBXB BINARY FORMAT (v2) SPECIFICATION
  * ============================================================================
  *
+ * Current files are v3 (see AssetBinaryFormat.h) and are read through
+ * AssetBinaryView. The v1/v2 stream layout below is still accepted.
+ *
  * [ HEADER ]
  * +----------+----------+---------------------------------------------------+
  * | Magic    | char[4]  | "FBXB"                                            |
@@ -56,6 +59,9 @@
  * Version 1 stores a MaterialIndices array instead of SubMeshes. When reading
  * v1, the first material index is used to create a single SubMesh that spans
  * the full index buffer.
+ *
+ * Every node carries its own geometry, so each node with vertices is loaded
+ * into a mesh of its own.
  */
 #pragma once
 
@@ -63,6 +69,7 @@
 #include <string>
 #include <vector>
 
+#include "AssetBinaryView.h"
 #include "AssetBundle.h"
 
 namespace asset {
@@ -79,6 +86,16 @@ namespace asset {
     public:
         bool ReadFromFile(const std::string& Path, AssetBundle& Bundle);
 
+        // Loads materials, hierarchy, transforms and submeshes only and keeps a
+        // v3 file mapped so geometry can be fetched per mesh with LoadGeometry.
+        // Older files have no table of contents and are read in full.
+        bool ReadHierarchyFromFile(const std::string& Path, AssetBundle& Bundle);
+        // Copies the vertices and indices of Node's mesh into Result on first
+        // request; later requests from nodes sharing the mesh are free. Returns
+        // true when the mesh is resident afterwards.
+        bool LoadGeometry(ModelResult& Result, const ModelNode& Node);
+        const AssetBinaryView& GetView() const;
+
     private:
         bool ReadHeader();
         void ReadMaterials(std::vector<Material>& Materials);
@@ -88,7 +105,7 @@ namespace asset {
         void ReadModelResult(ModelResult& Result);
         void ReadNodes(ModelResult& Result, std::uint64_t NodeCount, std::vector<ModelNode*>& Nodes);
         void ReadVertexAttributes(VertexAttributes& Attributes);
-        std::vector<ModelNode::SubMesh> ReadSubMeshes();
+        std::vector<ModelMesh::SubMesh> ReadSubMeshes();
         std::vector<Vec2> ReadVec2Array();
         std::vector<Vec3> ReadVec3Array();
         std::vector<Vec4> ReadVec4Array();
@@ -114,5 +131,6 @@ namespace asset {
     private:
         std::ifstream mStream{};
         std::uint32_t mFormatVersion{ 0 };
+        AssetBinaryView mView{};
     };
 }
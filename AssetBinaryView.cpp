@@ -0,0 +1,794 @@
+#include "AssetBinaryView.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "AssetBinaryWriter.h"
+#include "LzCodec.h"
+
+using namespace asset;
+
+namespace {
+    constexpr std::size_t StreamCount{ static_cast<std::size_t>(BinaryStream::Count) };
+
+    constexpr std::array<BinaryElementFormat, StreamCount> ExpectedFormats{
+        BinaryElementFormat::Float3,
+        BinaryElementFormat::Float3,
+        BinaryElementFormat::Float2,
+        BinaryElementFormat::Float2,
+        BinaryElementFormat::Float2,
+        BinaryElementFormat::Float2,
+        BinaryElementFormat::Float4,
+        BinaryElementFormat::Float3,
+        BinaryElementFormat::Float3,
+        BinaryElementFormat::Uint4,
+        BinaryElementFormat::Float4,
+        BinaryElementFormat::Uint32,
+        BinaryElementFormat::SubMesh,
+    };
+
+    // Compact formats a writer may store instead of ExpectedFormats:
+    // quantised vertex streams and 16-bit indices.
+    bool IsCompactFormat(BinaryStream Stream, BinaryElementFormat Format) {
+        switch (Stream) {
+        case BinaryStream::Normals:
+        case BinaryStream::Tangents:
+        case BinaryStream::Bitangents:
+            return Format == BinaryElementFormat::OctSnorm16;
+        case BinaryStream::TexCoord0:
+        case BinaryStream::TexCoord1:
+        case BinaryStream::TexCoord2:
+        case BinaryStream::TexCoord3:
+            return Format == BinaryElementFormat::Half2 || Format == BinaryElementFormat::Unorm16x2;
+        case BinaryStream::Colors:
+        case BinaryStream::BoneWeights:
+            return Format == BinaryElementFormat::Unorm8x4;
+        case BinaryStream::BoneIndices:
+            return Format == BinaryElementFormat::Uint8x4;
+        case BinaryStream::Indices:
+            return Format == BinaryElementFormat::Uint16;
+        default:
+            return false;
+        }
+    }
+
+    // The two back-to-back tables of MSLT and LODS: one range per geometry,
+    // then the records the ranges index.
+    struct RangeTables final {
+    public:
+        const std::byte* Ranges{ nullptr };
+        std::size_t RangeStride{ 0 };
+        const std::byte* Records{ nullptr };
+        std::size_t RecordCount{ 0 };
+        std::size_t RecordStride{ 0 };
+    };
+
+    bool SplitRangeTables(std::span<const std::byte> Section, std::size_t GeometryCount, std::size_t RangeSize, std::size_t RecordSize, RangeTables& Out) {
+        BinaryTableHeader Ranges{};
+        if (Section.size() < sizeof(Ranges)) {
+            return false;
+        }
+        std::memcpy(&Ranges, Section.data(), sizeof(Ranges));
+        if (Ranges.Count != GeometryCount || Ranges.RecordSize < RangeSize || Ranges.RecordSize % BinarySectionAlignment != 0) {
+            return false;
+        }
+        const std::span<const std::byte> RangeRecords{ Section.subspan(sizeof(Ranges)) };
+        if (RangeRecords.size() / Ranges.RecordSize < Ranges.Count) {
+            return false;
+        }
+        const std::span<const std::byte> RecordTable{ RangeRecords.subspan(static_cast<std::size_t>(Ranges.Count) * Ranges.RecordSize) };
+        BinaryTableHeader Records{};
+        if (RecordTable.size() < sizeof(Records)) {
+            return false;
+        }
+        std::memcpy(&Records, RecordTable.data(), sizeof(Records));
+        if (Records.RecordSize < RecordSize || Records.RecordSize % BinarySectionAlignment != 0) {
+            return false;
+        }
+        if (Records.Count > 0 && (RecordTable.size() - sizeof(Records)) / Records.RecordSize < Records.Count) {
+            return false;
+        }
+        Out.Ranges = RangeRecords.data();
+        Out.RangeStride = Ranges.RecordSize;
+        Out.Records = RecordTable.data() + sizeof(Records);
+        Out.RecordCount = Records.Count;
+        Out.RecordStride = Records.RecordSize;
+        return true;
+    }
+
+    struct ChunkJob final {
+    public:
+        BinaryChunkEntry Entry{};
+        std::byte* Output{ nullptr };
+    };
+
+    // Bounds-checked little-endian reader for the variable-length MATL section.
+    class ByteCursor final {
+    public:
+        explicit ByteCursor(std::span<const std::byte> Bytes)
+            : mBytes{ Bytes } {
+        }
+
+        template <typename T>
+        bool Read(T& Value) {
+            if (mBytes.size() - mOffset < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&Value, mBytes.data() + mOffset, sizeof(T));
+            mOffset += sizeof(T);
+            return true;
+        }
+
+        bool ReadString(std::string& Value) {
+            std::uint64_t Length{ 0 };
+            if (!Read(Length) || mBytes.size() - mOffset < Length) {
+                return false;
+            }
+            Value.assign(reinterpret_cast<const char*>(mBytes.data() + mOffset), static_cast<std::size_t>(Length));
+            mOffset += static_cast<std::size_t>(Length);
+            return true;
+        }
+
+    private:
+        std::span<const std::byte> mBytes{};
+        std::size_t mOffset{ 0 };
+    };
+
+    template <typename T>
+    bool ReadMaterialValue(ByteCursor& Cursor, MaterialMap& Map) {
+        T Value{};
+        if (!Cursor.Read(Value)) {
+            return false;
+        }
+        Map = MaterialMap{ Value };
+        return true;
+    }
+
+    bool ReadMaterialMap(ByteCursor& Cursor, MaterialMapKind Kind, MaterialMap& Map) {
+        if (Kind == MaterialMapKind::None) {
+            Map = MaterialMap{};
+            return true;
+        }
+        if (Kind == MaterialMapKind::Real) {
+            return ReadMaterialValue<float>(Cursor, Map);
+        }
+        if (Kind == MaterialMapKind::Int) {
+            return ReadMaterialValue<std::int64_t>(Cursor, Map);
+        }
+        if (Kind == MaterialMapKind::Bool) {
+            std::uint8_t Value{ 0 };
+            if (!Cursor.Read(Value)) {
+                return false;
+            }
+            Map = MaterialMap{ Value != 0 };
+            return true;
+        }
+        if (Kind == MaterialMapKind::Vec2) {
+            return ReadMaterialValue<Vec2>(Cursor, Map);
+        }
+        if (Kind == MaterialMapKind::Vec3) {
+            return ReadMaterialValue<Vec3>(Cursor, Map);
+        }
+        if (Kind == MaterialMapKind::Vec4) {
+            return ReadMaterialValue<Vec4>(Cursor, Map);
+        }
+        if (Kind == MaterialMapKind::String) {
+            std::string Value{};
+            if (!Cursor.ReadString(Value)) {
+                return false;
+            }
+            Map = MaterialMap{ std::move(Value) };
+            return true;
+        }
+        return false;
+    }
+}
+
+AssetBinaryView::AssetBinaryView() = default;
+
+bool AssetBinaryView::Open(const std::string& Path) {
+    Close();
+    if (!mFile.Open(Path) || !IsBinaryV3(mFile.Bytes()) || !ReadSections()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void AssetBinaryView::Close() {
+    mFile.Close();
+    mMaterials.clear();
+    mNodeRecords = nullptr;
+    mNodeCount = 0;
+    mNodeStride = 0;
+    mStrings = nullptr;
+    mGeometryRecords = nullptr;
+    mGeometryCount = 0;
+    mGeometryStride = 0;
+    mStreamCount = 0;
+    mHasBounds = false;
+    mMeshletRanges = nullptr;
+    mMeshletRangeStride = 0;
+    mMeshletRecords = nullptr;
+    mMeshletCount = 0;
+    mMeshletStride = 0;
+    mLodRanges = nullptr;
+    mLodRangeStride = 0;
+    mLodRecords = nullptr;
+    mLodCount = 0;
+    mLodStride = 0;
+    mHasCompressedStreams = false;
+    mDecoded.clear();
+}
+
+bool AssetBinaryView::IsOpen() const {
+    return mFile.IsOpen();
+}
+
+void AssetBinaryView::SetThreadPool(std::shared_ptr<ThreadPool> Pool) {
+    mThreadPool = std::move(Pool);
+}
+
+ThreadPool& AssetBinaryView::AcquireThreadPool() {
+    if (mThreadPool == nullptr) {
+        mThreadPool = std::make_shared<ThreadPool>(ThreadPool::DefaultWorkerCount());
+    }
+    return *mThreadPool;
+}
+
+const std::vector<Material>& AssetBinaryView::GetMaterials() const {
+    return mMaterials;
+}
+
+std::size_t AssetBinaryView::GetNodeCount() const {
+    return mNodeCount;
+}
+
+std::string_view AssetBinaryView::GetNodeName(std::size_t NodeIndex) const {
+    const BinaryNodeRecord Record{ GetNodeRecord(NodeIndex) };
+    return std::string_view{ mStrings + Record.NameOffset, Record.NameLength };
+}
+
+std::int32_t AssetBinaryView::GetParentIndex(std::size_t NodeIndex) const {
+    return GetNodeRecord(NodeIndex).ParentIndex;
+}
+
+Mat4 AssetBinaryView::GetNodeToParent(std::size_t NodeIndex) const {
+    return GetNodeRecord(NodeIndex).NodeToParent;
+}
+
+Mat4 AssetBinaryView::GetGeometryToNode(std::size_t NodeIndex) const {
+    return GetNodeRecord(NodeIndex).GeometryToNode;
+}
+
+bool AssetBinaryView::HasGeometry(std::size_t NodeIndex) const {
+    return GetNodeRecord(NodeIndex).GeometryIndex != BinaryNoGeometry;
+}
+
+std::uint32_t AssetBinaryView::GetGeometryIndex(std::size_t NodeIndex) const {
+    return GetNodeRecord(NodeIndex).GeometryIndex;
+}
+
+std::size_t AssetBinaryView::GetGeometryCount() const {
+    return mGeometryCount;
+}
+
+GeometryView AssetBinaryView::GetGeometry(std::uint32_t GeometryIndex) {
+    GeometryView View{};
+    if (GeometryIndex >= mGeometryCount || !DecodeGeometry(GeometryIndex)) {
+        return View;
+    }
+    View.Vertices.Positions = StreamSpan<Vec3>(GeometryIndex, BinaryStream::Positions);
+    View.Vertices.Normals = StreamSpan<Vec3>(GeometryIndex, BinaryStream::Normals);
+    for (std::size_t Index{ 0 }; Index < View.Vertices.TexCoords.size(); ++Index) {
+        View.Vertices.TexCoords[Index] = StreamSpan<Vec2>(GeometryIndex, static_cast<BinaryStream>(static_cast<std::size_t>(BinaryStream::TexCoord0) + Index));
+    }
+    View.Vertices.Colors = StreamSpan<Vec4>(GeometryIndex, BinaryStream::Colors);
+    View.Vertices.Tangents = StreamSpan<Vec3>(GeometryIndex, BinaryStream::Tangents);
+    View.Vertices.Bitangents = StreamSpan<Vec3>(GeometryIndex, BinaryStream::Bitangents);
+    View.Vertices.BoneIndices = StreamSpan<UVec4>(GeometryIndex, BinaryStream::BoneIndices);
+    View.Vertices.BoneWeights = StreamSpan<Vec4>(GeometryIndex, BinaryStream::BoneWeights);
+    View.Indices = StreamSpan<std::uint32_t>(GeometryIndex, BinaryStream::Indices);
+    if (GetStream(GeometryIndex, BinaryStream::Indices).Format == BinaryElementFormat::Uint16) {
+        const std::span<const std::byte> Bytes{ StreamBytes(GeometryIndex, BinaryStream::Indices) };
+        View.ShortIndices = std::span<const std::uint16_t>{ reinterpret_cast<const std::uint16_t*>(Bytes.data()), Bytes.size() / sizeof(std::uint16_t) };
+    }
+    View.SubMeshes = StreamSpan<BinarySubMeshRecord>(GeometryIndex, BinaryStream::SubMeshes);
+    for (std::size_t Stream{ 0 }; Stream < VertexStreamCount; ++Stream) {
+        const BinaryStream Kind{ static_cast<BinaryStream>(Stream) };
+        const std::span<const std::byte> Bytes{ StreamBytes(GeometryIndex, Kind) };
+        if (!Bytes.empty()) {
+            View.Packed.Streams[Stream] = PackedVertexStream{ Bytes, GetStream(GeometryIndex, Kind).Format };
+        }
+    }
+    return View;
+}
+
+void AssetBinaryView::ReleaseGeometry(std::uint32_t GeometryIndex) {
+    if (GeometryIndex >= mGeometryCount) {
+        return;
+    }
+    for (std::unique_ptr<std::byte[]>& Stream : mDecoded[GeometryIndex]) {
+        Stream.reset();
+    }
+}
+
+std::optional<BinaryGeometryBounds> AssetBinaryView::GetGeometryBounds(std::uint32_t GeometryIndex) const {
+    if (GeometryIndex >= mGeometryCount || !mHasBounds) {
+        return std::nullopt;
+    }
+    BinaryGeometryBounds Bounds{};
+    std::memcpy(&Bounds, mGeometryRecords + GeometryIndex * mGeometryStride + mStreamCount * sizeof(BinaryStreamDesc), sizeof(Bounds));
+    return Bounds;
+}
+
+std::uint64_t AssetBinaryView::GetGeometryByteSize(std::uint32_t GeometryIndex) const {
+    if (GeometryIndex >= mGeometryCount) {
+        return 0;
+    }
+    std::uint64_t ByteSize{ 0 };
+    for (std::size_t Stream{ 0 }; Stream < StreamCount; ++Stream) {
+        ByteSize += GetStream(GeometryIndex, static_cast<BinaryStream>(Stream)).ByteSize;
+    }
+    return ByteSize;
+}
+
+std::vector<ModelNode*> AssetBinaryView::LoadHierarchy(AssetBundle& Bundle) const {
+    Bundle.Clear();
+    Bundle.GetMaterials() = mMaterials;
+    ModelResult& Result{ Bundle.GetModelResult() };
+    for (std::uint32_t GeometryIndex{ 0 }; GeometryIndex < mGeometryCount; ++GeometryIndex) {
+        ModelMesh& Mesh{ Result.GetMesh(Result.CreateMesh()) };
+        const std::span<const BinarySubMeshRecord> Records{ StreamSpan<BinarySubMeshRecord>(GeometryIndex, BinaryStream::SubMeshes) };
+        std::vector<ModelMesh::SubMesh> SubMeshes{};
+        SubMeshes.reserve(Records.size());
+        for (const BinarySubMeshRecord& SubMesh : Records) {
+            SubMeshes.push_back(ModelMesh::SubMesh{ static_cast<std::size_t>(SubMesh.IndexOffset), static_cast<std::size_t>(SubMesh.IndexCount), static_cast<std::size_t>(SubMesh.MaterialIndex), static_cast<std::size_t>(SubMesh.BaseVertex) });
+        }
+        Mesh.SetSubMeshes(std::move(SubMeshes));
+        if (mMeshletRanges != nullptr) {
+            const BinaryMeshletRange Range{ GetMeshletRange(GeometryIndex) };
+            std::vector<ModelMesh::Meshlet>& Meshlets{ Mesh.Meshlets() };
+            Meshlets.reserve(static_cast<std::size_t>(Range.MeshletCount));
+            for (std::uint64_t Index{ 0 }; Index < Range.MeshletCount; ++Index) {
+                const BinaryMeshletRecord Record{ GetMeshletRecord(Range.FirstMeshlet + Index) };
+                Meshlets.push_back(ModelMesh::Meshlet{ static_cast<std::size_t>(Record.IndexOffset), static_cast<std::size_t>(Record.IndexCount), Record.Center, Record.Radius, Record.ConeAxis, Record.ConeCutoff });
+            }
+        }
+        if (mLodRanges != nullptr) {
+            const BinaryLodRange Range{ GetLodRange(GeometryIndex) };
+            std::vector<ModelMesh::Lod>& Lods{ Mesh.Lods() };
+            Lods.reserve(static_cast<std::size_t>(Range.LodCount));
+            for (std::uint64_t Index{ 0 }; Index < Range.LodCount; ++Index) {
+                const BinaryLodRecord Record{ GetLodRecord(Range.FirstLod + Index) };
+                Lods.push_back(ModelMesh::Lod{ Record.SubMeshIndex, Record.Level, static_cast<std::size_t>(Record.IndexOffset), static_cast<std::size_t>(Record.IndexCount), Record.Error });
+            }
+        }
+    }
+
+    std::vector<ModelNode*> Nodes{};
+    Nodes.reserve(mNodeCount);
+    for (std::size_t Index{ 0 }; Index < mNodeCount; ++Index) {
+        const BinaryNodeRecord Record{ GetNodeRecord(Index) };
+        ModelNode* Parent{ (Record.ParentIndex >= 0) ? Nodes[static_cast<std::size_t>(Record.ParentIndex)] : nullptr };
+        ModelNode& Node{ Result.CreateNode(std::string{ GetNodeName(Index) }, Parent) };
+        Node.SetNodeToParent(Record.NodeToParent);
+        Node.SetGeometryToNode(Record.GeometryToNode);
+        if (Record.GeometryIndex != BinaryNoGeometry) {
+            Node.SetMeshIndex(Record.GeometryIndex);
+        }
+        Nodes.push_back(&Node);
+    }
+    return Nodes;
+}
+
+bool AssetBinaryView::CopyGeometry(std::uint32_t GeometryIndex, ModelMesh& Mesh) {
+    if (GeometryIndex >= mGeometryCount || !DecodeGeometry(GeometryIndex)) {
+        return false;
+    }
+    const GeometryView View{ GetGeometry(GeometryIndex) };
+    DequantizeVertices(View.Packed, Mesh.Vertices());
+    if (!View.ShortIndices.empty()) {
+        Mesh.Indices().assign(View.ShortIndices.begin(), View.ShortIndices.end());
+    }
+    else {
+        Mesh.Indices().assign(View.Indices.begin(), View.Indices.end());
+    }
+    ReleaseGeometry(GeometryIndex);
+    return true;
+}
+
+bool AssetBinaryView::IsBinaryV3(std::span<const std::byte> Bytes) {
+    BinaryFileHeader Header{};
+    if (Bytes.size() < sizeof(Header)) {
+        return false;
+    }
+    std::memcpy(&Header, Bytes.data(), sizeof(Header));
+    return Header.Magic == BinaryMagic && Header.Version == AssetBinaryWriter::FormatVersion;
+}
+
+bool AssetBinaryView::ReadSections() {
+    const std::span<const std::byte> Bytes{ mFile.Bytes() };
+    BinaryFileHeader Header{};
+    std::memcpy(&Header, Bytes.data(), sizeof(Header));
+    if ((Bytes.size() - sizeof(Header)) / sizeof(BinarySectionEntry) < Header.SectionCount) {
+        return false;
+    }
+
+    std::span<const std::byte> Materials{};
+    std::span<const std::byte> Strings{};
+    std::span<const std::byte> Nodes{};
+    std::span<const std::byte> Geometries{};
+    std::span<const std::byte> Meshlets{};
+    std::span<const std::byte> Lods{};
+    for (std::uint32_t Index{ 0 }; Index < Header.SectionCount; ++Index) {
+        BinarySectionEntry Entry{};
+        std::memcpy(&Entry, Bytes.data() + sizeof(Header) + Index * sizeof(BinarySectionEntry), sizeof(Entry));
+        if (Entry.Offset % BinarySectionAlignment != 0 || Entry.Offset > Bytes.size() || Entry.Size > Bytes.size() - Entry.Offset) {
+            return false;
+        }
+        const std::span<const std::byte> Section{ Bytes.subspan(static_cast<std::size_t>(Entry.Offset), static_cast<std::size_t>(Entry.Size)) };
+        switch (static_cast<BinarySection>(Entry.Tag)) {
+        case BinarySection::Materials:
+            Materials = Section;
+            break;
+        case BinarySection::Strings:
+            Strings = Section;
+            break;
+        case BinarySection::Nodes:
+            Nodes = Section;
+            break;
+        case BinarySection::Geometries:
+            Geometries = Section;
+            break;
+        case BinarySection::Meshlets:
+            Meshlets = Section;
+            break;
+        case BinarySection::Lods:
+            Lods = Section;
+            break;
+        default:
+            // DATA is reached through stream offsets; unknown tags are skipped.
+            break;
+        }
+    }
+    return ReadMaterials(Materials) && ReadGeometries(Geometries) && ReadMeshlets(Meshlets) && ReadLods(Lods) && ReadNodes(Nodes, Strings);
+}
+
+bool AssetBinaryView::ReadMaterials(std::span<const std::byte> Section) {
+    ByteCursor Cursor{ Section };
+    std::uint64_t Count{ 0 };
+    if (!Cursor.Read(Count)) {
+        return false;
+    }
+    mMaterials.clear();
+    for (std::uint64_t Index{ 0 }; Index < Count; ++Index) {
+        Material MaterialData{};
+        std::uint8_t Pbr{ 0 };
+        std::uint64_t PropertyCount{ 0 };
+        if (!Cursor.Read(Pbr) || !Cursor.Read(PropertyCount)) {
+            return false;
+        }
+        MaterialData.PBR = Pbr != 0;
+        for (std::uint64_t Property{ 0 }; Property < PropertyCount; ++Property) {
+            MaterialProperty Entry{};
+            std::uint16_t Type{ 0 };
+            std::uint8_t Kind{ 0 };
+            if (!Cursor.Read(Type) || !Cursor.Read(Kind) || !ReadMaterialMap(Cursor, static_cast<MaterialMapKind>(Kind), Entry.Data)) {
+                return false;
+            }
+            Entry.Type = static_cast<MaterialType>(Type);
+            MaterialData.Properties.push_back(std::move(Entry));
+        }
+        mMaterials.push_back(std::move(MaterialData));
+    }
+    return true;
+}
+
+bool AssetBinaryView::ReadNodes(std::span<const std::byte> Section, std::span<const std::byte> Strings) {
+    BinaryTableHeader Table{};
+    if (Section.size() < sizeof(Table)) {
+        return false;
+    }
+    std::memcpy(&Table, Section.data(), sizeof(Table));
+    if (Table.RecordSize < sizeof(BinaryNodeRecord) || Table.RecordSize % BinarySectionAlignment != 0 || (Section.size() - sizeof(Table)) / Table.RecordSize < Table.Count) {
+        return false;
+    }
+    mNodeRecords = Section.data() + sizeof(Table);
+    mNodeCount = Table.Count;
+    mNodeStride = Table.RecordSize;
+    mStrings = reinterpret_cast<const char*>(Strings.data());
+
+    for (std::size_t Index{ 0 }; Index < mNodeCount; ++Index) {
+        const BinaryNodeRecord Record{ GetNodeRecord(Index) };
+        if (static_cast<std::uint64_t>(Record.NameOffset) + Record.NameLength > Strings.size()) {
+            return false;
+        }
+        if (Record.ParentIndex < -1 || Record.ParentIndex >= static_cast<std::int64_t>(Index)) {
+            return false;
+        }
+        if (Record.GeometryIndex != BinaryNoGeometry && Record.GeometryIndex >= mGeometryCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AssetBinaryView::ReadGeometries(std::span<const std::byte> Section) {
+    BinaryTableHeader Table{};
+    if (Section.size() < sizeof(Table)) {
+        return false;
+    }
+    std::memcpy(&Table, Section.data(), sizeof(Table));
+    if (Table.RecordSize == 0 || Table.RecordSize < Table.StreamCount * sizeof(BinaryStreamDesc) || Table.RecordSize % BinarySectionAlignment != 0) {
+        return false;
+    }
+    if (Table.Count > 0 && (Section.size() - sizeof(Table)) / Table.RecordSize < Table.Count) {
+        return false;
+    }
+    mGeometryRecords = Section.data() + sizeof(Table);
+    mGeometryCount = Table.Count;
+    mGeometryStride = Table.RecordSize;
+    mStreamCount = Table.StreamCount;
+    mHasBounds = Table.RecordSize >= Table.StreamCount * sizeof(BinaryStreamDesc) + sizeof(BinaryGeometryBounds);
+    mDecoded.resize(mGeometryCount);
+
+    for (std::uint32_t Geometry{ 0 }; Geometry < mGeometryCount; ++Geometry) {
+        for (std::size_t Stream{ 0 }; Stream < StreamCount; ++Stream) {
+            const BinaryStreamDesc Desc{ GetStream(Geometry, static_cast<BinaryStream>(Stream)) };
+            if (!ValidateStream(Desc, static_cast<BinaryStream>(Stream))) {
+                return false;
+            }
+            mHasCompressedStreams = mHasCompressedStreams || (Desc.Count > 0 && Desc.Encoding == BinaryEncoding::ChunkedLz);
+        }
+        const std::span<const BinarySubMeshRecord> SubMeshes{ StreamSpan<BinarySubMeshRecord>(Geometry, BinaryStream::SubMeshes) };
+        const std::uint64_t IndexCount{ GetStream(Geometry, BinaryStream::Indices).Count };
+        const std::uint64_t VertexCount{ GetStream(Geometry, BinaryStream::Positions).Count };
+        for (const BinarySubMeshRecord& SubMesh : SubMeshes) {
+            if (SubMesh.IndexOffset > IndexCount || SubMesh.IndexCount > IndexCount - SubMesh.IndexOffset || SubMesh.BaseVertex > VertexCount) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool AssetBinaryView::ReadMeshlets(std::span<const std::byte> Section) {
+    // Files cooked without meshlets have no MSLT section.
+    if (Section.empty()) {
+        return true;
+    }
+    RangeTables Tables{};
+    if (!SplitRangeTables(Section, mGeometryCount, sizeof(BinaryMeshletRange), sizeof(BinaryMeshletRecord), Tables)) {
+        return false;
+    }
+    mMeshletRanges = Tables.Ranges;
+    mMeshletRangeStride = Tables.RangeStride;
+    mMeshletRecords = Tables.Records;
+    mMeshletCount = Tables.RecordCount;
+    mMeshletStride = Tables.RecordStride;
+
+    for (std::uint32_t Geometry{ 0 }; Geometry < mGeometryCount; ++Geometry) {
+        const BinaryMeshletRange Range{ GetMeshletRange(Geometry) };
+        if (Range.FirstMeshlet > mMeshletCount || Range.MeshletCount > mMeshletCount - Range.FirstMeshlet) {
+            return false;
+        }
+        const std::uint64_t IndexCount{ GetStream(Geometry, BinaryStream::Indices).Count };
+        for (std::uint64_t Index{ 0 }; Index < Range.MeshletCount; ++Index) {
+            const BinaryMeshletRecord Record{ GetMeshletRecord(Range.FirstMeshlet + Index) };
+            if (Record.IndexOffset > IndexCount || Record.IndexCount > IndexCount - Record.IndexOffset || Record.IndexCount % 3 != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool AssetBinaryView::ReadLods(std::span<const std::byte> Section) {
+    // Files cooked without LODs have no LODS section.
+    if (Section.empty()) {
+        return true;
+    }
+    RangeTables Tables{};
+    if (!SplitRangeTables(Section, mGeometryCount, sizeof(BinaryLodRange), sizeof(BinaryLodRecord), Tables)) {
+        return false;
+    }
+    mLodRanges = Tables.Ranges;
+    mLodRangeStride = Tables.RangeStride;
+    mLodRecords = Tables.Records;
+    mLodCount = Tables.RecordCount;
+    mLodStride = Tables.RecordStride;
+
+    for (std::uint32_t Geometry{ 0 }; Geometry < mGeometryCount; ++Geometry) {
+        const BinaryLodRange Range{ GetLodRange(Geometry) };
+        if (Range.FirstLod > mLodCount || Range.LodCount > mLodCount - Range.FirstLod) {
+            return false;
+        }
+        const std::uint64_t IndexCount{ GetStream(Geometry, BinaryStream::Indices).Count };
+        const std::uint64_t SubMeshCount{ GetStream(Geometry, BinaryStream::SubMeshes).Count };
+        for (std::uint64_t Index{ 0 }; Index < Range.LodCount; ++Index) {
+            const BinaryLodRecord Record{ GetLodRecord(Range.FirstLod + Index) };
+            if (Record.SubMeshIndex >= SubMeshCount || Record.IndexOffset > IndexCount || Record.IndexCount > IndexCount - Record.IndexOffset || Record.IndexCount % 3 != 0) {
+                return false;
+            }
+            if (Record.Level == 0 || Record.Level > BinaryMaxLodLevel) {
+                return false;
+            }
+            // BuildLodLevels relies on the order, so it is checked here.
+            if (Index > 0) {
+                const BinaryLodRecord Previous{ GetLodRecord(Range.FirstLod + Index - 1) };
+                if (Record.SubMeshIndex < Previous.SubMeshIndex || (Record.SubMeshIndex == Previous.SubMeshIndex && Record.Level <= Previous.Level)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool AssetBinaryView::ValidateStream(const BinaryStreamDesc& Desc, BinaryStream Stream) const {
+    if (Desc.Count == 0) {
+        return Desc.ByteSize == 0;
+    }
+    if (Desc.Format != ExpectedFormats[static_cast<std::size_t>(Stream)] && !IsCompactFormat(Stream, Desc.Format)) {
+        return false;
+    }
+    const std::size_t ElementSize{ BinaryElementSize(Desc.Format) };
+    if (Desc.ByteSize / ElementSize != Desc.Count || Desc.ByteSize % ElementSize != 0) {
+        return false;
+    }
+    if (Desc.Offset % BinarySectionAlignment != 0 || Desc.Offset > mFile.Size()) {
+        return false;
+    }
+    if (Desc.Encoding == BinaryEncoding::ChunkedLz) {
+        // SubMeshes are read by LoadHierarchy and must stay directly addressable.
+        return Stream != BinaryStream::SubMeshes && ValidateChunks(Desc);
+    }
+    return Desc.Encoding == BinaryEncoding::Raw && Desc.ByteSize <= mFile.Size() - Desc.Offset;
+}
+
+bool AssetBinaryView::ValidateChunks(const BinaryStreamDesc& Desc) const {
+    BinaryChunkHeader Header{};
+    const std::uint64_t Available{ mFile.Size() - Desc.Offset };
+    if (Available < sizeof(Header)) {
+        return false;
+    }
+    std::memcpy(&Header, mFile.Data() + Desc.Offset, sizeof(Header));
+    if (Header.ChunkSize == 0 || Header.ChunkSize % 4 != 0 || Header.ChunkCount != (Desc.ByteSize + Header.ChunkSize - 1) / Header.ChunkSize) {
+        return false;
+    }
+    if ((Available - sizeof(Header)) / sizeof(BinaryChunkEntry) < Header.ChunkCount) {
+        return false;
+    }
+    const std::byte* Entries{ mFile.Data() + Desc.Offset + sizeof(Header) };
+    for (std::uint32_t Index{ 0 }; Index < Header.ChunkCount; ++Index) {
+        BinaryChunkEntry Entry{};
+        std::memcpy(&Entry, Entries + Index * sizeof(BinaryChunkEntry), sizeof(Entry));
+        const std::uint64_t RawSize{ std::min<std::uint64_t>(Header.ChunkSize, Desc.ByteSize - static_cast<std::uint64_t>(Index) * Header.ChunkSize) };
+        if (Entry.RawSize != RawSize || Entry.StoredSize > Entry.RawSize || Entry.Offset > mFile.Size() || Entry.StoredSize > mFile.Size() - Entry.Offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AssetBinaryView::DecodeGeometry(std::uint32_t GeometryIndex) {
+    if (!mHasCompressedStreams) {
+        return true;
+    }
+    DecodedStreams& Decoded{ mDecoded[GeometryIndex] };
+    std::vector<ChunkJob> Jobs{};
+    for (std::size_t Stream{ 0 }; Stream < StreamCount; ++Stream) {
+        const BinaryStreamDesc Desc{ GetStream(GeometryIndex, static_cast<BinaryStream>(Stream)) };
+        if (Desc.Count == 0 || Desc.Encoding != BinaryEncoding::ChunkedLz || Decoded[Stream] != nullptr) {
+            continue;
+        }
+        Decoded[Stream] = std::make_unique_for_overwrite<std::byte[]>(static_cast<std::size_t>(Desc.ByteSize));
+        BinaryChunkHeader Header{};
+        std::memcpy(&Header, mFile.Data() + Desc.Offset, sizeof(Header));
+        const std::byte* Entries{ mFile.Data() + Desc.Offset + sizeof(Header) };
+        for (std::uint32_t Index{ 0 }; Index < Header.ChunkCount; ++Index) {
+            ChunkJob Job{};
+            std::memcpy(&Job.Entry, Entries + Index * sizeof(BinaryChunkEntry), sizeof(Job.Entry));
+            Job.Output = Decoded[Stream].get() + static_cast<std::size_t>(Index) * Header.ChunkSize;
+            Jobs.push_back(Job);
+        }
+    }
+    if (Jobs.empty()) {
+        return true;
+    }
+
+    // Chunks of every stream of the geometry go into one parallel loop so small
+    // streams do not serialise behind large ones.
+    std::atomic<bool> Valid{ true };
+    AcquireThreadPool().ParallelFor(Jobs.size(), [&](std::size_t Index) {
+        const ChunkJob& Job{ Jobs[Index] };
+        const std::span<const std::byte> Stored{ mFile.Data() + Job.Entry.Offset, Job.Entry.StoredSize };
+        const std::span<std::byte> Output{ Job.Output, Job.Entry.RawSize };
+        if (Job.Entry.StoredSize == Job.Entry.RawSize) {
+            std::memcpy(Output.data(), Stored.data(), Stored.size());
+            return;
+        }
+        std::unique_ptr<std::byte[]> Planes{ std::make_unique_for_overwrite<std::byte[]>(Output.size()) };
+        const std::span<std::byte> PlaneBytes{ Planes.get(), Output.size() };
+        if (!LzCodec::Decompress(Stored, PlaneBytes)) {
+            Valid = false;
+            return;
+        }
+        LzCodec::Unshuffle4(PlaneBytes, Output);
+    });
+    if (!Valid) {
+        for (std::unique_ptr<std::byte[]>& Stream : Decoded) {
+            Stream.reset();
+        }
+        return false;
+    }
+    return true;
+}
+
+BinaryNodeRecord AssetBinaryView::GetNodeRecord(std::size_t NodeIndex) const {
+    BinaryNodeRecord Record{};
+    std::memcpy(&Record, mNodeRecords + NodeIndex * mNodeStride, sizeof(Record));
+    return Record;
+}
+
+BinaryStreamDesc AssetBinaryView::GetStream(std::uint32_t GeometryIndex, BinaryStream Stream) const {
+    BinaryStreamDesc Desc{};
+    const std::size_t StreamIndex{ static_cast<std::size_t>(Stream) };
+    if (StreamIndex < mStreamCount) {
+        std::memcpy(&Desc, mGeometryRecords + GeometryIndex * mGeometryStride + StreamIndex * sizeof(BinaryStreamDesc), sizeof(Desc));
+    }
+    return Desc;
+}
+
+BinaryMeshletRange AssetBinaryView::GetMeshletRange(std::uint32_t GeometryIndex) const {
+    BinaryMeshletRange Range{};
+    std::memcpy(&Range, mMeshletRanges + GeometryIndex * mMeshletRangeStride, sizeof(Range));
+    return Range;
+}
+
+BinaryMeshletRecord AssetBinaryView::GetMeshletRecord(std::uint64_t MeshletIndex) const {
+    BinaryMeshletRecord Record{};
+    std::memcpy(&Record, mMeshletRecords + static_cast<std::size_t>(MeshletIndex) * mMeshletStride, sizeof(Record));
+    return Record;
+}
+
+BinaryLodRange AssetBinaryView::GetLodRange(std::uint32_t GeometryIndex) const {
+    BinaryLodRange Range{};
+    std::memcpy(&Range, mLodRanges + GeometryIndex * mLodRangeStride, sizeof(Range));
+    return Range;
+}
+
+BinaryLodRecord AssetBinaryView::GetLodRecord(std::uint64_t LodIndex) const {
+    BinaryLodRecord Record{};
+    std::memcpy(&Record, mLodRecords + static_cast<std::size_t>(LodIndex) * mLodStride, sizeof(Record));
+    return Record;
+}
+
+std::span<const std::byte> AssetBinaryView::StreamBytes(std::uint32_t GeometryIndex, BinaryStream Stream) const {
+    const BinaryStreamDesc Desc{ GetStream(GeometryIndex, Stream) };
+    if (Desc.Count == 0) {
+        return std::span<const std::byte>{};
+    }
+    const std::size_t ByteSize{ static_cast<std::size_t>(Desc.ByteSize) };
+    if (Desc.Encoding == BinaryEncoding::ChunkedLz) {
+        const std::byte* Decoded{ mDecoded[GeometryIndex][static_cast<std::size_t>(Stream)].get() };
+        if (Decoded == nullptr) {
+            return std::span<const std::byte>{};
+        }
+        return std::span<const std::byte>{ Decoded, ByteSize };
+    }
+    return std::span<const std::byte>{ mFile.Data() + Desc.Offset, ByteSize };
+}
+
+// Quantised streams have no typed span; they are only reachable through
+// GeometryView::Packed, and 16-bit indices through GeometryView::ShortIndices.
+template <typename T>
+std::span<const T> AssetBinaryView::StreamSpan(std::uint32_t GeometryIndex, BinaryStream Stream) const {
+    if (GetStream(GeometryIndex, Stream).Format != ExpectedFormats[static_cast<std::size_t>(Stream)]) {
+        return std::span<const T>{};
+    }
+    const std::span<const std::byte> Bytes{ StreamBytes(GeometryIndex, Stream) };
+    return std::span<const T>{ reinterpret_cast<const T*>(Bytes.data()), Bytes.size() / sizeof(T) };
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AssetBinaryFormat.h"
+#include "AssetBundle.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "VertexQuantization.h"
+
+namespace asset {
+    // Vertices holds the float streams only; Packed holds every vertex
+    // stream as stored, quantised ones included, ready for upload. Exactly
+    // one of Indices and ShortIndices is set for indexed geometry; either way
+    // an index is relative to the BaseVertex of its submesh.
+    struct GeometryView final {
+    public:
+        VertexAttributeView Vertices{};
+        PackedVertexView Packed{};
+        std::span<const std::uint32_t> Indices{};
+        std::span<const std::uint16_t> ShortIndices{};
+        std::span<const BinarySubMeshRecord> SubMeshes{};
+    };
+
+    // Zero-copy access to an FBXB v3 file. The file is memory-mapped and every
+    // table and stream is validated once in Open; afterwards geometry is handed
+    // out as spans into the mapping, which stay valid until Close.
+    //
+    // ChunkedLz streams are the exception: the first GetGeometry for a geometry
+    // decodes all of its compressed chunks in parallel into storage owned by
+    // the view, and those spans stay valid until ReleaseGeometry or Close.
+    // GetGeometry and ReleaseGeometry therefore modify the view; the const
+    // queries may run concurrently with each other but not with them.
+    class AssetBinaryView final {
+    public:
+        AssetBinaryView();
+        ~AssetBinaryView() = default;
+
+        AssetBinaryView(const AssetBinaryView& Other) = delete;
+        AssetBinaryView& operator=(const AssetBinaryView& Other) = delete;
+        AssetBinaryView(AssetBinaryView&& Other) noexcept = default;
+        AssetBinaryView& operator=(AssetBinaryView&& Other) noexcept = default;
+
+    public:
+        // False when the file is missing, not v3, or fails validation.
+        bool Open(const std::string& Path);
+        void Close();
+        bool IsOpen() const;
+
+        // Pool used to decode compressed chunks; without one a pool is
+        // created on the first compressed decode.
+        void SetThreadPool(std::shared_ptr<ThreadPool> Pool);
+
+        const std::vector<Material>& GetMaterials() const;
+
+        std::size_t GetNodeCount() const;
+        std::string_view GetNodeName(std::size_t NodeIndex) const;
+        std::int32_t GetParentIndex(std::size_t NodeIndex) const;
+        Mat4 GetNodeToParent(std::size_t NodeIndex) const;
+        Mat4 GetGeometryToNode(std::size_t NodeIndex) const;
+        bool HasGeometry(std::size_t NodeIndex) const;
+        // BinaryNoGeometry for nodes without geometry. Nodes that instance the
+        // same mesh share one geometry index.
+        std::uint32_t GetGeometryIndex(std::size_t NodeIndex) const;
+
+        std::size_t GetGeometryCount() const;
+        // Empty when a compressed chunk fails to decode.
+        GeometryView GetGeometry(std::uint32_t GeometryIndex);
+        // Frees decoded copies of GeometryIndex's compressed streams; spans
+        // from earlier GetGeometry calls for it become invalid.
+        void ReleaseGeometry(std::uint32_t GeometryIndex);
+        // Table-of-contents queries; neither touches the DATA section.
+        std::optional<BinaryGeometryBounds> GetGeometryBounds(std::uint32_t GeometryIndex) const;
+        std::uint64_t GetGeometryByteSize(std::uint32_t GeometryIndex) const;
+
+        // Rebuilds materials, nodes, transforms and the mesh table, with submeshes
+        // and meshlets, into Bundle without touching vertex or index data. Mesh
+        // N of the result is geometry N of the file. Returned nodes are in file
+        // order.
+        std::vector<ModelNode*> LoadHierarchy(AssetBundle& Bundle) const;
+        // Copies one geometry's streams into owned storage, expanding quantised
+        // vertex streams to float and 16-bit indices to 32 bits (still
+        // relative to each SubMesh::BaseVertex), then releases its decoded streams. False when a compressed chunk fails to decode.
+        bool CopyGeometry(std::uint32_t GeometryIndex, ModelMesh& Mesh);
+
+        static bool IsBinaryV3(std::span<const std::byte> Bytes);
+
+    private:
+        using DecodedStreams = std::array<std::unique_ptr<std::byte[]>, static_cast<std::size_t>(BinaryStream::Count)>;
+
+    private:
+        bool ReadSections();
+        bool ReadMaterials(std::span<const std::byte> Section);
+        bool ReadNodes(std::span<const std::byte> Section, std::span<const std::byte> Strings);
+        bool ReadGeometries(std::span<const std::byte> Section);
+        bool ReadMeshlets(std::span<const std::byte> Section);
+        bool ReadLods(std::span<const std::byte> Section);
+        bool ValidateStream(const BinaryStreamDesc& Desc, BinaryStream Stream) const;
+        bool ValidateChunks(const BinaryStreamDesc& Desc) const;
+        bool DecodeGeometry(std::uint32_t GeometryIndex);
+        ThreadPool& AcquireThreadPool();
+        BinaryNodeRecord GetNodeRecord(std::size_t NodeIndex) const;
+        BinaryStreamDesc GetStream(std::uint32_t GeometryIndex, BinaryStream Stream) const;
+        BinaryMeshletRange GetMeshletRange(std::uint32_t GeometryIndex) const;
+        BinaryMeshletRecord GetMeshletRecord(std::uint64_t MeshletIndex) const;
+        BinaryLodRange GetLodRange(std::uint32_t GeometryIndex) const;
+        BinaryLodRecord GetLodRecord(std::uint64_t LodIndex) const;
+
+        std::span<const std::byte> StreamBytes(std::uint32_t GeometryIndex, BinaryStream Stream) const;
+        template <typename T>
+        std::span<const T> StreamSpan(std::uint32_t GeometryIndex, BinaryStream Stream) const;
+
+    private:
+        MappedFile mFile{};
+        std::vector<Material> mMaterials{};
+        const std::byte* mNodeRecords{ nullptr };
+        std::size_t mNodeCount{ 0 };
+        std::size_t mNodeStride{ 0 };
+        const char* mStrings{ nullptr };
+        const std::byte* mGeometryRecords{ nullptr };
+        std::size_t mGeometryCount{ 0 };
+        std::size_t mGeometryStride{ 0 };
+        std::size_t mStreamCount{ 0 };
+        bool mHasBounds{ false };
+        const std::byte* mMeshletRanges{ nullptr };
+        std::size_t mMeshletRangeStride{ 0 };
+        const std::byte* mMeshletRecords{ nullptr };
+        std::size_t mMeshletCount{ 0 };
+        std::size_t mMeshletStride{ 0 };
+        const std::byte* mLodRanges{ nullptr };
+        std::size_t mLodRangeStride{ 0 };
+        const std::byte* mLodRecords{ nullptr };
+        std::size_t mLodCount{ 0 };
+        std::size_t mLodStride{ 0 };
+        bool mHasCompressedStreams{ false };
+        std::shared_ptr<ThreadPool> mThreadPool{};
+        std::vector<DecodedStreams> mDecoded{};
+    };
+}
@@ -1,30 +1,371 @@
 #include "AssetBinaryWriter.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <unordered_map>
+
+#include "LzCodec.h"
+#include "VertexQuantization.h"
 
 using namespace asset;
 
 namespace {
-    constexpr std::uint32_t FormatVersion{ 2 };
-    constexpr char FormatMagic[4]{ 'F', 'B', 'X', 'B' };
+    constexpr std::size_t StreamCount{ static_cast<std::size_t>(BinaryStream::Count) };
+    constexpr std::size_t SectionCount{ 5 };
+    // Below this a chunk table costs more than compression can save.
+    constexpr std::size_t MinCompressedStreamBytes{ 4096 };
+
+    using Clock = std::chrono::steady_clock;
+
+    double SecondsBetween(Clock::time_point Start, Clock::time_point End) {
+        return std::chrono::duration<double>{ End - Start }.count();
+    }
+
+    struct StreamSource final {
+    public:
+        std::span<const std::byte> Bytes{};
+        std::uint64_t Count{ 0 };
+        BinaryElementFormat Format{ BinaryElementFormat::None };
+    };
+
+    template <typename T>
+    StreamSource MakeSource(const std::vector<T>& Values, BinaryElementFormat Format) {
+        return StreamSource{ std::as_bytes(std::span<const T>{ Values }), static_cast<std::uint64_t>(Values.size()), Format };
+    }
+
+    // Streams of one geometry that do not exist in the mesh as written.
+    struct GeometryScratch final {
+    public:
+        std::vector<BinarySubMeshRecord> SubMeshes{};
+        std::vector<std::uint16_t> ShortIndices{};
+        std::vector<std::uint32_t> BaseVertices{};
+    };
+
+    // Rebases every SubMesh so its indices, LOD levels included, fit in 16
+    // bits, and fills ShortIndices with the result. When every vertex is
+    // below 65536 all bases stay 0; otherwise each SubMesh starts at the
+    // lowest vertex it uses. False when a SubMesh spans more than 65536
+    // vertices. Indices outside every SubMesh and Lod are not drawn and are
+    // written as 0.
+    bool ShortenIndices(const ModelMesh& Mesh, std::vector<std::uint16_t>& ShortIndices, std::vector<std::uint32_t>& BaseVertices) {
+        constexpr std::uint64_t MaxShortIndex{ 0xFFFF };
+        const std::vector<std::uint32_t>& Indices{ Mesh.Indices() };
+        const std::vector<ModelMesh::SubMesh>& SubMeshes{ Mesh.GetSubMeshes() };
+        if (Indices.empty()) {
+            return false;
+        }
+        if (SubMeshes.empty()) {
+            if (*std::max_element(Indices.begin(), Indices.end()) > MaxShortIndex) {
+                return false;
+            }
+            ShortIndices.assign(Indices.begin(), Indices.end());
+            BaseVertices.clear();
+            return true;
+        }
+
+        std::vector<std::uint64_t> Low(SubMeshes.size(), ~std::uint64_t{ 0 });
+        std::vector<std::uint64_t> High(SubMeshes.size(), 0);
+        auto ForEachRange = [&](auto&& Visit) {
+            for (std::size_t SubMesh{ 0 }; SubMesh < SubMeshes.size(); ++SubMesh) {
+                Visit(SubMesh, SubMeshes[SubMesh].IndexOffset, SubMeshes[SubMesh].IndexCount);
+            }
+            for (const ModelMesh::Lod& Lod : Mesh.Lods()) {
+                if (Lod.SubMeshIndex < SubMeshes.size()) {
+                    Visit(Lod.SubMeshIndex, Lod.IndexOffset, Lod.IndexCount);
+                }
+            }
+        };
+        ForEachRange([&](std::size_t SubMesh, std::size_t Offset, std::size_t Count) {
+            for (std::size_t Index{ Offset }; Index < Offset + Count; ++Index) {
+                const std::uint64_t Vertex{ Indices[Index] + static_cast<std::uint64_t>(SubMeshes[SubMesh].BaseVertex) };
+                Low[SubMesh] = std::min(Low[SubMesh], Vertex);
+                High[SubMesh] = std::max(High[SubMesh], Vertex);
+            }
+        });
+        const bool Rebase{ *std::max_element(High.begin(), High.end()) > MaxShortIndex };
+        BaseVertices.assign(SubMeshes.size(), 0);
+        for (std::size_t SubMesh{ 0 }; SubMesh < SubMeshes.size(); ++SubMesh) {
+            if (Low[SubMesh] > High[SubMesh]) {
+                continue;
+            }
+            if (Rebase) {
+                BaseVertices[SubMesh] = static_cast<std::uint32_t>(Low[SubMesh]);
+            }
+            if (High[SubMesh] - BaseVertices[SubMesh] > MaxShortIndex) {
+                return false;
+            }
+        }
+        ShortIndices.assign(Indices.size(), 0);
+        ForEachRange([&](std::size_t SubMesh, std::size_t Offset, std::size_t Count) {
+            for (std::size_t Index{ Offset }; Index < Offset + Count; ++Index) {
+                const std::uint64_t Vertex{ Indices[Index] + static_cast<std::uint64_t>(SubMeshes[SubMesh].BaseVertex) };
+                ShortIndices[Index] = static_cast<std::uint16_t>(Vertex - BaseVertices[SubMesh]);
+            }
+        });
+        return true;
+    }
+
+    // SubMeshes are widened into fixed records and, with ShortIndices set,
+    // indices are narrowed to 16 bits where ShortenIndices allows; Scratch
+    // owns both for as long as the returned sources are in use.
+    std::array<StreamSource, StreamCount> GatherStreams(const ModelMesh& Mesh, bool ShortIndices, GeometryScratch& Scratch) {
+        const VertexAttributes& Vertices{ Mesh.Vertices() };
+        const bool Shortened{ ShortIndices && ShortenIndices(Mesh, Scratch.ShortIndices, Scratch.BaseVertices) };
+        Scratch.SubMeshes.clear();
+        const std::vector<ModelMesh::SubMesh>& SubMeshes{ Mesh.GetSubMeshes() };
+        for (std::size_t Index{ 0 }; Index < SubMeshes.size(); ++Index) {
+            const ModelMesh::SubMesh& SubMesh{ SubMeshes[Index] };
+            const std::size_t BaseVertex{ Shortened ? Scratch.BaseVertices[Index] : SubMesh.BaseVertex };
+            Scratch.SubMeshes.push_back(BinarySubMeshRecord{ SubMesh.IndexOffset, SubMesh.IndexCount, static_cast<std::uint32_t>(SubMesh.MaterialIndex), static_cast<std::uint32_t>(BaseVertex) });
+        }
+
+        std::array<StreamSource, StreamCount> Streams{};
+        Streams[static_cast<std::size_t>(BinaryStream::Positions)] = MakeSource(Vertices.Positions, BinaryElementFormat::Float3);
+        Streams[static_cast<std::size_t>(BinaryStream::Normals)] = MakeSource(Vertices.Normals, BinaryElementFormat::Float3);
+        for (std::size_t Index{ 0 }; Index < Vertices.TexCoords.size(); ++Index) {
+            Streams[static_cast<std::size_t>(BinaryStream::TexCoord0) + Index] = MakeSource(Vertices.TexCoords[Index], BinaryElementFormat::Float2);
+        }
+        Streams[static_cast<std::size_t>(BinaryStream::Colors)] = MakeSource(Vertices.Colors, BinaryElementFormat::Float4);
+        Streams[static_cast<std::size_t>(BinaryStream::Tangents)] = MakeSource(Vertices.Tangents, BinaryElementFormat::Float3);
+        Streams[static_cast<std::size_t>(BinaryStream::Bitangents)] = MakeSource(Vertices.Bitangents, BinaryElementFormat::Float3);
+        Streams[static_cast<std::size_t>(BinaryStream::BoneIndices)] = MakeSource(Vertices.BoneIndices, BinaryElementFormat::Uint4);
+        Streams[static_cast<std::size_t>(BinaryStream::BoneWeights)] = MakeSource(Vertices.BoneWeights, BinaryElementFormat::Float4);
+        Streams[static_cast<std::size_t>(BinaryStream::Indices)] = Shortened ? MakeSource(Scratch.ShortIndices, BinaryElementFormat::Uint16) : MakeSource(Mesh.Indices(), BinaryElementFormat::Uint32);
+        Streams[static_cast<std::size_t>(BinaryStream::SubMeshes)] = MakeSource(Scratch.SubMeshes, BinaryElementFormat::SubMesh);
+        return Streams;
+    }
+
+    BinaryGeometryBounds ComputeBounds(const std::vector<Vec3>& Positions) {
+        BinaryGeometryBounds Bounds{};
+        if (Positions.empty()) {
+            return Bounds;
+        }
+        Bounds.Min = Positions.front();
+        Bounds.Max = Positions.front();
+        for (const Vec3& Position : Positions) {
+            Bounds.Min = Vec3{ std::min(Bounds.Min.mX, Position.mX), std::min(Bounds.Min.mY, Position.mY), std::min(Bounds.Min.mZ, Position.mZ) };
+            Bounds.Max = Vec3{ std::max(Bounds.Max.mX, Position.mX), std::max(Bounds.Max.mY, Position.mY), std::max(Bounds.Max.mZ, Position.mZ) };
+        }
+        return Bounds;
+    }
+
+    std::vector<const ModelNode*> CollectNodes(const ModelResult& Result) {
+        std::vector<const ModelNode*> Nodes{};
+        std::vector<const ModelNode*> Stack{};
+        const ModelNode* Root{ Result.GetRoot() };
+        if (Root == nullptr) {
+            return Nodes;
+        }
+        Stack.push_back(Root);
+        while (!Stack.empty()) {
+            const ModelNode* Node{ Stack.back() };
+            Stack.pop_back();
+            Nodes.push_back(Node);
+            const std::vector<ModelNode*>& Children{ Node->GetChildren() };
+            for (std::size_t Index{ Children.size() }; Index > 0; --Index) {
+                Stack.push_back(Children[Index - 1]);
+            }
+        }
+        return Nodes;
+    }
 }
 
 AssetBinaryWriter::AssetBinaryWriter() = default;
 
+double BinaryWriteStats::CompressionRatio() const {
+    if (StoredBytes == 0) {
+        return 1.0;
+    }
+    return static_cast<double>(RawBytes) / static_cast<double>(StoredBytes);
+}
+
+double BinaryWriteStats::DecodeGigabytesPerSecond() const {
+    if (DecodeSeconds <= 0.0) {
+        return 0.0;
+    }
+    return static_cast<double>(RawBytes) / DecodeSeconds / 1.0e9;
+}
+
+double BinaryWriteStats::BytesPerVertex() const {
+    if (VertexCount == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(VertexBytes) / static_cast<double>(VertexCount);
+}
+
+double BinaryWriteStats::FloatBytesPerVertex() const {
+    if (VertexCount == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(FloatVertexBytes) / static_cast<double>(VertexCount);
+}
+
 bool AssetBinaryWriter::WriteToFile(const std::string& Path, const AssetBundle& Bundle) {
     mStream = std::ofstream{ Path, std::ios::binary };
+    mOffset = 0;
+    mStats = BinaryWriteStats{};
     if (!mStream.is_open()) {
         return false;
     }
-    WriteHeader();
+
+    const std::vector<const ModelNode*> Nodes{ CollectNodes(Bundle.GetModelResult()) };
+    std::unordered_map<const ModelNode*, std::uint32_t> NodeIndices{};
+    NodeIndices.reserve(Nodes.size());
+    for (std::uint32_t Index{ 0 }; Index < Nodes.size(); ++Index) {
+        NodeIndices.emplace(Nodes[Index], Index);
+    }
+
+    // A GEOM record per mesh, numbered in order of first reference so shared
+    // meshes are stored once and every instance points at the same record.
+    const ModelResult& Result{ Bundle.GetModelResult() };
+    std::vector<std::uint32_t> MeshGeometry(Result.MeshCount(), BinaryNoGeometry);
+    std::vector<const ModelMesh*> Meshes{};
+    std::vector<BinaryNodeRecord> Records{};
+    Records.resize(Nodes.size());
+    for (std::size_t Index{ 0 }; Index < Nodes.size(); ++Index) {
+        const ModelNode& Node{ *Nodes[Index] };
+        BinaryNodeRecord& Record{ Records[Index] };
+        const ModelNode* Parent{ Node.GetParent() };
+        if (Parent != nullptr) {
+            const auto Found{ NodeIndices.find(Parent) };
+            Record.ParentIndex = (Found == NodeIndices.end()) ? -1 : static_cast<std::int32_t>(Found->second);
+        }
+        const ModelMesh* Mesh{ Result.FindMesh(Node) };
+        if (Mesh != nullptr && !Mesh->Empty()) {
+            std::uint32_t& GeometryIndex{ MeshGeometry[Node.GetMeshIndex()] };
+            if (GeometryIndex == BinaryNoGeometry) {
+                GeometryIndex = static_cast<std::uint32_t>(Meshes.size());
+                Meshes.push_back(Mesh);
+            }
+            Record.GeometryIndex = GeometryIndex;
+        }
+        Record.NodeToParent = Node.GetNodeToParent();
+        Record.GeometryToNode = Node.GetGeometryToNode();
+    }
+
+    // MSLT and LODS are only present when there is something to put in them,
+    // so files cooked without either keep the five-section layout.
+    const bool HasMeshlets{ std::any_of(Meshes.begin(), Meshes.end(), [](const ModelMesh* Mesh) { return !Mesh->Meshlets().empty(); }) };
+    const bool HasLods{ std::any_of(Meshes.begin(), Meshes.end(), [](const ModelMesh* Mesh) { return !Mesh->Lods().empty(); }) };
+    std::vector<BinarySectionEntry> Sections{};
+    Sections.resize(SectionCount + (HasMeshlets ? 1 : 0) + (HasLods ? 1 : 0));
+    WriteHeader(Sections);
+
+    Sections[0] = BeginSection(BinarySection::Materials);
     WriteMaterials(Bundle.GetMaterials());
-    WriteModelResult(Bundle.GetModelResult());
-    return static_cast<bool>(mStream);
+    EndSection(Sections[0]);
+
+    Sections[1] = BeginSection(BinarySection::Strings);
+    WriteStrings(Nodes, Records);
+    EndSection(Sections[1]);
+
+    Sections[2] = BeginSection(BinarySection::Nodes);
+    WriteTable(BinaryTableHeader{ static_cast<std::uint32_t>(Records.size()), sizeof(BinaryNodeRecord), 0, 0 }, Records.data(), Records.size() * sizeof(BinaryNodeRecord));
+    EndSection(Sections[2]);
+
+    // Offsets are only known once DATA is written; the GEOM table is written
+    // with the sizes and bounds now and rewritten afterwards.
+    const std::uint32_t GeometryCount{ static_cast<std::uint32_t>(Meshes.size()) };
+    std::vector<BinaryGeometryRecord> Geometries{};
+    Geometries.resize(GeometryCount);
+    GeometryScratch Scratch{};
+    for (std::size_t Index{ 0 }; Index < Meshes.size(); ++Index) {
+        BinaryGeometryRecord& Geometry{ Geometries[Index] };
+        Geometry.Bounds = ComputeBounds(Meshes[Index]->Vertices().Positions);
+        const std::array<StreamSource, StreamCount> Streams{ GatherStreams(*Meshes[Index], mOptions.ShortIndices, Scratch) };
+        for (std::size_t Stream{ 0 }; Stream < StreamCount; ++Stream) {
+            BinaryStreamDesc& Desc{ Geometry.Streams[Stream] };
+            Desc.Format = Streams[Stream].Format;
+            Desc.Count = Streams[Stream].Count;
+            Desc.ByteSize = Streams[Stream].Bytes.size();
+        }
+        // Only the formats are settled here; WriteGeometryData encodes the
+        // streams one geometry at a time from what the GEOM record says.
+        if (mOptions.QuantizeVertices) {
+            const VertexFormats Formats{ ChooseQuantizedFormats(VertexAttributeView{ Meshes[Index]->Vertices() }) };
+            for (std::size_t Stream{ 0 }; Stream < VertexStreamCount; ++Stream) {
+                BinaryStreamDesc& Desc{ Geometry.Streams[Stream] };
+                if (Desc.Count > 0) {
+                    Desc.Format = Formats[Stream];
+                    Desc.ByteSize = Desc.Count * BinaryElementSize(Desc.Format);
+                }
+            }
+        }
+        mStats.VertexCount += Geometry.Streams[static_cast<std::size_t>(BinaryStream::Positions)].Count;
+        for (std::size_t Stream{ 0 }; Stream < VertexStreamCount; ++Stream) {
+            mStats.VertexBytes += Geometry.Streams[Stream].ByteSize;
+            mStats.FloatVertexBytes += Streams[Stream].Bytes.size();
+        }
+        mStats.IndexBytes += Geometry.Streams[static_cast<std::size_t>(BinaryStream::Indices)].ByteSize;
+        mStats.WideIndexBytes += Meshes[Index]->Indices().size() * sizeof(std::uint32_t);
+    }
+
+    const BinaryTableHeader GeometryTable{ GeometryCount, sizeof(BinaryGeometryRecord), static_cast<std::uint32_t>(StreamCount), 0 };
+    Sections[3] = BeginSection(BinarySection::Geometries);
+    WriteTable(GeometryTable, Geometries.data(), Geometries.size() * sizeof(BinaryGeometryRecord));
+    EndSection(Sections[3]);
+
+    Sections[4] = BeginSection(BinarySection::Data);
+    if (!WriteGeometryData(Meshes, Geometries)) {
+        return false;
+    }
+    EndSection(Sections[4]);
+
+    std::size_t OptionalSection{ SectionCount };
+    if (HasMeshlets) {
+        Sections[OptionalSection] = BeginSection(BinarySection::Meshlets);
+        WriteMeshlets(Meshes);
+        EndSection(Sections[OptionalSection++]);
+    }
+    if (HasLods) {
+        Sections[OptionalSection] = BeginSection(BinarySection::Lods);
+        WriteLods(Meshes);
+        EndSection(Sections[OptionalSection++]);
+    }
+
+    mStream.seekp(static_cast<std::streamoff>(Sections[3].Offset));
+    WriteTable(GeometryTable, Geometries.data(), Geometries.size() * sizeof(BinaryGeometryRecord));
+    mStream.seekp(0);
+    WriteHeader(Sections);
+    mStream.flush();
+    const bool Written{ static_cast<bool>(mStream) };
+    mStream.close();
+    return Written;
 }
 
-void AssetBinaryWriter::WriteHeader() {
-    WriteBytes(FormatMagic, sizeof(FormatMagic));
-    WriteUint32(FormatVersion);
+void AssetBinaryWriter::SetOptions(const BinaryWriteOptions& Options) {
+    mOptions = Options;
+}
+
+const BinaryWriteOptions& AssetBinaryWriter::GetOptions() const {
+    return mOptions;
+}
+
+void AssetBinaryWriter::SetThreadPool(std::shared_ptr<ThreadPool> Pool) {
+    mThreadPool = std::move(Pool);
+}
+
+const BinaryWriteStats& AssetBinaryWriter::GetStats() const {
+    return mStats;
+}
+
+std::string AssetBinaryWriter::DescribeOptions() const {
+    const std::string Layout{ std::string{ " quantize=" } + (mOptions.QuantizeVertices ? "1" : "0") + " index16=" + (mOptions.ShortIndices ? "1" : "0") };
+    if (!mOptions.Compress) {
+        return "compress=none" + Layout;
+    }
+    return "compress=lz chunk=" + std::to_string(mOptions.ChunkSize) + Layout;
+}
+
+void AssetBinaryWriter::WriteHeader(const std::vector<BinarySectionEntry>& Sections) {
+    BinaryFileHeader Header{};
+    Header.Magic = BinaryMagic;
+    Header.Version = FormatVersion;
+    Header.SectionCount = static_cast<std::uint32_t>(Sections.size());
+    WriteBytes(&Header, sizeof(Header));
+    WriteBytes(Sections.data(), Sections.size() * sizeof(BinarySectionEntry));
 }
 
 void AssetBinaryWriter::WriteMaterials(const std::vector<Material>& Materials) {
@@ -83,106 +424,195 @@ void AssetBinaryWriter::WriteMaterialMap(const MaterialMap& Map) {
     }
 }
 
-void AssetBinaryWriter::WriteModelResult(const ModelResult& Result) {
-    std::vector<const ModelNode*> Nodes{};
-    std::vector<const ModelNode*> Stack{};
-    const ModelNode* Root{ Result.GetRoot() };
-    if (Root != nullptr) {
-        Stack.push_back(Root);
-        while (!Stack.empty()) {
-            const ModelNode* Node{ Stack.back() };
-            Stack.pop_back();
-            Nodes.push_back(Node);
-            const std::vector<ModelNode*>& Children{ Node->GetChildren() };
-            for (std::size_t Index{ Children.size() }; Index > 0; --Index) {
-                Stack.push_back(Children[Index - 1]);
-            }
-        }
-    }
-
-    std::unordered_map<const ModelNode*, std::uint32_t> NodeIndices{};
-    NodeIndices.reserve(Nodes.size());
-    for (std::uint32_t Index{ 0 }; Index < Nodes.size(); ++Index) {
-        NodeIndices.emplace(Nodes[Index], Index);
+void AssetBinaryWriter::WriteStrings(const std::vector<const ModelNode*>& Nodes, std::vector<BinaryNodeRecord>& Records) {
+    std::uint32_t Offset{ 0 };
+    for (std::size_t Index{ 0 }; Index < Nodes.size(); ++Index) {
+        const std::string& Name{ Nodes[Index]->GetName() };
+        Records[Index].NameOffset = Offset;
+        Records[Index].NameLength = static_cast<std::uint32_t>(Name.size());
+        WriteBytes(Name.data(), Name.size());
+        Offset += static_cast<std::uint32_t>(Name.size());
     }
-
-    WriteUint64(static_cast<std::uint64_t>(Nodes.size()));
-    WriteNodes(Nodes, NodeIndices);
 }
 
-void AssetBinaryWriter::WriteNodes(const std::vector<const ModelNode*>& Nodes, const std::unordered_map<const ModelNode*, std::uint32_t>& NodeIndices) {
-    for (const ModelNode* Node : Nodes) {
-        WriteNode(*Node, NodeIndices);
-    }
+void AssetBinaryWriter::WriteTable(const BinaryTableHeader& Header, const void* Records, std::size_t RecordBytes) {
+    WriteBytes(&Header, sizeof(Header));
+    WriteBytes(Records, RecordBytes);
 }
 
-void AssetBinaryWriter::WriteNode(const ModelNode& Node, const std::unordered_map<const ModelNode*, std::uint32_t>& NodeIndices) {
-    WriteString(Node.GetName());
-    const ModelNode* Parent{ Node.GetParent() };
-    if (Parent == nullptr) {
-        WriteInt32(-1);
+void AssetBinaryWriter::WriteMeshlets(const std::vector<const ModelMesh*>& Meshes) {
+    std::vector<BinaryMeshletRange> Ranges{};
+    Ranges.reserve(Meshes.size());
+    std::vector<BinaryMeshletRecord> Records{};
+    for (const ModelMesh* Mesh : Meshes) {
+        Ranges.push_back(BinaryMeshletRange{ Records.size(), Mesh->Meshlets().size() });
+        for (const ModelMesh::Meshlet& Meshlet : Mesh->Meshlets()) {
+            Records.push_back(BinaryMeshletRecord{ Meshlet.IndexOffset, Meshlet.IndexCount, Meshlet.Center, Meshlet.Radius, Meshlet.ConeAxis, Meshlet.ConeCutoff });
+        }
     }
-    else {
-        const auto Found{ NodeIndices.find(Parent) };
-        WriteInt32(Found == NodeIndices.end() ? -1 : static_cast<std::int32_t>(Found->second));
+    WriteTable(BinaryTableHeader{ static_cast<std::uint32_t>(Ranges.size()), sizeof(BinaryMeshletRange), 0, 0 }, Ranges.data(), Ranges.size() * sizeof(BinaryMeshletRange));
+    WriteTable(BinaryTableHeader{ static_cast<std::uint32_t>(Records.size()), sizeof(BinaryMeshletRecord), 0, 0 }, Records.data(), Records.size() * sizeof(BinaryMeshletRecord));
+}
+
+void AssetBinaryWriter::WriteLods(const std::vector<const ModelMesh*>& Meshes) {
+    std::vector<BinaryLodRange> Ranges{};
+    Ranges.reserve(Meshes.size());
+    std::vector<BinaryLodRecord> Records{};
+    for (const ModelMesh* Mesh : Meshes) {
+        Ranges.push_back(BinaryLodRange{ Records.size(), Mesh->Lods().size() });
+        for (const ModelMesh::Lod& Lod : Mesh->Lods()) {
+            BinaryLodRecord Record{};
+            Record.SubMeshIndex = static_cast<std::uint32_t>(Lod.SubMeshIndex);
+            Record.Level = static_cast<std::uint32_t>(Lod.Level);
+            Record.IndexOffset = Lod.IndexOffset;
+            Record.IndexCount = Lod.IndexCount;
+            Record.Error = Lod.Error;
+            Records.push_back(Record);
+        }
     }
-    WriteMat4(Node.GetNodeToParent());
-    WriteMat4(Node.GetGeometryToNode());
-    WriteVertexAttributes(Node.Vertices());
-    WriteUint32Array(Node.Indices());
-    WriteSubMeshes(Node.GetSubMeshes());
-}
-
-void AssetBinaryWriter::WriteVertexAttributes(const VertexAttributes& Attributes) {
-    WriteVec3Array(Attributes.Positions);
-    WriteVec3Array(Attributes.Normals);
-    for (std::size_t Index{ 0 }; Index < Attributes.TexCoords.size(); ++Index) {
-        WriteVec2Array(Attributes.TexCoords[Index]);
+    WriteTable(BinaryTableHeader{ static_cast<std::uint32_t>(Ranges.size()), sizeof(BinaryLodRange), 0, 0 }, Ranges.data(), Ranges.size() * sizeof(BinaryLodRange));
+    WriteTable(BinaryTableHeader{ static_cast<std::uint32_t>(Records.size()), sizeof(BinaryLodRecord), 0, 0 }, Records.data(), Records.size() * sizeof(BinaryLodRecord));
+}
+
+bool AssetBinaryWriter::WriteGeometryData(const std::vector<const ModelMesh*>& Meshes, std::vector<BinaryGeometryRecord>& Geometries) {
+    GeometryScratch Scratch{};
+    QuantizedVertexStreams Quantized{};
+    for (std::size_t Index{ 0 }; Index < Meshes.size(); ++Index) {
+        BinaryGeometryRecord& Geometry{ Geometries[Index] };
+        const std::array<StreamSource, StreamCount> Streams{ GatherStreams(*Meshes[Index], mOptions.ShortIndices, Scratch) };
+        if (mOptions.QuantizeVertices) {
+            VertexFormats Formats{};
+            for (std::size_t Stream{ 0 }; Stream < VertexStreamCount; ++Stream) {
+                Formats[Stream] = Geometry.Streams[Stream].Format;
+            }
+            QuantizeVertices(VertexAttributeView{ Meshes[Index]->Vertices() }, Formats, Quantized);
+        }
+        for (std::size_t Stream{ 0 }; Stream < StreamCount; ++Stream) {
+            BinaryStreamDesc& Desc{ Geometry.Streams[Stream] };
+            if (Desc.ByteSize == 0) {
+                continue;
+            }
+            const bool IsQuantized{ Stream < VertexStreamCount && !Quantized[Stream].empty() };
+            const std::span<const std::byte> Bytes{ IsQuantized ? std::span<const std::byte>{ Quantized[Stream] } : Streams[Stream].Bytes };
+            WritePadding();
+            Desc.Offset = mOffset;
+            const bool Compress{ mOptions.Compress && Stream != static_cast<std::size_t>(BinaryStream::SubMeshes) && Desc.ByteSize >= MinCompressedStreamBytes };
+            if (!Compress) {
+                WriteBytes(Bytes.data(), Bytes.size());
+                continue;
+            }
+            if (!WriteCompressedStream(Bytes, Desc)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool AssetBinaryWriter::WriteCompressedStream(std::span<const std::byte> Bytes, BinaryStreamDesc& Desc) {
+    const std::size_t ChunkSize{ std::max<std::size_t>(mOptions.ChunkSize & ~std::uint32_t{ 3 }, 4) };
+    const std::size_t ChunkCount{ (Bytes.size() + ChunkSize - 1) / ChunkSize };
+    std::vector<std::vector<std::byte>> Chunks{};
+    Chunks.resize(ChunkCount);
+    std::vector<std::byte> Shuffled{};
+    Shuffled.resize(Bytes.size());
+    ThreadPool& Pool{ AcquireThreadPool() };
+
+    const Clock::time_point CompressStart{ Clock::now() };
+    Pool.ParallelFor(ChunkCount, [&](std::size_t Index) {
+        const std::size_t Begin{ Index * ChunkSize };
+        const std::size_t Size{ std::min(ChunkSize, Bytes.size() - Begin) };
+        const std::span<const std::byte> Raw{ Bytes.subspan(Begin, Size) };
+        const std::span<std::byte> Planes{ std::span<std::byte>{ Shuffled }.subspan(Begin, Size) };
+        LzCodec::Shuffle4(Raw, Planes);
+        std::vector<std::byte>& Stored{ Chunks[Index] };
+        Stored.resize(LzCodec::CompressBound(Size));
+        const std::size_t StoredSize{ LzCodec::Compress(Planes, Stored) };
+        if (StoredSize == 0 || StoredSize >= Size) {
+            Stored.assign(Raw.begin(), Raw.end());
+            return;
+        }
+        Stored.resize(StoredSize);
+    });
+
+    // Decode every chunk back into Decoded, reusing Shuffled as the plane
+    // buffer, exactly as a reader would.
+    std::vector<std::byte> Decoded{};
+    Decoded.resize(Bytes.size());
+    std::atomic<bool> Valid{ true };
+    const Clock::time_point DecodeStart{ Clock::now() };
+    Pool.ParallelFor(ChunkCount, [&](std::size_t Index) {
+        const std::size_t Begin{ Index * ChunkSize };
+        const std::size_t Size{ std::min(ChunkSize, Bytes.size() - Begin) };
+        const std::span<std::byte> Output{ std::span<std::byte>{ Decoded }.subspan(Begin, Size) };
+        if (Chunks[Index].size() == Size) {
+            std::memcpy(Output.data(), Chunks[Index].data(), Size);
+            return;
+        }
+        const std::span<std::byte> Planes{ std::span<std::byte>{ Shuffled }.subspan(Begin, Size) };
+        if (!LzCodec::Decompress(Chunks[Index], Planes)) {
+            Valid = false;
+            return;
+        }
+        LzCodec::Unshuffle4(Planes, Output);
+    });
+    const Clock::time_point DecodeEnd{ Clock::now() };
+    if (!Valid || std::memcmp(Decoded.data(), Bytes.data(), Bytes.size()) != 0) {
+        return false;
     }
-    WriteVec4Array(Attributes.Colors);
-    WriteVec3Array(Attributes.Tangents);
-    WriteVec3Array(Attributes.Bitangents);
-    WriteUvec4Array(Attributes.BoneIndices);
-    WriteVec4Array(Attributes.BoneWeights);
-}
 
-void AssetBinaryWriter::WriteSubMeshes(const std::vector<ModelNode::SubMesh>& SubMeshes) {
-    WriteUint64(static_cast<std::uint64_t>(SubMeshes.size()));
-    for (const ModelNode::SubMesh& SubMesh : SubMeshes) {
-        WriteUint64(static_cast<std::uint64_t>(SubMesh.IndexOffset));
-        WriteUint64(static_cast<std::uint64_t>(SubMesh.IndexCount));
-        WriteUint64(static_cast<std::uint64_t>(SubMesh.MaterialIndex));
+    BinaryChunkHeader Header{};
+    Header.ChunkCount = static_cast<std::uint32_t>(ChunkCount);
+    Header.ChunkSize = static_cast<std::uint32_t>(ChunkSize);
+    std::vector<BinaryChunkEntry> Entries{};
+    Entries.resize(ChunkCount);
+    std::uint64_t PayloadOffset{ mOffset + sizeof(Header) + ChunkCount * sizeof(BinaryChunkEntry) };
+    for (std::size_t Index{ 0 }; Index < ChunkCount; ++Index) {
+        Entries[Index].Offset = PayloadOffset;
+        Entries[Index].StoredSize = static_cast<std::uint32_t>(Chunks[Index].size());
+        Entries[Index].RawSize = static_cast<std::uint32_t>(std::min(ChunkSize, Bytes.size() - Index * ChunkSize));
+        PayloadOffset += Chunks[Index].size();
     }
-}
 
-void AssetBinaryWriter::WriteVec2Array(std::span<const Vec2> Values) {
-    WriteUint64(static_cast<std::uint64_t>(Values.size()));
-    WriteBytes(Values.data(), Values.size_bytes());
-}
+    const std::uint64_t Start{ mOffset };
+    Desc.Encoding = BinaryEncoding::ChunkedLz;
+    WriteBytes(&Header, sizeof(Header));
+    WriteBytes(Entries.data(), Entries.size() * sizeof(BinaryChunkEntry));
+    for (const std::vector<std::byte>& Chunk : Chunks) {
+        WriteBytes(Chunk.data(), Chunk.size());
+    }
 
-void AssetBinaryWriter::WriteVec3Array(std::span<const Vec3> Values) {
-    WriteUint64(static_cast<std::uint64_t>(Values.size()));
-    WriteBytes(Values.data(), Values.size_bytes());
+    mStats.RawBytes += Bytes.size();
+    mStats.StoredBytes += mOffset - Start;
+    mStats.ChunkCount += ChunkCount;
+    mStats.CompressSeconds += SecondsBetween(CompressStart, DecodeStart);
+    mStats.DecodeSeconds += SecondsBetween(DecodeStart, DecodeEnd);
+    return true;
 }
 
-void AssetBinaryWriter::WriteVec4Array(std::span<const Vec4> Values) {
-    WriteUint64(static_cast<std::uint64_t>(Values.size()));
-    WriteBytes(Values.data(), Values.size_bytes());
+void AssetBinaryWriter::WritePadding() {
+    constexpr std::array<std::byte, BinarySectionAlignment> Zeros{};
+    const std::uint64_t Aligned{ AlignBinaryOffset(mOffset) };
+    WriteBytes(Zeros.data(), static_cast<std::size_t>(Aligned - mOffset));
 }
 
-void AssetBinaryWriter::WriteUvec4Array(std::span<const UVec4> Values) {
-    WriteUint64(static_cast<std::uint64_t>(Values.size()));
-    WriteBytes(Values.data(), Values.size_bytes());
+ThreadPool& AssetBinaryWriter::AcquireThreadPool() {
+    if (mThreadPool == nullptr) {
+        mThreadPool = std::make_shared<ThreadPool>(ThreadPool::DefaultWorkerCount());
+    }
+    return *mThreadPool;
 }
 
-void AssetBinaryWriter::WriteUint32Array(std::span<const std::uint32_t> Values) {
-    WriteUint64(static_cast<std::uint64_t>(Values.size()));
-    WriteBytes(Values.data(), Values.size_bytes());
+BinarySectionEntry AssetBinaryWriter::BeginSection(BinarySection Tag) {
+    WritePadding();
+    BinarySectionEntry Section{};
+    Section.Tag = static_cast<std::uint32_t>(Tag);
+    Section.Offset = mOffset;
+    return Section;
 }
 
-void AssetBinaryWriter::WriteUint64Array(std::span<const std::uint64_t> Values) {
-    WriteUint64(static_cast<std::uint64_t>(Values.size()));
-    WriteBytes(Values.data(), Values.size_bytes());
+void AssetBinaryWriter::EndSection(BinarySectionEntry& Section) {
+    Section.Size = mOffset - Section.Offset;
 }
 
 void AssetBinaryWriter::WriteString(const std::string& Value) {
@@ -241,4 +671,5 @@ void AssetBinaryWriter::WriteMat4(const Mat4& Value) {
 
 void AssetBinaryWriter::WriteBytes(const void* Data, std::size_t Size) {
     mStream.write(reinterpret_cast<const char*>(Data), static_cast<std::streamsize>(Size));
+    mOffset += Size;
 }
@@ -1,67 +1,62 @@
 /*
- * ============================================================================
- * FBXB BINARY FORMAT (v2) SPECIFICATION
- * ============================================================================
- *
- * [ HEADER ]
- * +----------+----------+---------------------------------------------------+
- * | Magic    | char[4]  | "FBXB"                                            |
- * | Version  | uint32   | 2                                                 |
- * +----------+----------+---------------------------------------------------+
- *
- * [ MATERIALS ]
- * +---------------+--------+------------------------------------------------+
- * | MaterialCount | uint64 | Total number of materials                      |
- * +---------------+--------+------------------------------------------------+
- * | [ Material Block ] x MaterialCount                                      |
- * |  +---------------+--------+---------------------------------------------+
- * |  | PbrFlag       | uint8  | Physically Based Rendering flag             |
- * |  | PropertyCount | uint64 | Number of properties in this material       |
- * |  +---------------+--------+---------------------------------------------+
- * |  | [ Property Block ] x PropertyCount                                   |
- * |  |  +----------+--------+-----------------------------------------------+
- * |  |  | Type     | uint16 | Property type identifier                     |
- * |  |  | MapKind  | uint8  | 0:None, 1:Real(f32), 2:Int(i64), 3:Bool(u8),  |
- * |  |  |          |        | 4:Vec2, 5:Vec3, 6:Vec4, 7:String(u64+char[])  |
- * |  |  | Payload  | mixed  | (Data size varies based on MapKind)          |
- * |  |  +----------+--------+-----------------------------------------------+
- *
- * [ NODES ] (DFS Order)
- * +---------------+--------+------------------------------------------------+
- * | NodeCount     | uint64 | Total number of nodes                          |
- * +---------------+--------+------------------------------------------------+
- * | [ Node Block ] x NodeCount                                              |
- * |  +------------------+----------+----------------------------------------+
- * |  | Name             | String   | (uint64 Length + char[Length])         |
- * |  | ParentIndex      | int32    | -1 if root                             |
- * |  | NodeToParent     | mat4     | 4x4 Transformation matrix              |
- * |  | GeometryToNode   | mat4     | 4x4 Offset matrix                      |
- * |  +------------------+----------+----------------------------------------+
- * |  | VertexAttributes | (Nested) | For each attribute: uint64 Count + Raw |
- * |  |                  |          | [Pos, Norm, UV[4], Col, Tan, Bitan,    |
- * |  |                  |          |  BoneIdx, BoneWeight]                  |
- * |  +------------------+----------+----------------------------------------+
- * |  | Indices          | (Nested) | uint64 Count + uint32[Count]           |
- * |  | SubMeshes        | (Nested) | uint64 Count + SubMesh[Count]          |
- * |  +------------------+----------+----------------------------------------+
- *
- * [ SubMesh ]
- * +----------------+--------+-----------------------------------------------+
- * | IndexOffset    | uint64 | Start index in the node index buffer          |
- * | IndexCount     | uint64 | Number of indices to draw                     |
- * | MaterialIndex  | uint64 | Material reference index                      |
- * +----------------+--------+-----------------------------------------------+
+ * Writes the FBXB v3 layout described in AssetBinaryFormat.h. The file is
+ * produced in one forward pass; stream offsets are filled in as DATA is
+ * written and the GEOM table and section table are rewritten at the end.
  */
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
+#include <memory>
+#include <span>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "AssetBinaryFormat.h"
 #include "AssetBundle.h"
+#include "ThreadPool.h"
 
 namespace asset {
+    struct BinaryWriteOptions final {
+    public:
+        // Store vertex and index streams as ChunkedLz instead of Raw.
+        bool Compress{ false };
+        // Decoded bytes per chunk; rounded down to a multiple of 4.
+        std::uint32_t ChunkSize{ 256 * 1024 };
+        // Store vertex streams in the quantised formats ChooseQuantizedFormats
+        // picks instead of float.
+        bool QuantizeVertices{ false };
+        // Store a geometry's indices as Uint16, rebased per SubMesh, when
+        // every SubMesh spans at most 65536 vertices.
+        bool ShortIndices{ true };
+    };
+
+    // Totals over the compressed streams of the last WriteToFile. Every chunk
+    // is decoded again after compression to verify it, and that pass is timed.
+    // The vertex and index totals cover every geometry before compression.
+    struct BinaryWriteStats final {
+    public:
+        std::uint64_t RawBytes{ 0 };
+        std::uint64_t StoredBytes{ 0 };
+        std::uint64_t ChunkCount{ 0 };
+        double CompressSeconds{ 0.0 };
+        double DecodeSeconds{ 0.0 };
+        std::uint64_t VertexCount{ 0 };
+        std::uint64_t VertexBytes{ 0 };
+        std::uint64_t FloatVertexBytes{ 0 };
+        // Written index bytes, and what they take as Uint32.
+        std::uint64_t IndexBytes{ 0 };
+        std::uint64_t WideIndexBytes{ 0 };
+
+        double CompressionRatio() const;
+        double DecodeGigabytesPerSecond() const;
+        // Written vertex stream bytes per vertex, and the same with every
+        // stream in float.
+        double BytesPerVertex() const;
+        double FloatBytesPerVertex() const;
+    };
+
     class AssetBinaryWriter final {
     public:
         AssetBinaryWriter();
@@ -72,26 +67,40 @@ namespace asset {
         AssetBinaryWriter(AssetBinaryWriter&& Other) noexcept = delete;
         AssetBinaryWriter& operator=(AssetBinaryWriter&& Other) noexcept = delete;
 
+    public:
+        // Bumped whenever the byte layout changes; cook manifests record it so
+        // stale outputs are rebuilt.
+        static constexpr std::uint32_t FormatVersion{ 3 };
+
     public:
         bool WriteToFile(const std::string& Path, const AssetBundle& Bundle);
 
+        void SetOptions(const BinaryWriteOptions& Options);
+        const BinaryWriteOptions& GetOptions() const;
+        // Chunks are compressed on this pool; without one a pool is created on
+        // first use.
+        void SetThreadPool(std::shared_ptr<ThreadPool> Pool);
+        const BinaryWriteStats& GetStats() const;
+
+        // Stable text form of the options that affect the written bytes.
+        std::string DescribeOptions() const;
+
     private:
-        void WriteHeader();
+        void WriteHeader(const std::vector<BinarySectionEntry>& Sections);
         void WriteMaterials(const std::vector<Material>& Materials);
         void WriteMaterial(const Material& MaterialData);
         void WriteMaterialProperty(const MaterialProperty& Property);
         void WriteMaterialMap(const MaterialMap& Map);
-        void WriteModelResult(const ModelResult& Result);
-        void WriteNodes(const std::vector<const ModelNode*>& Nodes, const std::unordered_map<const ModelNode*, std::uint32_t>& NodeIndices);
-        void WriteNode(const ModelNode& Node, const std::unordered_map<const ModelNode*, std::uint32_t>& NodeIndices);
-        void WriteVertexAttributes(const VertexAttributes& Attributes);
-        void WriteSubMeshes(const std::vector<ModelNode::SubMesh>& SubMeshes);
-        void WriteVec2Array(std::span<const Vec2> Values);
-        void WriteVec3Array(std::span<const Vec3> Values);
-        void WriteVec4Array(std::span<const Vec4> Values);
-        void WriteUvec4Array(std::span<const UVec4> Values);
-        void WriteUint32Array(std::span<const std::uint32_t> Values);
-        void WriteUint64Array(std::span<const std::uint64_t> Values);
+        void WriteStrings(const std::vector<const ModelNode*>& Nodes, std::vector<BinaryNodeRecord>& Records);
+        void WriteTable(const BinaryTableHeader& Header, const void* Records, std::size_t RecordBytes);
+        void WriteMeshlets(const std::vector<const ModelMesh*>& Meshes);
+        void WriteLods(const std::vector<const ModelMesh*>& Meshes);
+        bool WriteGeometryData(const std::vector<const ModelMesh*>& Meshes, std::vector<BinaryGeometryRecord>& Geometries);
+        bool WriteCompressedStream(std::span<const std::byte> Bytes, BinaryStreamDesc& Desc);
+        void WritePadding();
+        ThreadPool& AcquireThreadPool();
+        BinarySectionEntry BeginSection(BinarySection Tag);
+        void EndSection(BinarySectionEntry& Section);
 
         void WriteString(const std::string& Value);
         void WriteUint8(std::uint8_t Value);
@@ -110,5 +119,9 @@ namespace asset {
 
     private:
         std::ofstream mStream{};
+        std::uint64_t mOffset{ 0 };
+        BinaryWriteOptions mOptions{};
+        BinaryWriteStats mStats{};
+        std::shared_ptr<ThreadPool> mThreadPool{};
     };
 }
@@ -0,0 +1,396 @@
+#include "BatchConverter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <optional>
+#include <sstream>
+
+#include "AssetBinaryWriter.h"
+#include "AssetBundle.h"
+#include "CookManifest.h"
+#include "FbxAssetImporter.h"
+#include "MeshSimplifier.h"
+
+using namespace asset;
+
+namespace {
+    namespace Fs = std::filesystem;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr double BytesPerMegabyte{ 1024.0 * 1024.0 };
+    constexpr double LiveReportSeconds{ 1.0 };
+
+    double SecondsBetween(Clock::time_point Start, Clock::time_point End) {
+        return std::chrono::duration<double>{ End - Start }.count();
+    }
+
+    std::uintmax_t FileSizeOrZero(const Fs::path& Path) {
+        std::error_code Error{};
+        const std::uintmax_t Size{ Fs::file_size(Path, Error) };
+        return Error ? 0 : Size;
+    }
+
+    void LogCacheReports(std::span<const VertexCacheReport> Reports, std::ostream& Log) {
+        Log << std::fixed << std::setprecision(3);
+        for (const VertexCacheReport& Report : Reports) {
+            Log << "  " << Report.NodeName << " (mesh " << Report.MeshIndex << ", " << Report.TriangleCount << " tris): ACMR "
+                << Report.Before.Acmr << " -> " << Report.After.Acmr << ", ATVR " << Report.Before.Atvr << " -> " << Report.After.Atvr << "\n";
+        }
+        Log << std::defaultfloat;
+    }
+
+    double Throughput(std::uintmax_t Bytes, double Seconds) {
+        if (Seconds <= 0.0) {
+            return 0.0;
+        }
+        return (static_cast<double>(Bytes) / BytesPerMegabyte) / Seconds;
+    }
+
+    // Returns an in-flight slot when a batch task ends, including by exception, so Run never waits on a slot that is gone.
+    struct SlotRelease final {
+    public:
+        std::mutex& Mutex;
+        std::condition_variable& Released;
+        std::size_t& InFlight;
+
+        ~SlotRelease() {
+            {
+                std::lock_guard<std::mutex> Lock{ Mutex };
+                --InFlight;
+            }
+            Released.notify_one();
+        }
+    };
+}
+
+BatchConverter::BatchConverter(BatchConvertOptions Options)
+    : mOptions{ Options }
+    , mThreadPool{ std::make_shared<ThreadPool>(Options.WorkerCount) } {
+}
+
+std::vector<ConvertResult> BatchConverter::Run(std::span<const ConvertJob> Jobs, std::ostream& Log) {
+    std::vector<ConvertResult> Results{};
+    Results.resize(Jobs.size());
+
+    const std::size_t MaxInFlight{ (mOptions.MaxInFlight == 0) ? mThreadPool->GetWorkerCount() : mOptions.MaxInFlight };
+    std::mutex SlotMutex{};
+    std::condition_variable SlotReleased{};
+    std::size_t InFlight{ 0 };
+    std::mutex LogMutex{};
+
+    ThreadPool::TaskGroup Group{};
+    for (std::size_t Index{ 0 }; Index < Jobs.size(); ++Index) {
+        {
+            std::unique_lock<std::mutex> Lock{ SlotMutex };
+            SlotReleased.wait(Lock, [&]() { return InFlight < MaxInFlight; });
+            ++InFlight;
+        }
+        mThreadPool->Submit(Group, [&, Index]() {
+            const SlotRelease Slot{ SlotMutex, SlotReleased, InFlight };
+            Results[Index] = ConvertOne(Jobs[Index], Log, LogMutex);
+            {
+                const ConvertResult& Result{ Results[Index] };
+                std::lock_guard<std::mutex> Lock{ LogMutex };
+                if (Result.UpToDate) {
+                    Log << "Up to date: " << Result.Job.Output.string() << "\n";
+                }
+                else if (Result.Succeeded && Result.CompressionRatio > 0.0) {
+                    Log << "Binary saved: " << Result.Job.Output.string() << std::fixed << std::setprecision(2)
+                        << " (ratio " << Result.CompressionRatio << "x, decode " << Result.DecodeGigabytesPerSecond << " GB/s)\n" << std::defaultfloat;
+                }
+                else if (Result.Succeeded) {
+                    Log << "Binary saved: " << Result.Job.Output.string() << "\n";
+                }
+                else {
+                    Log << "Binary save failed: " << Result.Job.Output.string() << " (" << Result.Message << ")\n";
+                }
+                if (Result.Succeeded) {
+                    LogCacheReports(Result.CacheReports, Log);
+                }
+                if (Result.Succeeded && Result.MeshletCount > 0) {
+                    Log << "  " << Result.MeshletCount << " meshlets, " << std::fixed << std::setprecision(1)
+                        << static_cast<double>(Result.MeshletTriangleCount) / static_cast<double>(Result.MeshletCount) << " tris each\n" << std::defaultfloat;
+                }
+                if (Result.Succeeded && Result.LodTriangleCounts.size() > 1) {
+                    for (std::size_t Level{ 1 }; Level < Result.LodTriangleCounts.size(); ++Level) {
+                        Log << "  LOD" << Level << ": " << Result.LodTriangleCounts[Level] << " tris (" << std::fixed << std::setprecision(1)
+                            << 100.0 * static_cast<double>(Result.LodTriangleCounts[Level]) / static_cast<double>(Result.LodTriangleCounts[0])
+                            << "% of LOD0), error " << std::setprecision(4) << Result.LodErrors[Level] << "\n" << std::defaultfloat;
+                    }
+                }
+                if (Result.Succeeded && Result.BytesPerVertex > 0.0) {
+                    Log << "  vertices: " << std::fixed << std::setprecision(1) << Result.BytesPerVertex << " bytes each ("
+                        << Result.FloatBytesPerVertex << " as float)\n" << std::defaultfloat;
+                }
+                if (Result.Succeeded && Result.IndexBytes < Result.WideIndexBytes) {
+                    Log << "  indices: " << Result.IndexBytes << " bytes (" << Result.WideIndexBytes << " as 32-bit)\n";
+                }
+            }
+        });
+    }
+    mThreadPool->Wait(Group);
+    return Results;
+}
+
+Fs::path BatchConverter::MakeBinaryPath(const Fs::path& FbxPath) {
+    Fs::path OutputPath{ FbxPath };
+    OutputPath.replace_extension(".fbxbin");
+    return OutputPath;
+}
+
+std::vector<ConvertJob> BatchConverter::LoadJobList(const Fs::path& ListPath, std::ostream& Log) {
+    std::vector<ConvertJob> Jobs{};
+    std::ifstream Input{ ListPath };
+    if (!Input.is_open()) {
+        Log << "No entries found in list file: " << ListPath.string() << "\n";
+        return Jobs;
+    }
+    const Fs::path BaseDir{ ListPath.parent_path() };
+    std::string Line{};
+    while (std::getline(Input, Line)) {
+        if (Line.empty()) {
+            continue;
+        }
+        Fs::path FbxPath{ Line };
+        if (FbxPath.is_relative()) {
+            FbxPath = BaseDir / FbxPath;
+        }
+        if (!Fs::exists(FbxPath)) {
+            Log << "Missing FBX file: " << FbxPath.string() << "\n";
+            continue;
+        }
+        const std::string Extension{ FbxPath.extension().string() };
+        if (Extension != ".fbx" && Extension != ".FBX") {
+            Log << "Skipping non-FBX entry: " << FbxPath.string() << "\n";
+            continue;
+        }
+        Jobs.push_back(ConvertJob{ FbxPath, MakeBinaryPath(FbxPath) });
+    }
+    if (Jobs.empty()) {
+        Log << "No entries found in list file: " << ListPath.string() << "\n";
+    }
+    return Jobs;
+}
+
+void BatchConverter::PrintSummary(std::span<const ConvertResult> Results, double WallSeconds, std::ostream& Out) {
+    const std::ios::fmtflags Flags{ Out.flags() };
+    const std::streamsize Precision{ Out.precision() };
+
+    std::size_t Succeeded{ 0 };
+    std::size_t UpToDate{ 0 };
+    std::uintmax_t SourceBytes{ 0 };
+    std::uintmax_t OutputBytes{ 0 };
+
+    Out << std::fixed << std::setprecision(1);
+    Out << "\n" << std::setw(10) << "import ms" << std::setw(10) << "parse ms" << std::setw(10) << "write ms" << std::setw(10) << "in MB" << std::setw(10) << "out MB" << std::setw(10) << "MB/s"
+        << std::setw(10) << "ufbx MB" << std::setw(10) << "RSS MB" << "  file\n";
+    for (const ConvertResult& Result : Results) {
+        if (Result.UpToDate) {
+            ++UpToDate;
+            Out << std::setw(80) << "" << "  " << Result.Job.Source.string() << " [up to date]\n";
+            continue;
+        }
+        const double Seconds{ Result.ImportSeconds + Result.WriteSeconds };
+        Out << std::setw(10) << Result.ImportSeconds * 1000.0
+            << std::setw(10) << Result.ParseSeconds * 1000.0
+            << std::setw(10) << Result.WriteSeconds * 1000.0
+            << std::setw(10) << static_cast<double>(Result.SourceBytes) / BytesPerMegabyte
+            << std::setw(10) << static_cast<double>(Result.OutputBytes) / BytesPerMegabyte
+            << std::setw(10) << Throughput(Result.SourceBytes, Seconds)
+            << std::setw(10) << static_cast<double>(Result.ParseBytes) / BytesPerMegabyte
+            << std::setw(10) << static_cast<double>(Result.PeakResidentBytes) / BytesPerMegabyte
+            << "  " << Result.Job.Source.string() << (Result.Succeeded ? "" : " [FAILED]") << "\n";
+        if (Result.Succeeded) {
+            ++Succeeded;
+            SourceBytes += Result.SourceBytes;
+            OutputBytes += Result.OutputBytes;
+        }
+    }
+
+    Out << "Converted " << Succeeded << "/" << (Results.size() - UpToDate) << " files (" << UpToDate << " up to date), "
+        << static_cast<double>(SourceBytes) / BytesPerMegabyte << " MB -> " << static_cast<double>(OutputBytes) / BytesPerMegabyte << " MB in "
+        << std::setprecision(2) << WallSeconds << " s ("
+        << std::setprecision(1) << Throughput(SourceBytes, WallSeconds) << " MB/s, "
+        << std::setprecision(2) << ((WallSeconds > 0.0) ? static_cast<double>(Succeeded) / WallSeconds : 0.0) << " files/s)\n";
+
+    Out.flags(Flags);
+    Out.precision(Precision);
+}
+
+ConvertResult BatchConverter::ConvertOne(const ConvertJob& Job, std::ostream& Log, std::mutex& LogMutex) {
+    ConvertResult Result{};
+    Result.Job = Job;
+    Result.SourceBytes = FileSizeOrZero(Job.Source);
+    bool OverBudget{ false };
+    try {
+        const Clock::time_point ImportStart{ Clock::now() };
+        FbxAssetImporter Importer{ mOptions.Api };
+        Importer.SetThreadPool(mThreadPool);
+        Importer.SetProfile(mOptions.Profile);
+        Importer.SetOptimizeMeshes(mOptions.OptimizeMeshes);
+        Importer.SetBuildMeshlets(mOptions.BuildMeshlets);
+        Importer.SetBuildLods(mOptions.BuildLods);
+        Importer.SetSplitForShortIndices(mOptions.SplitForShortIndices);
+        Importer.SetParseLimits(mOptions.Limits);
+        AssetBinaryWriter Writer{};
+        BinaryWriteOptions WriteOptions{};
+        WriteOptions.Compress = mOptions.Compress;
+        WriteOptions.QuantizeVertices = mOptions.QuantizeVertices;
+        WriteOptions.ShortIndices = mOptions.ShortIndices;
+        Writer.SetOptions(WriteOptions);
+        Writer.SetThreadPool(mThreadPool);
+
+        const Fs::path ManifestPath{ CookManifest::PathFor(Job.Output) };
+        CookManifest Cook{};
+        Cook.ImporterVersion = FbxAssetImporter::CookVersion;
+        Cook.FormatVersion = AssetBinaryWriter::FormatVersion;
+        Cook.Options = Importer.DescribeOptions() + " " + Writer.DescribeOptions();
+        Cook.SourceSize = Result.SourceBytes;
+        Cook.SourceTime = CookManifest::FileTime(Job.Source).value_or(0);
+
+        // Cheap checks first: settings, sizes and mtime come from the manifest
+        // and a stat. The source is only hashed when the mtime moved.
+        bool Hashed{ false };
+        const std::optional<CookManifest> Previous{ mOptions.Incremental ? CookManifest::Load(ManifestPath) : std::nullopt };
+        if (Previous.has_value() && Previous->SameSettings(Cook) && Previous->SourceSize == Cook.SourceSize && Previous->OutputSize == FileSizeOrZero(Job.Output) && Previous->OutputSize != 0) {
+            bool Unchanged{ Previous->SourceTime == Cook.SourceTime };
+            if (!Unchanged) {
+                Cook.SourceHash = CookManifest::HashFile(Job.Source).value_or(0);
+                Hashed = true;
+                Unchanged = (Cook.SourceHash == Previous->SourceHash);
+                if (Unchanged) {
+                    Cook.OutputSize = Previous->OutputSize;
+                    Cook.Save(ManifestPath);
+                }
+            }
+            if (Unchanged) {
+                Result.Succeeded = true;
+                Result.UpToDate = true;
+                Result.OutputBytes = Previous->OutputSize;
+                Result.ImportSeconds = SecondsBetween(ImportStart, Clock::now());
+                return Result;
+            }
+        }
+        if (!Hashed) {
+            const std::optional<std::uint64_t> Hash{ CookManifest::HashFile(Job.Source) };
+            if (!Hash.has_value()) {
+                throw AssetError{ "could not read source" };
+            }
+            Cook.SourceHash = *Hash;
+        }
+
+        // Drop the old manifest before touching the output so an interrupted
+        // write can never be mistaken for an up-to-date one.
+        std::error_code RemoveError{};
+        Fs::remove(ManifestPath, RemoveError);
+
+        // Progress arrives from the importing thread or, during mesh
+        // extraction, from one worker at a time.
+        const Clock::time_point LoadStart{ Clock::now() };
+        Clock::time_point StageStart{ LoadStart };
+        Clock::time_point LastReport{ LoadStart };
+        ImportStage CurrentStage{ ImportStage::Parse };
+        Importer.SetProgressCallback([&](const ImportProgress& Progress) {
+            const Clock::time_point Now{ Clock::now() };
+            if (mOptions.TimeBudgetSeconds > 0.0 && SecondsBetween(LoadStart, Now) > mOptions.TimeBudgetSeconds) {
+                OverBudget = true;
+                return false;
+            }
+            if (Progress.Stage != CurrentStage) {
+                CurrentStage = Progress.Stage;
+                StageStart = Now;
+            }
+            if (SecondsBetween(LastReport, Now) < LiveReportSeconds) {
+                return true;
+            }
+            LastReport = Now;
+            const double StageSeconds{ SecondsBetween(StageStart, Now) };
+            const std::lock_guard<std::mutex> Lock{ LogMutex };
+            Log << "  " << Job.Source.filename().string() << std::fixed << std::setprecision(1);
+            if (Progress.Stage == ImportStage::Parse) {
+                const double Percent{ (Progress.BytesTotal > 0) ? 100.0 * static_cast<double>(Progress.BytesRead) / static_cast<double>(Progress.BytesTotal) : 0.0 };
+                Log << ": parsing " << Percent << "%, " << Throughput(Progress.BytesRead, StageSeconds) << " MB/s\n";
+            }
+            else {
+                const double CornersPerSecond{ (StageSeconds > 0.0) ? static_cast<double>(Progress.CornersDone) / StageSeconds : 0.0 };
+                Log << ": meshes " << Progress.MeshesDone << "/" << Progress.MeshCount << ", " << CornersPerSecond / 1.0e6 << "M corners/s\n";
+            }
+            Log << std::defaultfloat;
+            return true;
+        });
+        AssetBundle Bundle{ Importer.LoadFromFile(Job.Source.string()) };
+        const Clock::time_point WriteStart{ Clock::now() };
+        const ParseStats& Parse{ Importer.GetParseStats() };
+        Result.ParseSeconds = Parse.ParseSeconds;
+        Result.ParseBytes = Parse.TempBytes + Parse.SceneBytes;
+        Result.PeakResidentBytes = Parse.PeakResidentBytes;
+        Result.CacheReports = Importer.GetVertexCacheReports();
+        const ModelResult& Meshes{ Bundle.GetModelResult() };
+        for (std::uint32_t MeshIndex{ 0 }; MeshIndex < Meshes.MeshCount(); ++MeshIndex) {
+            for (const ModelMesh::Meshlet& Meshlet : Meshes.GetMesh(MeshIndex).Meshlets()) {
+                ++Result.MeshletCount;
+                Result.MeshletTriangleCount += Meshlet.IndexCount / 3;
+            }
+        }
+        if (mOptions.BuildLods) {
+            Result.LodTriangleCounts.assign(DefaultLodCount + 1, 0);
+            Result.LodErrors.assign(DefaultLodCount + 1, 0.0f);
+            for (std::uint32_t MeshIndex{ 0 }; MeshIndex < Meshes.MeshCount(); ++MeshIndex) {
+                const ModelMesh& Mesh{ Meshes.GetMesh(MeshIndex) };
+                for (const ModelMesh::SubMesh& SubMesh : Mesh.GetSubMeshes()) {
+                    Result.LodTriangleCounts[0] += SubMesh.IndexCount / 3;
+                }
+                for (const ModelMesh::Lod& Lod : Mesh.Lods()) {
+                    Result.LodTriangleCounts[Lod.Level] += Lod.IndexCount / 3;
+                    Result.LodErrors[Lod.Level] = std::max(Result.LodErrors[Lod.Level], Lod.Error);
+                }
+            }
+            while (Result.LodTriangleCounts.size() > 1 && Result.LodTriangleCounts.back() == 0) {
+                Result.LodTriangleCounts.pop_back();
+                Result.LodErrors.pop_back();
+            }
+        }
+        Result.Succeeded = Writer.WriteToFile(Job.Output.string(), Bundle);
+        const Clock::time_point WriteEnd{ Clock::now() };
+        if (mOptions.Compress) {
+            Result.CompressionRatio = Writer.GetStats().CompressionRatio();
+            Result.DecodeGigabytesPerSecond = Writer.GetStats().DecodeGigabytesPerSecond();
+        }
+        if (mOptions.QuantizeVertices) {
+            Result.BytesPerVertex = Writer.GetStats().BytesPerVertex();
+            Result.FloatBytesPerVertex = Writer.GetStats().FloatBytesPerVertex();
+        }
+        Result.IndexBytes = Writer.GetStats().IndexBytes;
+        Result.WideIndexBytes = Writer.GetStats().WideIndexBytes;
+        Result.ImportSeconds = SecondsBetween(ImportStart, WriteStart);
+        Result.WriteSeconds = SecondsBetween(WriteStart, WriteEnd);
+        if (!Result.Succeeded) {
+            Result.Message = "could not write output";
+        }
+        else {
+            Cook.OutputSize = FileSizeOrZero(Job.Output);
+            Cook.Save(ManifestPath);
+        }
+    }
+    catch (const std::exception& Exception) {
+        Result.Succeeded = false;
+        if (OverBudget) {
+            std::ostringstream Message{};
+            Message << "exceeded the time budget of " << mOptions.TimeBudgetSeconds << " s";
+            Result.Message = Message.str();
+        }
+        else {
+            Result.Message = Exception.what();
+        }
+    }
+    catch (...) {
+        Result.Succeeded = false;
+        Result.Message = "unknown error";
+    }
+    Result.OutputBytes = Result.Succeeded ? FileSizeOrZero(Job.Output) : 0;
+    return Result;
+}
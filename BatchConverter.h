@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "MeshOptimizer.h"
+#include "ThreadPool.h"
+#include "UfbxAssetLoader.h"
+
+namespace asset {
+    struct ConvertJob final {
+    public:
+        std::filesystem::path Source{};
+        std::filesystem::path Output{};
+    };
+
+    struct ConvertResult final {
+    public:
+        ConvertJob Job{};
+        bool Succeeded{ false };
+        // Output and manifest already matched the source; nothing was imported.
+        bool UpToDate{ false };
+        std::string Message{};
+        double ImportSeconds{ 0.0 };
+        // Part of ImportSeconds spent inside ufbx, and the memory it used.
+        double ParseSeconds{ 0.0 };
+        std::uint64_t ParseBytes{ 0 };
+        std::uint64_t PeakResidentBytes{ 0 };
+        double WriteSeconds{ 0.0 };
+        std::uintmax_t SourceBytes{ 0 };
+        std::uintmax_t OutputBytes{ 0 };
+        // Only set when the output was written with compression.
+        double CompressionRatio{ 0.0 };
+        double DecodeGigabytesPerSecond{ 0.0 };
+        // Only filled when meshes were optimised.
+        std::vector<VertexCacheReport> CacheReports{};
+        // Only set when meshlets were built.
+        std::size_t MeshletCount{ 0 };
+        std::size_t MeshletTriangleCount{ 0 };
+        // Only filled when LODs were built: triangles of every mesh at each
+        // level, LOD0 first, and the largest error of each level.
+        std::vector<std::size_t> LodTriangleCounts{};
+        std::vector<float> LodErrors{};
+        // Only set when vertices were quantised: vertex stream bytes per
+        // vertex as written and as float.
+        double BytesPerVertex{ 0.0 };
+        double FloatBytesPerVertex{ 0.0 };
+        // Index stream bytes as written and as 32-bit.
+        std::uint64_t IndexBytes{ 0 };
+        std::uint64_t WideIndexBytes{ 0 };
+    };
+
+    struct BatchConvertOptions final {
+    public:
+        GraphicsAPI Api{ GraphicsAPI::OpenGL };
+        // 0 uses every hardware thread.
+        std::size_t WorkerCount{ 0 };
+        // Upper bound on imported bundles alive at once; 0 matches WorkerCount.
+        std::size_t MaxInFlight{ 0 };
+        // Skip sources whose cook manifest still matches; false rebuilds everything.
+        bool Incremental{ true };
+        // Write vertex and index streams as parallel-decodable LZ chunks.
+        bool Compress{ false };
+        // The cook only needs geometry, so animation and embedded media are
+        // not parsed unless asked for.
+        ImportProfile Profile{ ImportProfile::GeometryOnly };
+        // Reorder triangles and vertices for the GPU caches; logs ACMR/ATVR
+        // before and after for every mesh.
+        bool OptimizeMeshes{ false };
+        // Store meshlets with bounds and normal cones for cluster culling.
+        bool BuildMeshlets{ false };
+        // Store quadric-simplified LOD levels of every submesh with their
+        // error so viewers can draw distant meshes with fewer triangles.
+        bool BuildLods{ false };
+        // Store normals, texture coordinates, colours and skin weights in
+        // compact GPU formats instead of float.
+        bool QuantizeVertices{ false };
+        // Write 16-bit indices for every mesh whose submeshes fit.
+        bool ShortIndices{ true };
+        // Split meshes with submeshes over 65535 vertices so they fit too.
+        bool SplitForShortIndices{ false };
+        // Imports still running after this many seconds are cancelled and
+        // reported as failed; 0 disables the budget.
+        double TimeBudgetSeconds{ 0.0 };
+        ParseLimits Limits{};
+    };
+
+    // Converts many FBX files to .fbxbin concurrently. Files are imported and
+    // written on a shared worker pool that also runs ufbx's parse tasks, and the
+    // number of bundles held in memory is capped by MaxInFlight. Each output
+    // gets a CookManifest sidecar so unchanged sources are skipped next run.
+    // Long imports report progress while they run and can be cut off by a
+    // per-file time budget.
+    class BatchConverter final {
+    public:
+        explicit BatchConverter(BatchConvertOptions Options);
+        ~BatchConverter() = default;
+
+        BatchConverter(const BatchConverter& Other) = delete;
+        BatchConverter& operator=(const BatchConverter& Other) = delete;
+        BatchConverter(BatchConverter&& Other) = delete;
+        BatchConverter& operator=(BatchConverter&& Other) = delete;
+
+    public:
+        std::vector<ConvertResult> Run(std::span<const ConvertJob> Jobs, std::ostream& Log);
+
+        static std::filesystem::path MakeBinaryPath(const std::filesystem::path& FbxPath);
+        static std::vector<ConvertJob> LoadJobList(const std::filesystem::path& ListPath, std::ostream& Log);
+        static void PrintSummary(std::span<const ConvertResult> Results, double WallSeconds, std::ostream& Out);
+
+    private:
+        // Imports that run longer than a second log live throughput to Log.
+        ConvertResult ConvertOne(const ConvertJob& Job, std::ostream& Log, std::mutex& LogMutex);
+
+    private:
+        BatchConvertOptions mOptions{};
+        std::shared_ptr<ThreadPool> mThreadPool{};
+    };
+}
@@ -127,3 +127,25 @@ void VertexAttributes::Resize(std::size_t Count) {
         Set.resize(Count);
     }
 }
+
+VertexAttributeView::VertexAttributeView(const VertexAttributes& Attributes)
+    : Positions{ Attributes.Positions }
+    , Normals{ Attributes.Normals }
+    , TexCoords{}
+    , Colors{ Attributes.Colors }
+    , Tangents{ Attributes.Tangents }
+    , Bitangents{ Attributes.Bitangents }
+    , BoneIndices{ Attributes.BoneIndices }
+    , BoneWeights{ Attributes.BoneWeights } {
+    for (std::size_t Index{ 0 }; Index < TexCoords.size(); ++Index) {
+        TexCoords[Index] = Attributes.TexCoords[Index];
+    }
+}
+
+std::size_t VertexAttributeView::VertexCount() const {
+    return Positions.size();
+}
+
+bool VertexAttributeView::Empty() const {
+    return Positions.empty();
+}
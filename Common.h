@@ -44,6 +44,26 @@ namespace asset {
         void Resize(std::size_t Count);
     };
 
+    // Non-owning counterpart of VertexAttributes. Lets consumers take vertex
+    // streams straight out of a memory-mapped .fbxbin without copying them.
+    struct VertexAttributeView final {
+    public:
+        VertexAttributeView() = default;
+        explicit VertexAttributeView(const VertexAttributes& Attributes);
+
+        std::span<const Vec3> Positions{};
+        std::span<const Vec3> Normals{};
+        std::array<std::span<const Vec2>, 4> TexCoords{};
+        std::span<const Vec4> Colors{};
+        std::span<const Vec3> Tangents{};
+        std::span<const Vec3> Bitangents{};
+        std::span<const UVec4> BoneIndices{};
+        std::span<const Vec4> BoneWeights{};
+
+        std::size_t VertexCount() const;
+        bool Empty() const;
+    };
+
 
     enum class MaterialType : std::uint16_t {
         // FBX 
@@ -262,4 +282,27 @@ namespace asset {
     public:
         using std::runtime_error::runtime_error;
     };
+
+    enum class ImportStage : std::uint8_t {
+        Parse,
+        Meshes,
+    };
+
+    struct ImportProgress final {
+    public:
+        ImportStage Stage{ ImportStage::Parse };
+        // Parse: source bytes ufbx has consumed so far.
+        std::uint64_t BytesRead{ 0 };
+        std::uint64_t BytesTotal{ 0 };
+        // Meshes: extracted meshes and the polygon corners they held.
+        std::size_t MeshesDone{ 0 };
+        std::size_t MeshCount{ 0 };
+        std::uint64_t CornersDone{ 0 };
+        std::uint64_t CornerCount{ 0 };
+    };
+
+    // Called periodically during an import, never concurrently. Returning
+    // false cancels it and the import throws AssetError. Must not throw:
+    // parse progress is reported from inside ufbx.
+    using ImportProgressCallback = std::function<bool(const ImportProgress&)>;
 }
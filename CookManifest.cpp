@@ -0,0 +1,227 @@
+#include "CookManifest.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+using namespace asset;
+
+namespace {
+    namespace Fs = std::filesystem;
+
+    constexpr std::string_view ManifestMagic{ "FBXB-COOK" };
+    constexpr std::uint32_t ManifestVersion{ 1 };
+    constexpr std::size_t HashBlockSize{ 1u << 20 };
+
+    constexpr std::uint64_t Prime1{ 0x9E3779B185EBCA87ull };
+    constexpr std::uint64_t Prime2{ 0xC2B2AE3D27D4EB4Full };
+    constexpr std::uint64_t Prime3{ 0x165667B19E3779F9ull };
+    constexpr std::uint64_t Prime4{ 0x85EBCA77C2B2AE63ull };
+    constexpr std::uint64_t Prime5{ 0x27D4EB2F165667C5ull };
+
+    std::uint64_t RotateLeft(std::uint64_t Value, int Bits) {
+        return (Value << Bits) | (Value >> (64 - Bits));
+    }
+
+    std::uint64_t LoadU64(const unsigned char* Data) {
+        std::uint64_t Value{ 0 };
+        std::memcpy(&Value, Data, sizeof(Value));
+        return Value;
+    }
+
+    std::uint32_t LoadU32(const unsigned char* Data) {
+        std::uint32_t Value{ 0 };
+        std::memcpy(&Value, Data, sizeof(Value));
+        return Value;
+    }
+
+    std::uint64_t Round(std::uint64_t Accumulator, std::uint64_t Input) {
+        Accumulator += Input * Prime2;
+        Accumulator = RotateLeft(Accumulator, 31);
+        return Accumulator * Prime1;
+    }
+
+    std::uint64_t MergeRound(std::uint64_t Accumulator, std::uint64_t Value) {
+        Accumulator ^= Round(0, Value);
+        return Accumulator * Prime1 + Prime4;
+    }
+
+    // Streaming XXH64 (seed 0). Blocks are fed in multiples of 32 bytes except
+    // for the last one, so the 32-byte stripes never straddle a read.
+    class StreamingHash final {
+    public:
+        void Update(const unsigned char* Data, std::size_t Size) {
+            mTotal += Size;
+            std::size_t Offset{ 0 };
+            for (; Offset + 32 <= Size; Offset += 32) {
+                mLanes[0] = Round(mLanes[0], LoadU64(Data + Offset));
+                mLanes[1] = Round(mLanes[1], LoadU64(Data + Offset + 8));
+                mLanes[2] = Round(mLanes[2], LoadU64(Data + Offset + 16));
+                mLanes[3] = Round(mLanes[3], LoadU64(Data + Offset + 24));
+            }
+            mTail.assign(Data + Offset, Data + Size);
+        }
+
+        std::uint64_t Finish() const {
+            std::uint64_t Hash{ 0 };
+            if (mTotal >= 32) {
+                Hash = RotateLeft(mLanes[0], 1) + RotateLeft(mLanes[1], 7) + RotateLeft(mLanes[2], 12) + RotateLeft(mLanes[3], 18);
+                for (std::uint64_t Lane : mLanes) {
+                    Hash = MergeRound(Hash, Lane);
+                }
+            }
+            else {
+                Hash = Prime5;
+            }
+            Hash += mTotal;
+
+            const unsigned char* Data{ mTail.data() };
+            std::size_t Remaining{ mTail.size() };
+            for (; Remaining >= 8; Remaining -= 8, Data += 8) {
+                Hash ^= Round(0, LoadU64(Data));
+                Hash = RotateLeft(Hash, 27) * Prime1 + Prime4;
+            }
+            if (Remaining >= 4) {
+                Hash ^= static_cast<std::uint64_t>(LoadU32(Data)) * Prime1;
+                Hash = RotateLeft(Hash, 23) * Prime2 + Prime3;
+                Remaining -= 4;
+                Data += 4;
+            }
+            for (; Remaining > 0; --Remaining, ++Data) {
+                Hash ^= static_cast<std::uint64_t>(*Data) * Prime5;
+                Hash = RotateLeft(Hash, 11) * Prime1;
+            }
+
+            Hash ^= Hash >> 33;
+            Hash *= Prime2;
+            Hash ^= Hash >> 29;
+            Hash *= Prime3;
+            Hash ^= Hash >> 32;
+            return Hash;
+        }
+
+    private:
+        std::array<std::uint64_t, 4> mLanes{ Prime1 + Prime2, Prime2, 0, 0 - Prime1 };
+        std::uint64_t mTotal{ 0 };
+        std::vector<unsigned char> mTail{};
+    };
+}
+
+Fs::path CookManifest::PathFor(const Fs::path& OutputPath) {
+    Fs::path ManifestPath{ OutputPath };
+    ManifestPath += ".cook";
+    return ManifestPath;
+}
+
+std::optional<CookManifest> CookManifest::Load(const Fs::path& ManifestPath) {
+    std::ifstream Input{ ManifestPath };
+    if (!Input.is_open()) {
+        return std::nullopt;
+    }
+    std::string Magic{};
+    std::uint32_t Version{ 0 };
+    if (!(Input >> Magic >> Version) || Magic != ManifestMagic || Version != ManifestVersion) {
+        return std::nullopt;
+    }
+
+    CookManifest Manifest{};
+    std::string Line{};
+    std::size_t FieldCount{ 0 };
+    while (std::getline(Input, Line)) {
+        const std::size_t Split{ Line.find(' ') };
+        if (Split == std::string::npos) {
+            continue;
+        }
+        const std::string Key{ Line.substr(0, Split) };
+        std::istringstream Value{ Line.substr(Split + 1) };
+        if (Key == "importer") {
+            Value >> Manifest.ImporterVersion;
+        }
+        else if (Key == "format") {
+            Value >> Manifest.FormatVersion;
+        }
+        else if (Key == "options") {
+            Manifest.Options = Line.substr(Split + 1);
+        }
+        else if (Key == "source-size") {
+            Value >> Manifest.SourceSize;
+        }
+        else if (Key == "source-time") {
+            Value >> Manifest.SourceTime;
+        }
+        else if (Key == "source-hash") {
+            Value >> std::hex >> Manifest.SourceHash;
+        }
+        else if (Key == "output-size") {
+            Value >> Manifest.OutputSize;
+        }
+        else {
+            continue;
+        }
+        if (Value.fail()) {
+            return std::nullopt;
+        }
+        ++FieldCount;
+    }
+    if (FieldCount != 7) {
+        return std::nullopt;
+    }
+    return Manifest;
+}
+
+bool CookManifest::Save(const Fs::path& ManifestPath) const {
+    std::ofstream Output{ ManifestPath, std::ios::trunc };
+    if (!Output.is_open()) {
+        return false;
+    }
+    Output << ManifestMagic << " " << ManifestVersion << "\n";
+    Output << "importer " << ImporterVersion << "\n";
+    Output << "format " << FormatVersion << "\n";
+    Output << "options " << Options << "\n";
+    Output << "source-size " << SourceSize << "\n";
+    Output << "source-time " << SourceTime << "\n";
+    Output << "source-hash " << std::hex << SourceHash << std::dec << "\n";
+    Output << "output-size " << OutputSize << "\n";
+    Output.flush();
+    return static_cast<bool>(Output);
+}
+
+std::optional<std::uint64_t> CookManifest::HashFile(const Fs::path& Path) {
+    std::ifstream Input{ Path, std::ios::binary };
+    if (!Input.is_open()) {
+        return std::nullopt;
+    }
+    std::vector<unsigned char> Block{};
+    Block.resize(HashBlockSize);
+    StreamingHash Hash{};
+    while (Input) {
+        Input.read(reinterpret_cast<char*>(Block.data()), static_cast<std::streamsize>(Block.size()));
+        const std::size_t ReadCount{ static_cast<std::size_t>(Input.gcount()) };
+        if (ReadCount == 0) {
+            break;
+        }
+        // Full blocks are a multiple of 32 bytes, so only the final short read
+        // leaves a tail behind.
+        Hash.Update(Block.data(), ReadCount);
+    }
+    if (Input.bad()) {
+        return std::nullopt;
+    }
+    return Hash.Finish();
+}
+
+std::optional<std::int64_t> CookManifest::FileTime(const Fs::path& Path) {
+    std::error_code Error{};
+    const Fs::file_time_type Time{ Fs::last_write_time(Path, Error) };
+    if (Error) {
+        return std::nullopt;
+    }
+    return static_cast<std::int64_t>(Time.time_since_epoch().count());
+}
+
+bool CookManifest::SameSettings(const CookManifest& Other) const {
+    return ImporterVersion == Other.ImporterVersion && FormatVersion == Other.FormatVersion && Options == Other.Options;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace asset {
+    // Sidecar written next to every cooked .fbxbin ("<output>.cook"). It records
+    // what the output was built from so unchanged sources can be skipped: a
+    // matching size + mtime is trusted as-is, otherwise the content hash decides.
+    struct CookManifest final {
+    public:
+        std::uint32_t ImporterVersion{ 0 };
+        std::uint32_t FormatVersion{ 0 };
+        std::string Options{};
+        std::uintmax_t SourceSize{ 0 };
+        std::int64_t SourceTime{ 0 };
+        std::uint64_t SourceHash{ 0 };
+        std::uintmax_t OutputSize{ 0 };
+
+    public:
+        static std::filesystem::path PathFor(const std::filesystem::path& OutputPath);
+        static std::optional<CookManifest> Load(const std::filesystem::path& ManifestPath);
+        bool Save(const std::filesystem::path& ManifestPath) const;
+
+        // XXH64 of the whole file, read in large blocks.
+        static std::optional<std::uint64_t> HashFile(const std::filesystem::path& Path);
+        static std::optional<std::int64_t> FileTime(const std::filesystem::path& Path);
+
+        // True when both manifests describe the same importer, format and
+        // options; the source itself is compared separately.
+        bool SameSettings(const CookManifest& Other) const;
+    };
+}
@@ -1,8 +1,9 @@
 #include "FbxAssetImporter.h"
 
+#include <utility>
+
 #include "MaterialVisitor.h"
 #include "MeshHierarchyBuilder.h"
-#include "UfbxAssetLoader.h"
 
 using namespace asset;
 
@@ -11,12 +12,132 @@ FbxAssetImporter::FbxAssetImporter(GraphicsAPI Api)
 }
 
 AssetBundle FbxAssetImporter::LoadFromFile(std::string_view FilePath) {
-    UfbxAssetLoader Loader{ mApi };
+    ThreadPool* Pool{ AcquireThreadPool() };
+    UfbxAssetLoader Loader{ mApi, Pool };
+    Loader.SetProfile(mProfile);
+    Loader.SetLimits(mParseLimits);
+    Loader.SetProgressCallback(&mProgress);
     MaterialVisitor MaterialCollector{};
     AssetBundle Bundle{};
-    MeshHierarchyBuilder Builder{ Bundle.GetModelResult(), &MaterialCollector.GetMaterialLookup() };
-    ISceneNodeVisitor* Visitors[]{ &MaterialCollector, &Builder };
-    Loader.LoadAndTraverse(FilePath, { Visitors });
-    Bundle.GetMaterials() = MaterialCollector.GetMaterials();
+    MeshHierarchyBuilder Builder{ Bundle.GetModelResult(), &MaterialCollector.GetMaterialIndices(), Pool };
+    Builder.SetProgressCallback(&mProgress);
+    Builder.SetOptimizeMeshes(mOptimizeMeshes);
+    Builder.SetBuildMeshlets(mBuildMeshlets);
+    Builder.SetBuildLods(mBuildLods);
+    Builder.SetSplitForShortIndices(mSplitForShortIndices);
+    if (mProfile == ImportProfile::HierarchyOnly) {
+        Builder.SetExtractMeshes(false);
+        ISceneNodeVisitor* Visitors[]{ &Builder };
+        Loader.LoadAndTraverse(FilePath, { Visitors });
+    }
+    else {
+        ISceneNodeVisitor* Visitors[]{ &MaterialCollector, &Builder };
+        Loader.LoadAndTraverse(FilePath, { Visitors });
+        Bundle.GetMaterials() = MaterialCollector.GetMaterials();
+    }
+    mScratchStats = Builder.GetScratchStats();
+    mParseStats = Loader.GetStats();
+    mCacheReports = Builder.GetVertexCacheReports();
     return Bundle;
 }
+
+void FbxAssetImporter::SetWorkerCount(std::size_t WorkerCount) {
+    if (WorkerCount != mWorkerCount) {
+        mThreadPool.reset();
+    }
+    mWorkerCount = WorkerCount;
+}
+
+const ScratchArenaStats& FbxAssetImporter::GetScratchStats() const {
+    return mScratchStats;
+}
+
+void FbxAssetImporter::SetProfile(ImportProfile Profile) {
+    mProfile = Profile;
+}
+
+ImportProfile FbxAssetImporter::GetProfile() const {
+    return mProfile;
+}
+
+void FbxAssetImporter::SetOptimizeMeshes(bool Enabled) {
+    mOptimizeMeshes = Enabled;
+}
+
+bool FbxAssetImporter::GetOptimizeMeshes() const {
+    return mOptimizeMeshes;
+}
+
+const std::vector<VertexCacheReport>& FbxAssetImporter::GetVertexCacheReports() const {
+    return mCacheReports;
+}
+
+void FbxAssetImporter::SetBuildMeshlets(bool Enabled) {
+    mBuildMeshlets = Enabled;
+}
+
+bool FbxAssetImporter::GetBuildMeshlets() const {
+    return mBuildMeshlets;
+}
+
+void FbxAssetImporter::SetBuildLods(bool Enabled) {
+    mBuildLods = Enabled;
+}
+
+bool FbxAssetImporter::GetBuildLods() const {
+    return mBuildLods;
+}
+
+void FbxAssetImporter::SetSplitForShortIndices(bool Enabled) {
+    mSplitForShortIndices = Enabled;
+}
+
+bool FbxAssetImporter::GetSplitForShortIndices() const {
+    return mSplitForShortIndices;
+}
+
+void FbxAssetImporter::SetProgressCallback(ImportProgressCallback Callback) {
+    mProgress = std::move(Callback);
+}
+
+void FbxAssetImporter::SetParseLimits(const ParseLimits& Limits) {
+    mParseLimits = Limits;
+}
+
+const ParseStats& FbxAssetImporter::GetParseStats() const {
+    return mParseStats;
+}
+
+std::size_t FbxAssetImporter::GetWorkerCount() const {
+    if (mThreadPool != nullptr) {
+        return mThreadPool->GetWorkerCount();
+    }
+    if (mWorkerCount == 0) {
+        return ThreadPool::DefaultWorkerCount();
+    }
+    return mWorkerCount;
+}
+
+void FbxAssetImporter::SetThreadPool(std::shared_ptr<ThreadPool> Pool) {
+    mThreadPool = std::move(Pool);
+    mWorkerCount = (mThreadPool != nullptr) ? mThreadPool->GetWorkerCount() : 0;
+}
+
+std::string FbxAssetImporter::DescribeOptions() const {
+    return std::string{ "api=" } + ((mApi == GraphicsAPI::DirectX) ? "directx" : "opengl")
+        + " profile=" + std::string{ ImportProfileName(mProfile) }
+        + " optimize=" + (mOptimizeMeshes ? "1" : "0")
+        + " meshlets=" + (mBuildMeshlets ? "1" : "0")
+        + " lods=" + (mBuildLods ? "1" : "0")
+        + " split16=" + (mSplitForShortIndices ? "1" : "0");
+}
+
+ThreadPool* FbxAssetImporter::AcquireThreadPool() {
+    if (GetWorkerCount() <= 1) {
+        return nullptr;
+    }
+    if (mThreadPool == nullptr) {
+        mThreadPool = std::make_shared<ThreadPool>(GetWorkerCount());
+    }
+    return mThreadPool.get();
+}
@@ -1,9 +1,18 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "AssetBundle.h"
 #include "Common.h"
+#include "MeshOptimizer.h"
+#include "ScratchArena.h"
+#include "ThreadPool.h"
+#include "UfbxAssetLoader.h"
 
 namespace asset {
     class FbxAssetImporter final {
@@ -16,10 +25,83 @@ namespace asset {
         FbxAssetImporter(FbxAssetImporter&& Other) noexcept = default;
         FbxAssetImporter& operator=(FbxAssetImporter&& Other) noexcept = default;
 
+    public:
+        // Bumped whenever a change to the import path alters the cooked output
+        // for the same source and options.
+        static constexpr std::uint32_t CookVersion{ 3 };
+
     public:
         AssetBundle LoadFromFile(std::string_view FilePath);
 
+        // 0 uses every hardware thread, 1 keeps parsing on the calling thread.
+        void SetWorkerCount(std::size_t WorkerCount);
+        std::size_t GetWorkerCount() const;
+
+        // Shares an existing pool (e.g. a batch converter's) instead of owning one.
+        void SetThreadPool(std::shared_ptr<ThreadPool> Pool);
+
+        // Temporary allocations of the last LoadFromFile: requests served by
+        // the per-mesh scratch arenas against the system blocks behind them.
+        const ScratchArenaStats& GetScratchStats() const;
+
+        // Full by default. GeometryOnly cooks the same output with less
+        // parsing; HierarchyOnly produces nodes without meshes or materials.
+        void SetProfile(ImportProfile Profile);
+        ImportProfile GetProfile() const;
+
+        // Optional cook stage that reorders each SubMesh's triangles for the
+        // post-transform cache and then vertices for fetch locality.
+        void SetOptimizeMeshes(bool Enabled);
+        bool GetOptimizeMeshes() const;
+        // ACMR/ATVR before and after for every mesh of the last LoadFromFile;
+        // empty unless mesh optimisation is on.
+        const std::vector<VertexCacheReport>& GetVertexCacheReports() const;
+
+        // Optional cook stage that splits each SubMesh into meshlets with
+        // bounding spheres and normal cones; see BuildMeshlets.
+        void SetBuildMeshlets(bool Enabled);
+        bool GetBuildMeshlets() const;
+
+        // Optional cook stage that appends quadric-simplified LOD levels of
+        // each SubMesh with their error; see SimplifyMesh.
+        void SetBuildLods(bool Enabled);
+        bool GetBuildLods() const;
+
+        // Optional cook stage that splits meshes too large for 16-bit
+        // indices into SubMeshes that fit; see SplitForShortIndices.
+        void SetSplitForShortIndices(bool Enabled);
+        bool GetSplitForShortIndices() const;
+
+        // Reports parse and mesh extraction progress of LoadFromFile and can
+        // cancel it; an empty callback turns reporting off.
+        void SetProgressCallback(ImportProgressCallback Callback);
+
+        // Failing a file on a limit never changes what a successful cook
+        // writes, so limits are not part of DescribeOptions.
+        void SetParseLimits(const ParseLimits& Limits);
+        // ufbx parse of the last LoadFromFile: time, arena sizes and peak RSS.
+        const ParseStats& GetParseStats() const;
+
+        // Stable text form of every option that affects the cooked output.
+        // Worker counts are deliberately left out.
+        std::string DescribeOptions() const;
+
+    private:
+        ThreadPool* AcquireThreadPool();
+
     private:
         GraphicsAPI mApi{ GraphicsAPI::DirectX };
+        std::size_t mWorkerCount{ 0 };
+        ImportProfile mProfile{ ImportProfile::Full };
+        bool mOptimizeMeshes{ false };
+        bool mBuildMeshlets{ false };
+        bool mBuildLods{ false };
+        bool mSplitForShortIndices{ false };
+        std::vector<VertexCacheReport> mCacheReports{};
+        std::shared_ptr<ThreadPool> mThreadPool{};
+        ScratchArenaStats mScratchStats{};
+        ImportProgressCallback mProgress{};
+        ParseLimits mParseLimits{};
+        ParseStats mParseStats{};
     };
 }
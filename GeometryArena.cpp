@@ -0,0 +1,276 @@
+#include "GeometryArena.h"
+
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+namespace {
+    // Matches aInstanceModel in shaders/lit.vert.
+    constexpr GLuint InstanceAttributeIndex{ 11 };
+    // Pools stop growing here so counts stay clear of OffsetAllocator's limit.
+    constexpr std::uint32_t MaxCapacity{ 1u << 30 };
+    // Index space is counted in words so 32-bit ranges stay aligned.
+    constexpr std::size_t IndexWordSize{ sizeof(std::uint32_t) };
+
+    struct AttributeFormat final {
+    public:
+        GLint ComponentCount{ 0 };
+        GLenum Type{ GL_FLOAT };
+        bool Normalized{ false };
+        bool IsInteger{ false };
+    };
+
+    // How a stored element format is read by glVertexAttrib(I)Pointer.
+    std::optional<AttributeFormat> ToAttributeFormat(asset::BinaryElementFormat Format) {
+        switch (Format) {
+        case asset::BinaryElementFormat::Float2:
+            return AttributeFormat{ 2, GL_FLOAT, false, false };
+        case asset::BinaryElementFormat::Float3:
+            return AttributeFormat{ 3, GL_FLOAT, false, false };
+        case asset::BinaryElementFormat::Float4:
+            return AttributeFormat{ 4, GL_FLOAT, false, false };
+        case asset::BinaryElementFormat::Uint4:
+            return AttributeFormat{ 4, GL_UNSIGNED_INT, false, true };
+        case asset::BinaryElementFormat::OctSnorm16:
+            return AttributeFormat{ 2, GL_SHORT, true, false };
+        case asset::BinaryElementFormat::Half2:
+            return AttributeFormat{ 2, GL_HALF_FLOAT, false, false };
+        case asset::BinaryElementFormat::Unorm16x2:
+            return AttributeFormat{ 2, GL_UNSIGNED_SHORT, true, false };
+        case asset::BinaryElementFormat::Unorm8x4:
+            return AttributeFormat{ 4, GL_UNSIGNED_BYTE, true, false };
+        case asset::BinaryElementFormat::Uint8x4:
+            return AttributeFormat{ 4, GL_UNSIGNED_BYTE, false, true };
+        default:
+            return std::nullopt;
+        }
+    }
+
+    GLuint CreateBuffer(GLenum Target, std::size_t Bytes) {
+        GLuint Buffer{ 0 };
+        glGenBuffers(1, &Buffer);
+        glBindBuffer(Target, Buffer);
+        glBufferData(Target, static_cast<GLsizeiptr>(Bytes), nullptr, GL_DYNAMIC_DRAW);
+        return Buffer;
+    }
+
+    // Allocates Count from Space, doubling Space until it fits. Growing
+    // appends to the free range at the end, so this also gets past the bin
+    // rounding. Invalid once Space would pass MaxCapacity.
+    asset::OffsetAllocator::Allocation AllocateGrowing(asset::OffsetAllocator& Space, std::uint32_t Count) {
+        asset::OffsetAllocator::Allocation Result{ Space.Allocate(Count) };
+        while (!Result.Valid() && Space.Size() < MaxCapacity) {
+            Space.Grow(std::min(MaxCapacity, std::max(Space.Size() * 2, Count)));
+            Result = Space.Allocate(Count);
+        }
+        return Result;
+    }
+
+    void WriteBuffer(GLuint Buffer, std::size_t Offset, std::span<const std::byte> Bytes) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, Buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(Offset), static_cast<GLsizeiptr>(Bytes.size()), Bytes.data());
+    }
+}
+
+namespace asset {
+    bool IsVertexAttributeFormat(BinaryElementFormat Format) {
+        return ToAttributeFormat(Format).has_value();
+    }
+
+    void SetupVertexAttributes(const VertexLayout& Layout) {
+        const GLsizei Stride{ static_cast<GLsizei>(Layout.Stride) };
+        for (const VertexLayoutAttribute& Attribute : Layout.Attributes) {
+            const GLuint AttributeIndex{ static_cast<GLuint>(Attribute.Stream) };
+            const AttributeFormat Format{ ToAttributeFormat(Attribute.Format).value() };
+            const void* Offset{ reinterpret_cast<const void*>(static_cast<std::size_t>(Attribute.Offset)) };
+            glEnableVertexAttribArray(AttributeIndex);
+            if (Format.IsInteger) {
+                glVertexAttribIPointer(AttributeIndex, Format.ComponentCount, Format.Type, Stride, Offset);
+                continue;
+            }
+            glVertexAttribPointer(AttributeIndex, Format.ComponentCount, Format.Type, Format.Normalized ? GL_TRUE : GL_FALSE, Stride, Offset);
+        }
+    }
+
+    bool GeometrySlice::Valid() const {
+        return Vertices.Valid() && Indices.Valid();
+    }
+
+    GeometryArena::~GeometryArena() {
+        for (Pool& Entry : mPools) {
+            glDeleteBuffers(1, &Entry.VertexBuffer);
+            glDeleteBuffers(1, &Entry.IndexBuffer);
+            glDeleteVertexArrays(1, &Entry.Vao);
+        }
+    }
+
+    std::optional<GeometrySlice> GeometryArena::Allocate(const VertexLayout& Layout, std::span<const std::byte> Vertices, std::span<const std::byte> Indices) {
+        if (Layout.Stride == 0 || Vertices.empty() || Indices.empty()) {
+            return std::nullopt;
+        }
+        const std::size_t VertexCount{ Vertices.size() / Layout.Stride };
+        const std::size_t IndexWords{ (Indices.size() + IndexWordSize - 1) / IndexWordSize };
+        if (VertexCount > MaxCapacity || IndexWords > MaxCapacity) {
+            return std::nullopt;
+        }
+
+        const std::size_t PoolIndex{ AcquirePool(Layout) };
+        Pool& Target{ mPools[PoolIndex] };
+        const std::uint32_t VertexCapacity{ Target.VertexSpace.Size() };
+        const std::uint32_t IndexCapacity{ Target.IndexSpace.Size() };
+        GeometrySlice Slice{};
+        Slice.Pool = PoolIndex;
+        Slice.Vertices = AllocateGrowing(Target.VertexSpace, static_cast<std::uint32_t>(VertexCount));
+        Slice.Indices = AllocateGrowing(Target.IndexSpace, static_cast<std::uint32_t>(IndexWords));
+        // The buffers follow the allocators even when the slice failed, so
+        // the two never disagree about the pool's capacity.
+        GrowBuffers(Target, VertexCapacity, IndexCapacity);
+        if (!Slice.Valid()) {
+            Target.VertexSpace.Free(Slice.Vertices);
+            Target.IndexSpace.Free(Slice.Indices);
+            return std::nullopt;
+        }
+        Slice.BaseVertex = Slice.Vertices.Offset;
+        Slice.IndexByteOffset = static_cast<std::size_t>(Slice.Indices.Offset) * IndexWordSize;
+        ++Target.SliceCount;
+
+        WriteBuffer(Target.VertexBuffer, Slice.BaseVertex * Layout.Stride, Vertices);
+        WriteBuffer(Target.IndexBuffer, Slice.IndexByteOffset, Indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return Slice;
+    }
+
+    void GeometryArena::Free(const GeometrySlice& Slice) {
+        if (!Slice.Valid() || Slice.Pool >= mPools.size()) {
+            return;
+        }
+        Pool& Target{ mPools[Slice.Pool] };
+        Target.VertexSpace.Free(Slice.Vertices);
+        Target.IndexSpace.Free(Slice.Indices);
+        --Target.SliceCount;
+    }
+
+    void GeometryArena::BindForDraw(std::size_t PoolIndex, GLuint InstanceBuffer, std::size_t FirstInstance) {
+        Pool& Target{ mPools[PoolIndex] };
+        if (mBoundPool != PoolIndex) {
+            glBindVertexArray(Target.Vao);
+            mBoundPool = PoolIndex;
+        }
+        if (Target.InstancesBound && Target.InstanceBuffer == InstanceBuffer && Target.FirstInstance == FirstInstance) {
+            return;
+        }
+        // GL 3.3 has no base instance, so the instance attributes are
+        // pointed at FirstInstance instead.
+        if (InstanceBuffer == 0) {
+            for (GLuint Column{ 0 }; Column < 4; ++Column) {
+                glDisableVertexAttribArray(InstanceAttributeIndex + Column);
+            }
+        }
+        else {
+            glBindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+            for (GLuint Column{ 0 }; Column < 4; ++Column) {
+                const GLuint AttributeIndex{ InstanceAttributeIndex + Column };
+                const std::size_t OffsetBytes{ FirstInstance * sizeof(glm::mat4) + Column * sizeof(glm::vec4) };
+                glEnableVertexAttribArray(AttributeIndex);
+                glVertexAttribPointer(AttributeIndex, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<const void*>(OffsetBytes));
+            }
+        }
+        Target.InstanceBuffer = InstanceBuffer;
+        Target.FirstInstance = FirstInstance;
+        Target.InstancesBound = true;
+    }
+
+    void GeometryArena::EndDraws() {
+        if (mBoundPool.has_value()) {
+            glBindVertexArray(0);
+            mBoundPool.reset();
+        }
+        // Instance buffers may be deleted or replaced before the next frame.
+        for (Pool& Entry : mPools) {
+            Entry.InstancesBound = false;
+        }
+    }
+
+    GeometryArenaStats GeometryArena::GetStats() const {
+        GeometryArenaStats Stats{};
+        Stats.PoolCount = mPools.size();
+        for (const Pool& Entry : mPools) {
+            const std::size_t Stride{ Entry.Layout.Stride };
+            Stats.SliceCount += Entry.SliceCount;
+            Stats.VertexBytesUsed += static_cast<std::size_t>(Entry.VertexSpace.Size() - Entry.VertexSpace.FreeSize()) * Stride;
+            Stats.VertexBytesReserved += static_cast<std::size_t>(Entry.VertexSpace.Size()) * Stride;
+            Stats.IndexBytesUsed += static_cast<std::size_t>(Entry.IndexSpace.Size() - Entry.IndexSpace.FreeSize()) * IndexWordSize;
+            Stats.IndexBytesReserved += static_cast<std::size_t>(Entry.IndexSpace.Size()) * IndexWordSize;
+        }
+        return Stats;
+    }
+
+    std::size_t GeometryArena::AcquirePool(const VertexLayout& Layout) {
+        const auto Found{ std::find_if(mPools.begin(), mPools.end(), [&](const Pool& Entry) { return Entry.Layout == Layout; }) };
+        if (Found != mPools.end()) {
+            return static_cast<std::size_t>(Found - mPools.begin());
+        }
+
+        Pool Created{};
+        Created.Layout = Layout;
+        Created.VertexSpace = OffsetAllocator{ InitialVertexCapacity };
+        Created.IndexSpace = OffsetAllocator{ InitialIndexBytes / static_cast<std::uint32_t>(IndexWordSize) };
+
+        glGenVertexArrays(1, &Created.Vao);
+        glBindVertexArray(Created.Vao);
+        Created.VertexBuffer = CreateBuffer(GL_ARRAY_BUFFER, static_cast<std::size_t>(InitialVertexCapacity) * Layout.Stride);
+        SetupVertexAttributes(Layout);
+        Created.IndexBuffer = CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, InitialIndexBytes);
+        for (GLuint Column{ 0 }; Column < 4; ++Column) {
+            glVertexAttribDivisor(InstanceAttributeIndex + Column, 1);
+        }
+        glBindVertexArray(0);
+        mBoundPool.reset();
+
+        mPools.push_back(std::move(Created));
+        return mPools.size() - 1;
+    }
+
+    GLuint GeometryArena::GrowBuffer(GLuint Buffer, std::size_t OldBytes, std::size_t NewBytes) {
+        const GLuint Grown{ CreateBuffer(GL_COPY_WRITE_BUFFER, NewBytes) };
+        glBindBuffer(GL_COPY_READ_BUFFER, Buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(OldBytes));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return Grown;
+    }
+
+    void GeometryArena::GrowBuffers(Pool& Target, std::uint32_t VertexCapacity, std::uint32_t IndexCapacity) {
+        const bool GrowVertices{ Target.VertexSpace.Size() != VertexCapacity };
+        const bool GrowIndices{ Target.IndexSpace.Size() != IndexCapacity };
+        if (!GrowVertices && !GrowIndices) {
+            return;
+        }
+
+        const std::size_t Stride{ Target.Layout.Stride };
+        const GLuint OldVertexBuffer{ Target.VertexBuffer };
+        const GLuint OldIndexBuffer{ Target.IndexBuffer };
+        if (GrowVertices) {
+            Target.VertexBuffer = GrowBuffer(OldVertexBuffer, VertexCapacity * Stride, Target.VertexSpace.Size() * Stride);
+        }
+        if (GrowIndices) {
+            Target.IndexBuffer = GrowBuffer(OldIndexBuffer, IndexCapacity * IndexWordSize, Target.IndexSpace.Size() * IndexWordSize);
+        }
+
+        // The VAO still points at the old buffers until re-pointed here.
+        glBindVertexArray(Target.Vao);
+        glBindBuffer(GL_ARRAY_BUFFER, Target.VertexBuffer);
+        SetupVertexAttributes(Target.Layout);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Target.IndexBuffer);
+        glBindVertexArray(0);
+        mBoundPool.reset();
+        Target.InstancesBound = false;
+
+        if (GrowVertices) {
+            glDeleteBuffers(1, &OldVertexBuffer);
+        }
+        if (GrowIndices) {
+            glDeleteBuffers(1, &OldIndexBuffer);
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "OffsetAllocator.h"
+#include "VertexLayout.h"
+
+namespace asset {
+    // Whether a stored element format can be fed to a vertex attribute.
+    bool IsVertexAttributeFormat(BinaryElementFormat Format);
+    // Points the attributes of the bound VAO at the bound GL_ARRAY_BUFFER,
+    // laid out as Layout; locations follow BinaryStream order, see
+    // shaders/lit.vert.
+    void SetupVertexAttributes(const VertexLayout& Layout);
+
+    // Where one mesh lives inside a GeometryArena. Indices are relative to
+    // BaseVertex and start IndexByteOffset bytes into the pool's index
+    // buffer.
+    struct GeometrySlice final {
+    public:
+        std::size_t Pool{ 0 };
+        OffsetAllocator::Allocation Vertices{};
+        OffsetAllocator::Allocation Indices{};
+        std::size_t BaseVertex{ 0 };
+        std::size_t IndexByteOffset{ 0 };
+
+        bool Valid() const;
+    };
+
+    struct GeometryArenaStats final {
+    public:
+        std::size_t PoolCount{ 0 };
+        std::size_t SliceCount{ 0 };
+        std::size_t VertexBytesUsed{ 0 };
+        std::size_t VertexBytesReserved{ 0 };
+        std::size_t IndexBytesUsed{ 0 };
+        std::size_t IndexBytesReserved{ 0 };
+    };
+
+    // Scene-wide vertex and index storage. Meshes with the same VertexLayout
+    // share a pool: one interleaved vertex buffer, one index buffer holding
+    // 16- and 32-bit ranges alike, and one VAO, so drawing many meshes needs
+    // no VAO switch and every draw picks its mesh with a base vertex and an
+    // index offset. Space is sub-allocated with OffsetAllocator and returned
+    // by Free; a full pool doubles its buffers and copies them on the GPU.
+    class GeometryArena final {
+    public:
+        // First capacity of a pool, in vertices and in index bytes.
+        static constexpr std::uint32_t InitialVertexCapacity{ 1u << 16 };
+        static constexpr std::uint32_t InitialIndexBytes{ 1u << 20 };
+
+    public:
+        GeometryArena() = default;
+        ~GeometryArena();
+
+        GeometryArena(const GeometryArena& Other) = delete;
+        GeometryArena& operator=(const GeometryArena& Other) = delete;
+        GeometryArena(GeometryArena&& Other) = delete;
+        GeometryArena& operator=(GeometryArena&& Other) = delete;
+
+    public:
+        // Copies interleaved Vertices in Layout and the raw index bytes into
+        // the pool for Layout. Empty when the buffers cannot grow any further.
+        std::optional<GeometrySlice> Allocate(const VertexLayout& Layout, std::span<const std::byte> Vertices, std::span<const std::byte> Indices);
+        void Free(const GeometrySlice& Slice);
+
+        // Binds the pool's VAO with the instance attributes (11-14) pointing
+        // at FirstInstance of InstanceBuffer, or disabled when it is 0,
+        // skipping whatever is already bound. Binding any other VAO before
+        // EndDraws leaves the cached state stale.
+        void BindForDraw(std::size_t PoolIndex, GLuint InstanceBuffer, std::size_t FirstInstance);
+        // Unbinds the VAO and forgets the cached bindings.
+        void EndDraws();
+
+        GeometryArenaStats GetStats() const;
+
+    private:
+        struct Pool final {
+        public:
+            VertexLayout Layout{};
+            GLuint Vao{ 0 };
+            GLuint VertexBuffer{ 0 };
+            GLuint IndexBuffer{ 0 };
+            // In vertices and in 4-byte index words, so every range starts
+            // aligned for either index type.
+            OffsetAllocator VertexSpace{};
+            OffsetAllocator IndexSpace{};
+            std::size_t SliceCount{ 0 };
+            // What the instance attributes point at since the last EndDraws.
+            GLuint InstanceBuffer{ 0 };
+            std::size_t FirstInstance{ 0 };
+            bool InstancesBound{ false };
+        };
+
+    private:
+        std::size_t AcquirePool(const VertexLayout& Layout);
+        // A new buffer of NewBytes holding the first OldBytes of Buffer.
+        static GLuint GrowBuffer(GLuint Buffer, std::size_t OldBytes, std::size_t NewBytes);
+        // Enlarges the pool's buffers from the given capacities to those of
+        // its allocators, keeping their contents, and re-points the VAO.
+        void GrowBuffers(Pool& Target, std::uint32_t VertexCapacity, std::uint32_t IndexCapacity);
+
+    private:
+        std::vector<Pool> mPools{};
+        std::optional<std::size_t> mBoundPool{};
+    };
+}
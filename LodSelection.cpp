@@ -0,0 +1,83 @@
+#include "LodSelection.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ViewerMath.h"
+
+namespace {
+    // Keeps the projected error finite when the camera is inside the bounds.
+    constexpr float MinLodDistance{ 1.0e-4f };
+}
+
+namespace asset {
+    std::vector<LodLevel> BuildLodLevels(const ModelMesh& Mesh) {
+        std::vector<LodLevel> Levels{};
+        const std::vector<ModelMesh::Lod>& Lods{ Mesh.Lods() };
+        if (Lods.empty()) {
+            return Levels;
+        }
+        const std::vector<ModelMesh::SubMesh>& SubMeshes{ Mesh.GetSubMeshes() };
+        std::size_t LevelCount{ 1 };
+        for (const ModelMesh::Lod& Lod : Lods) {
+            LevelCount = std::max(LevelCount, Lod.Level + 1);
+        }
+        Levels.resize(LevelCount);
+        for (LodLevel& Level : Levels) {
+            Level.Ranges = SubMeshes;
+        }
+        // Lods are sorted by SubMeshIndex then Level, so a level overwrites
+        // its range in every level from its own up.
+        for (const ModelMesh::Lod& Lod : Lods) {
+            for (std::size_t Level{ Lod.Level }; Level < LevelCount; ++Level) {
+                ModelMesh::SubMesh& Range{ Levels[Level].Ranges[Lod.SubMeshIndex] };
+                Range.IndexOffset = Lod.IndexOffset;
+                Range.IndexCount = Lod.IndexCount;
+                Levels[Level].Error = std::max(Levels[Level].Error, Lod.Error);
+            }
+        }
+        for (LodLevel& Level : Levels) {
+            for (const ModelMesh::SubMesh& Range : Level.Ranges) {
+                Level.TriangleCount += Range.IndexCount / 3;
+            }
+        }
+        return Levels;
+    }
+
+    void LodSelector::Begin(const glm::vec3& CameraPosition, float FovYRadians, float ViewportHeight) {
+        mCameraPosition = CameraPosition;
+        mPixelsPerUnit = ViewportHeight / (2.0f * std::tan(FovYRadians * 0.5f));
+        mStats = LodStats{};
+    }
+
+    void LodSelector::SetPixelThreshold(float Pixels) {
+        mPixelThreshold = Pixels;
+    }
+
+    std::size_t LodSelector::Select(const std::vector<LodLevel>& Levels, const glm::mat4& World, const glm::vec3& BoundsCenter, float BoundsRadius) {
+        if (Levels.empty()) {
+            return 0;
+        }
+        const float Scale{ MaxAxisScale(World) };
+        const glm::vec3 Center{ World * glm::vec4{ BoundsCenter, 1.0f } };
+        const float Distance{ std::max(glm::length(Center - mCameraPosition) - BoundsRadius * Scale, MinLodDistance) };
+        const float PixelsPerError{ Scale * mPixelsPerUnit / Distance };
+        // Errors grow with the level, so the first level over the threshold
+        // ends the search.
+        std::size_t Selected{ 0 };
+        while (Selected + 1 < Levels.size() && Levels[Selected + 1].Error * PixelsPerError <= mPixelThreshold) {
+            ++Selected;
+        }
+        if (mStats.InstancesPerLevel.size() < Levels.size()) {
+            mStats.InstancesPerLevel.resize(Levels.size(), 0);
+        }
+        ++mStats.InstancesPerLevel[Selected];
+        mStats.FullTriangles += Levels.front().TriangleCount;
+        mStats.SubmittedTriangles += Levels[Selected].TriangleCount;
+        return Selected;
+    }
+
+    const LodStats& LodSelector::GetStats() const {
+        return mStats;
+    }
+}
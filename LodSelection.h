@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ModelResult.h"
+
+namespace asset {
+    // What one LOD level of a mesh draws: a range per SubMesh, with the
+    // SubMesh's material. Submeshes with fewer levels repeat their last one.
+    // Error is the largest of the ranges, 0 for level 0.
+    struct LodLevel final {
+    public:
+        float Error{ 0.0f };
+        std::size_t TriangleCount{ 0 };
+        std::vector<ModelMesh::SubMesh> Ranges{};
+    };
+
+    // Level 0 (the submeshes) followed by every cooked level; empty when the
+    // mesh has no LODs.
+    std::vector<LodLevel> BuildLodLevels(const ModelMesh& Mesh);
+
+    // Triangles over every Select call since the last Begin.
+    struct LodStats final {
+    public:
+        std::vector<std::size_t> InstancesPerLevel{};
+        std::size_t FullTriangles{ 0 };
+        std::size_t SubmittedTriangles{ 0 };
+    };
+
+    // Picks the coarsest level whose error, projected at the nearest point
+    // of an instance's bounding sphere, stays under a pixel threshold.
+    class LodSelector final {
+    public:
+        // Errors above this many pixels are considered visible.
+        static constexpr float DefaultPixelThreshold{ 1.0f };
+
+    public:
+        // Starts a frame and clears the stats.
+        void Begin(const glm::vec3& CameraPosition, float FovYRadians, float ViewportHeight);
+        void SetPixelThreshold(float Pixels);
+
+        std::size_t Select(const std::vector<LodLevel>& Levels, const glm::mat4& World, const glm::vec3& BoundsCenter, float BoundsRadius);
+
+        const LodStats& GetStats() const;
+
+    private:
+        glm::vec3 mCameraPosition{ 0.0f };
+        // Pixels per unit of object-space error at distance 1.
+        float mPixelsPerUnit{ 0.0f };
+        float mPixelThreshold{ DefaultPixelThreshold };
+        LodStats mStats{};
+    };
+}
@@ -0,0 +1,195 @@
+#include "LzCodec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace asset;
+
+namespace {
+    constexpr std::size_t MinMatch{ 4 };
+    constexpr std::size_t LastLiterals{ 5 };
+    constexpr std::size_t MaxOffset{ 65535 };
+    constexpr unsigned int HashBits{ 14 };
+    // Short literal runs and matches are copied with one fixed-size memcpy
+    // when both buffers have this much room left.
+    constexpr std::size_t FastCopyBytes{ 16 };
+
+    std::uint32_t Load32(const std::byte* Data) {
+        std::uint32_t Value{ 0 };
+        std::memcpy(&Value, Data, sizeof(Value));
+        return Value;
+    }
+
+    std::uint32_t HashSequence(std::uint32_t Sequence) {
+        return (Sequence * 2654435761u) >> (32 - HashBits);
+    }
+
+    std::byte* WriteLength(std::byte* Out, std::size_t Length) {
+        while (Length >= 255) {
+            *Out++ = std::byte{ 255 };
+            Length -= 255;
+        }
+        *Out++ = static_cast<std::byte>(Length);
+        return Out;
+    }
+
+    bool ReadLength(const std::byte*& In, const std::byte* End, std::size_t& Length) {
+        while (true) {
+            if (In >= End) {
+                return false;
+            }
+            const std::size_t Extra{ static_cast<std::size_t>(*In++) };
+            Length += Extra;
+            if (Extra != 255) {
+                return true;
+            }
+        }
+    }
+
+    std::byte* WriteSequence(std::byte* Out, const std::byte* Literals, std::size_t LiteralCount, std::size_t Offset, std::size_t MatchLength) {
+        const std::size_t MatchCode{ MatchLength - MinMatch };
+        std::byte* Token{ Out++ };
+        std::uint8_t TokenValue{ static_cast<std::uint8_t>((LiteralCount >= 15 ? 15 : LiteralCount) << 4) };
+        if (LiteralCount >= 15) {
+            Out = WriteLength(Out, LiteralCount - 15);
+        }
+        std::memcpy(Out, Literals, LiteralCount);
+        Out += LiteralCount;
+        if (MatchLength == 0) {
+            *Token = static_cast<std::byte>(TokenValue);
+            return Out;
+        }
+        *Out++ = static_cast<std::byte>(Offset & 0xFF);
+        *Out++ = static_cast<std::byte>((Offset >> 8) & 0xFF);
+        TokenValue |= static_cast<std::uint8_t>(MatchCode >= 15 ? 15 : MatchCode);
+        if (MatchCode >= 15) {
+            Out = WriteLength(Out, MatchCode - 15);
+        }
+        *Token = static_cast<std::byte>(TokenValue);
+        return Out;
+    }
+}
+
+std::size_t LzCodec::CompressBound(std::size_t InputSize) {
+    return InputSize + InputSize / 255 + 16;
+}
+
+std::size_t LzCodec::Compress(std::span<const std::byte> Input, std::span<std::byte> Output) {
+    if (Output.size() < CompressBound(Input.size())) {
+        return 0;
+    }
+    const std::byte* const Base{ Input.data() };
+    const std::size_t Size{ Input.size() };
+    std::byte* Out{ Output.data() };
+    std::size_t Anchor{ 0 };
+
+    if (Size > MinMatch + LastLiterals) {
+        std::vector<std::uint32_t> Table(std::size_t{ 1 } << HashBits, 0);
+        const std::size_t MatchLimit{ Size - LastLiterals };
+        std::size_t Position{ 0 };
+        while (Position + MinMatch <= MatchLimit) {
+            const std::uint32_t Sequence{ Load32(Base + Position) };
+            const std::uint32_t Hash{ HashSequence(Sequence) };
+            const std::size_t Candidate{ Table[Hash] };
+            Table[Hash] = static_cast<std::uint32_t>(Position);
+            if (Candidate >= Position || Position - Candidate > MaxOffset || Load32(Base + Candidate) != Sequence) {
+                // Step further the longer we go without a match.
+                Position += 1 + ((Position - Anchor) >> 6);
+                continue;
+            }
+            std::size_t MatchLength{ MinMatch };
+            while (Position + MatchLength < MatchLimit && Base[Candidate + MatchLength] == Base[Position + MatchLength]) {
+                ++MatchLength;
+            }
+            Out = WriteSequence(Out, Base + Anchor, Position - Anchor, Position - Candidate, MatchLength);
+            Position += MatchLength;
+            Anchor = Position;
+        }
+    }
+    Out = WriteSequence(Out, Base + Anchor, Size - Anchor, 0, 0);
+    return static_cast<std::size_t>(Out - Output.data());
+}
+
+bool LzCodec::Decompress(std::span<const std::byte> Input, std::span<std::byte> Output) {
+    const std::byte* In{ Input.data() };
+    const std::byte* const InEnd{ In + Input.size() };
+    std::byte* Out{ Output.data() };
+    std::byte* const OutBegin{ Output.data() };
+    std::byte* const OutEnd{ Out + Output.size() };
+
+    while (In < InEnd) {
+        const std::uint8_t Token{ static_cast<std::uint8_t>(*In++) };
+        std::size_t LiteralCount{ static_cast<std::size_t>(Token >> 4) };
+        if (LiteralCount == 15 && !ReadLength(In, InEnd, LiteralCount)) {
+            return false;
+        }
+        if (static_cast<std::size_t>(InEnd - In) < LiteralCount || static_cast<std::size_t>(OutEnd - Out) < LiteralCount) {
+            return false;
+        }
+        if (LiteralCount <= FastCopyBytes && static_cast<std::size_t>(InEnd - In) >= FastCopyBytes && static_cast<std::size_t>(OutEnd - Out) >= FastCopyBytes) {
+            std::memcpy(Out, In, FastCopyBytes);
+        }
+        else {
+            std::memcpy(Out, In, LiteralCount);
+        }
+        In += LiteralCount;
+        Out += LiteralCount;
+        if (In == InEnd) {
+            break;
+        }
+
+        if (InEnd - In < 2) {
+            return false;
+        }
+        const std::size_t Offset{ static_cast<std::size_t>(In[0]) | (static_cast<std::size_t>(In[1]) << 8) };
+        In += 2;
+        std::size_t MatchLength{ static_cast<std::size_t>(Token & 0x0F) };
+        if (MatchLength == 15 && !ReadLength(In, InEnd, MatchLength)) {
+            return false;
+        }
+        MatchLength += MinMatch;
+        if (Offset == 0 || static_cast<std::size_t>(Out - OutBegin) < Offset || static_cast<std::size_t>(OutEnd - Out) < MatchLength) {
+            return false;
+        }
+        const std::byte* Match{ Out - Offset };
+        if (Offset >= FastCopyBytes && MatchLength <= FastCopyBytes && static_cast<std::size_t>(OutEnd - Out) >= FastCopyBytes) {
+            std::memcpy(Out, Match, FastCopyBytes);
+            Out += MatchLength;
+            continue;
+        }
+        // An overlapping match repeats the last Offset bytes; every copy
+        // doubles the span of the pattern that can be copied in one go.
+        std::size_t Remaining{ MatchLength };
+        while (Remaining > 0) {
+            const std::size_t Step{ std::min(static_cast<std::size_t>(Out - Match), Remaining) };
+            std::memcpy(Out, Match, Step);
+            Out += Step;
+            Remaining -= Step;
+        }
+    }
+    return Out == OutEnd;
+}
+
+void LzCodec::Shuffle4(std::span<const std::byte> Input, std::span<std::byte> Output) {
+    const std::size_t WordCount{ Input.size() / 4 };
+    for (std::size_t Word{ 0 }; Word < WordCount; ++Word) {
+        Output[Word] = Input[Word * 4];
+        Output[WordCount + Word] = Input[Word * 4 + 1];
+        Output[WordCount * 2 + Word] = Input[Word * 4 + 2];
+        Output[WordCount * 3 + Word] = Input[Word * 4 + 3];
+    }
+    std::copy(Input.begin() + WordCount * 4, Input.end(), Output.begin() + WordCount * 4);
+}
+
+void LzCodec::Unshuffle4(std::span<const std::byte> Input, std::span<std::byte> Output) {
+    const std::size_t WordCount{ Input.size() / 4 };
+    for (std::size_t Word{ 0 }; Word < WordCount; ++Word) {
+        Output[Word * 4] = Input[Word];
+        Output[Word * 4 + 1] = Input[WordCount + Word];
+        Output[Word * 4 + 2] = Input[WordCount * 2 + Word];
+        Output[Word * 4 + 3] = Input[WordCount * 3 + Word];
+    }
+    std::copy(Input.begin() + WordCount * 4, Input.end(), Output.begin() + WordCount * 4);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace asset {
+    // Small byte-oriented LZ77 block codec in the LZ4 family: a greedy
+    // single-probe hash matcher on the encode side and a bounds-checked copy
+    // loop on the decode side. Blocks are independent, so callers split large
+    // arrays into chunks and encode/decode them in parallel.
+    //
+    // Sequence layout:
+    //   token    uint8   high nibble literal length, low nibble match length - 4
+    //   [ext]    uint8*  when a nibble is 15, extra bytes follow (255 = continue)
+    //   literals byte[]
+    //   offset   uint16  distance back to the match (absent in the last sequence)
+    //   [ext]    uint8*  match length extension
+    class LzCodec final {
+    public:
+        static std::size_t CompressBound(std::size_t InputSize);
+        // Returns the compressed size, or 0 when Output is too small.
+        static std::size_t Compress(std::span<const std::byte> Input, std::span<std::byte> Output);
+        // Output must be exactly the original size. Returns false on corrupt input.
+        static bool Decompress(std::span<const std::byte> Input, std::span<std::byte> Output);
+
+        // Transposes 4-byte words into byte planes so the slowly varying high
+        // bytes of floats and indices form long runs. Bytes after the last whole
+        // word, as in a stream of an odd number of 16-bit indices, are copied as is.
+        static void Shuffle4(std::span<const std::byte> Input, std::span<std::byte> Output);
+        static void Unshuffle4(std::span<const std::byte> Input, std::span<std::byte> Output);
+    };
+}
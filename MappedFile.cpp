@@ -0,0 +1,141 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace asset;
+
+MappedFile::MappedFile() = default;
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& Other) noexcept
+    : mData{ std::exchange(Other.mData, nullptr) }
+    , mSize{ std::exchange(Other.mSize, 0) }
+#ifdef _WIN32
+    , mFileHandle{ std::exchange(Other.mFileHandle, nullptr) }
+    , mMappingHandle{ std::exchange(Other.mMappingHandle, nullptr) }
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& Other) noexcept {
+    if (this != &Other) {
+        Close();
+        mData = std::exchange(Other.mData, nullptr);
+        mSize = std::exchange(Other.mSize, 0);
+#ifdef _WIN32
+        mFileHandle = std::exchange(Other.mFileHandle, nullptr);
+        mMappingHandle = std::exchange(Other.mMappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& Path) {
+    Close();
+    HANDLE File{ CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+    if (File == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER FileSize{};
+    if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart <= 0) {
+        CloseHandle(File);
+        return false;
+    }
+    HANDLE Mapping{ CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+    if (Mapping == nullptr) {
+        CloseHandle(File);
+        return false;
+    }
+    void* View{ MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0) };
+    if (View == nullptr) {
+        CloseHandle(Mapping);
+        CloseHandle(File);
+        return false;
+    }
+    mFileHandle = File;
+    mMappingHandle = Mapping;
+    mData = static_cast<const std::byte*>(View);
+    mSize = static_cast<std::size_t>(FileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (mData != nullptr) {
+        UnmapViewOfFile(mData);
+    }
+    if (mMappingHandle != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mMappingHandle));
+    }
+    if (mFileHandle != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mFileHandle));
+    }
+    mData = nullptr;
+    mSize = 0;
+    mFileHandle = nullptr;
+    mMappingHandle = nullptr;
+}
+#else
+bool MappedFile::Open(const std::string& Path) {
+    Close();
+    const int File{ ::open(Path.c_str(), O_RDONLY) };
+    if (File < 0) {
+        return false;
+    }
+    struct stat Info {};
+    if (::fstat(File, &Info) != 0 || Info.st_size <= 0) {
+        ::close(File);
+        return false;
+    }
+    void* View{ ::mmap(nullptr, static_cast<std::size_t>(Info.st_size), PROT_READ, MAP_PRIVATE, File, 0) };
+    ::close(File);
+    if (View == MAP_FAILED) {
+        return false;
+    }
+    mData = static_cast<const std::byte*>(View);
+    mSize = static_cast<std::size_t>(Info.st_size);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (mData != nullptr) {
+        ::munmap(const_cast<std::byte*>(mData), mSize);
+    }
+    mData = nullptr;
+    mSize = 0;
+}
+#endif
+
+bool MappedFile::IsOpen() const {
+    return mData != nullptr;
+}
+
+const std::byte* MappedFile::Data() const {
+    return mData;
+}
+
+std::size_t MappedFile::Size() const {
+    return mSize;
+}
+
+std::span<const std::byte> MappedFile::Bytes() const {
+    return std::span<const std::byte>{ mData, mSize };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace asset {
+    // Read-only memory mapping of a whole file. Pages are faulted in on first
+    // touch, so opening a large asset costs nothing until its bytes are used.
+    class MappedFile final {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        MappedFile(const MappedFile& Other) = delete;
+        MappedFile& operator=(const MappedFile& Other) = delete;
+        MappedFile(MappedFile&& Other) noexcept;
+        MappedFile& operator=(MappedFile&& Other) noexcept;
+
+    public:
+        bool Open(const std::string& Path);
+        void Close();
+
+        bool IsOpen() const;
+        const std::byte* Data() const;
+        std::size_t Size() const;
+        std::span<const std::byte> Bytes() const;
+
+    private:
+        const std::byte* mData{ nullptr };
+        std::size_t mSize{ 0 };
+#ifdef _WIN32
+        void* mFileHandle{ nullptr };
+        void* mMappingHandle{ nullptr };
+#endif
+    };
+}
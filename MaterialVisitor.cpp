@@ -172,21 +172,24 @@ MaterialVisitor::MaterialVisitor() = default;
 MaterialVisitor::~MaterialVisitor() = default;
 
 void MaterialVisitor::OnNodeBegin(const ufbx_scene& Scene, const ufbx_node& Node, const NodeVisitContext& Context) {
-    static_cast<void>(Scene);
     static_cast<void>(Context);
+    // Materials keep the order nodes first reference them in, so unused
+    // ones are skipped and indices do not depend on the file's object order.
+    if (mMaterialIndices.size() != Scene.materials.count) {
+        mMaterialIndices.assign(Scene.materials.count, NoMaterial);
+    }
     std::size_t Count{ Node.materials.count };
     for (std::size_t Index{ 0 }; Index < Count; ++Index) {
         const ufbx_material* MaterialData{ Node.materials.data[Index] };
-        if (MaterialData == nullptr) {
+        if (MaterialData == nullptr || MaterialData->typed_id >= mMaterialIndices.size()) {
             continue;
         }
-        if (mVisitedMaterials.find(MaterialData) != mVisitedMaterials.end()) {
+        std::uint32_t& MaterialIndex{ mMaterialIndices[MaterialData->typed_id] };
+        if (MaterialIndex != NoMaterial) {
             continue;
         }
-        mVisitedMaterials.insert(MaterialData);
-        std::size_t MaterialIndex{ mMaterials.size() };
+        MaterialIndex = static_cast<std::uint32_t>(mMaterials.size());
         mMaterials.push_back(BuildMaterial(*MaterialData));
-        mMaterialLookup.insert({ MaterialData, MaterialIndex });
     }
 }
 
@@ -195,16 +198,19 @@ void MaterialVisitor::OnNodeEnd(const ufbx_scene& Scene, const ufbx_node& Node)
     static_cast<void>(Node);
 }
 
+void MaterialVisitor::OnSceneEnd(const ufbx_scene& Scene) {
+    static_cast<void>(Scene);
+}
+
 std::vector<Material>& MaterialVisitor::GetMaterials() {
     return mMaterials;
 }
 
-const std::unordered_map<const ufbx_material*, std::size_t>& MaterialVisitor::GetMaterialLookup() const {
-    return mMaterialLookup;
+const std::vector<std::uint32_t>& MaterialVisitor::GetMaterialIndices() const {
+    return mMaterialIndices;
 }
 
 void MaterialVisitor::Clear() {
     mMaterials.clear();
-    mMaterialLookup.clear();
-    mVisitedMaterials.clear();
+    mMaterialIndices.clear();
 }
@@ -1,7 +1,6 @@
 #pragma once
 
-#include <unordered_map>
-#include <unordered_set>
+#include <cstdint>
 #include <vector>
 
 #include "Common.h"
@@ -18,17 +17,21 @@ namespace asset {
         MaterialVisitor(MaterialVisitor&& Other) = delete;
         MaterialVisitor& operator=(MaterialVisitor&& Other) = delete;
 
+    public:
+        static constexpr std::uint32_t NoMaterial{ 0xFFFFFFFFu };
+
     public:
         void OnNodeBegin(const ufbx_scene& Scene, const ufbx_node& Node, const NodeVisitContext& Context) override;
         void OnNodeEnd(const ufbx_scene& Scene, const ufbx_node& Node) override;
+        void OnSceneEnd(const ufbx_scene& Scene) override;
 
         std::vector<Material>& GetMaterials();
-        const std::unordered_map<const ufbx_material*, std::size_t>& GetMaterialLookup() const;
+        // Indexed by ufbx_material::typed_id; NoMaterial until a node references it.
+        const std::vector<std::uint32_t>& GetMaterialIndices() const;
         void Clear();
 
     private:
         std::vector<Material> mMaterials{};
-        std::unordered_map<const ufbx_material*, std::size_t> mMaterialLookup{};
-        std::unordered_set<const ufbx_material*> mVisitedMaterials{};
+        std::vector<std::uint32_t> mMaterialIndices{};
     };
 }
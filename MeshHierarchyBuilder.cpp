@@ -1,32 +1,64 @@
 #include "MeshHierarchyBuilder.h"
 
 #include <algorithm>
-#include <cmath>
 #include <cstring>
-#include <map>
+#include <functional>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "MaterialVisitor.h"
+#include "MeshSimplifier.h"
+#include "Meshlets.h"
+#include "VertexGather.h"
+
 using namespace asset;
 
 namespace {
-    Vec3 NormalizeVec3(const Vec3& Value) {
-        const float LengthValue{ std::sqrt((Value.mX * Value.mX) + (Value.mY * Value.mY) + (Value.mZ * Value.mZ)) };
-        if (LengthValue <= 0.0f) {
-            return Vec3{ 0.0f, 1.0f, 0.0f };
+    template <typename T>
+    void AddDedupStream(std::pmr::vector<ufbx_vertex_stream>& Streams, std::pmr::vector<T>& Values) {
+        if (Values.empty()) {
+            return;
+        }
+        ufbx_vertex_stream Stream{};
+        Stream.data = Values.data();
+        Stream.vertex_count = Values.size();
+        Stream.vertex_size = sizeof(T);
+        Streams.push_back(Stream);
+    }
+
+    // Appends the first Count deduplicated values. Streams earlier meshes of
+    // the same node did not have are back-filled with Default first.
+    template <typename T>
+    void AppendStream(std::vector<T>& Out, const std::pmr::vector<T>& Corners, std::size_t BaseCount, std::size_t Count, const T& Default) {
+        if (Corners.empty()) {
+            return;
         }
-        const float InvLength{ 1.0f / LengthValue };
-        return Vec3{ Value.mX * InvLength, Value.mY * InvLength, Value.mZ * InvLength };
+        Out.reserve(BaseCount + Count);
+        Out.resize(BaseCount, Default);
+        Out.insert(Out.end(), Corners.begin(), Corners.begin() + static_cast<std::ptrdiff_t>(Count));
     }
 }
 
-MeshHierarchyBuilder::MeshHierarchyBuilder(ModelResult& OutResult, const std::unordered_map<const ufbx_material*, std::size_t>* MaterialLookup)
+MeshHierarchyBuilder::MeshHierarchyBuilder(ModelResult& OutResult, const std::vector<std::uint32_t>* MaterialIndices, ThreadPool* Pool)
     : mResult{ OutResult }
-    , mMaterialLookup{ MaterialLookup } {
+    , mMaterialIndices{ MaterialIndices }
+    , mThreadPool{ Pool } {
 }
 
 MeshHierarchyBuilder::~MeshHierarchyBuilder() = default;
 
+MeshHierarchyBuilder::CornerAttributes::CornerAttributes(std::pmr::memory_resource* Resource)
+    : Positions{ Resource }
+    , Normals{ Resource }
+    , TexCoords{ std::pmr::vector<Vec2>{ Resource }, std::pmr::vector<Vec2>{ Resource }, std::pmr::vector<Vec2>{ Resource }, std::pmr::vector<Vec2>{ Resource } }
+    , Colors{ Resource }
+    , Tangents{ Resource }
+    , Bitangents{ Resource }
+    , BoneIndices{ Resource }
+    , BoneWeights{ Resource } {
+}
+
 void MeshHierarchyBuilder::OnNodeBegin(const ufbx_scene& Scene, const ufbx_node& Node, const NodeVisitContext& Context) {
     static_cast<void>(Scene);
     ModelNode* ParentNode{ nullptr };
@@ -39,8 +71,18 @@ void MeshHierarchyBuilder::OnNodeBegin(const ufbx_scene& Scene, const ufbx_node&
     ModelNode& OutNode{ mResult.CreateNode(Name, ParentNode) };
     OutNode.SetNodeToParent(Context.mNodeToParent);
     OutNode.SetGeometryToNode(Context.mGeometryToNode);
-    if (Node.mesh != nullptr) {
-        AppendIndexedMeshUfbx(Node, *Node.mesh, OutNode.Vertices(), OutNode.Indices(), OutNode.SubMeshes());
+    if (mExtractMeshes && Node.mesh != nullptr) {
+        MeshKey Key{ Node.mesh, std::vector<const ufbx_material*>{ Node.materials.data, Node.materials.data + Node.materials.count } };
+        const auto Found{ mMeshLookup.find(Key) };
+        if (Found != mMeshLookup.end()) {
+            OutNode.SetMeshIndex(Found->second);
+        }
+        else {
+            const std::uint32_t MeshIndex{ mResult.CreateMesh() };
+            mMeshLookup.emplace(std::move(Key), MeshIndex);
+            mPendingMeshes.push_back(PendingMesh{ &Node, MeshIndex });
+            OutNode.SetMeshIndex(MeshIndex);
+        }
     }
     mNodeStack.push_back(&OutNode);
 }
@@ -55,225 +97,392 @@ void MeshHierarchyBuilder::OnNodeEnd(const ufbx_scene& Scene, const ufbx_node& N
     throw AssetError{ "MeshHierarchyBuilder: node stack underflow" };
 }
 
-Vec3 MeshHierarchyBuilder::ToVec3(const ufbx_vec3& Value) {
-    return Vec3{ static_cast<float>(Value.x), static_cast<float>(Value.y), static_cast<float>(Value.z) };
+void MeshHierarchyBuilder::OnSceneEnd(const ufbx_scene& Scene) {
+    static_cast<void>(Scene);
+    // Every pending mesh writes only into its own table entry, and the
+    // material lookup is complete once the traversal is done, so meshes are
+    // independent and the result does not depend on the order they finish in.
+    mMeshProgress = ImportProgress{};
+    mMeshProgress.Stage = ImportStage::Meshes;
+    mMeshProgress.MeshCount = mPendingMeshes.size();
+    for (const PendingMesh& Pending : mPendingMeshes) {
+        mMeshProgress.CornerCount += Pending.Node->mesh->num_indices;
+    }
+    mCancelled = false;
+    mCacheReports.clear();
+    if (mOptimizeMeshes) {
+        mCacheReports.resize(mPendingMeshes.size());
+    }
+    // A first report before any work gives the callback a start time for
+    // throughput and a chance to cancel before extraction begins.
+    if (mProgress != nullptr && *mProgress && !(*mProgress)(mMeshProgress)) {
+        mCancelled = true;
+    }
+    const auto ExtractMesh{ [this](std::size_t Index) {
+        if (mCancelled.load(std::memory_order_relaxed)) {
+            return;
+        }
+        const PendingMesh& Pending{ mPendingMeshes[Index] };
+        ModelMesh& Target{ mResult.GetMesh(Pending.MeshIndex) };
+        const ArenaLease Lease{ *this };
+        ScratchArena& Scratch{ Lease.Get() };
+        AppendIndexedMeshUfbx(*Pending.Node, *Pending.Node->mesh, Target.Vertices(), Target.Indices(), Target.SubMeshes(), Scratch);
+        Scratch.Reset();
+        if (mOptimizeMeshes) {
+            VertexCacheReport& Report{ mCacheReports[Index] };
+            Report.NodeName = (Pending.Node->name.data != nullptr) ? std::string{ Pending.Node->name.data, Pending.Node->name.length } : std::string{ "Unnamed" };
+            Report.MeshIndex = Pending.MeshIndex;
+            OptimizeMesh(Target, Scratch, Report);
+        }
+        if (mSplitForShortIndices) {
+            SplitForShortIndices(Target, &Scratch);
+            Scratch.Reset();
+        }
+        if (mBuildLods) {
+            BuildLods(Target, Scratch, mOptimizeMeshes);
+        }
+        if (mBuildMeshlets) {
+            BuildMeshlets(Target, &Scratch);
+            Scratch.Reset();
+        }
+        ReportMeshDone(Pending.Node->mesh->num_indices);
+    } };
+    if (mThreadPool != nullptr && mThreadPool->GetWorkerCount() > 1) {
+        mThreadPool->ParallelFor(mPendingMeshes.size(), ExtractMesh);
+    }
+    else {
+        for (std::size_t Index{ 0 }; Index < mPendingMeshes.size(); ++Index) {
+            ExtractMesh(Index);
+        }
+    }
+    mPendingMeshes.clear();
+    mMeshLookup.clear();
+
+    mScratchStats = ScratchArenaStats{};
+    for (const std::unique_ptr<ScratchArena>& Arena : mArenas) {
+        mScratchStats.Merge(Arena->GetStats());
+    }
+    if (mCancelled) {
+        throw AssetError{ "import cancelled" };
+    }
+}
+
+void MeshHierarchyBuilder::SetExtractMeshes(bool Enabled) {
+    mExtractMeshes = Enabled;
 }
 
-Vec2 MeshHierarchyBuilder::ToVec2(const ufbx_vec2& Value) {
-    return Vec2{ static_cast<float>(Value.x), static_cast<float>(Value.y) };
+void MeshHierarchyBuilder::SetOptimizeMeshes(bool Enabled) {
+    mOptimizeMeshes = Enabled;
 }
 
-Vec4 MeshHierarchyBuilder::ToVec4(const ufbx_vec4& Value) {
-    return Vec4{ static_cast<float>(Value.x), static_cast<float>(Value.y), static_cast<float>(Value.z), static_cast<float>(Value.w) };
+const std::vector<VertexCacheReport>& MeshHierarchyBuilder::GetVertexCacheReports() const {
+    return mCacheReports;
 }
 
-Vec3 MeshHierarchyBuilder::ReadPosition(const ufbx_mesh& Mesh, std::uint32_t Index) const {
-    const ufbx_vec3 Value{ ufbx_get_vertex_vec3(&Mesh.vertex_position, Index) };
-    return ToVec3(Value);
+void MeshHierarchyBuilder::SetBuildMeshlets(bool Enabled) {
+    mBuildMeshlets = Enabled;
 }
 
-Vec3 MeshHierarchyBuilder::ReadNormal(const ufbx_mesh& Mesh, std::uint32_t Index) const {
-    if (Mesh.vertex_normal.exists) {
-        const ufbx_vec3 Value{ ufbx_get_vertex_vec3(&Mesh.vertex_normal, Index) };
-        return NormalizeVec3(ToVec3(Value));
-    }
-    return Vec3{ 0.0f, 1.0f, 0.0f };
+void MeshHierarchyBuilder::SetBuildLods(bool Enabled) {
+    mBuildLods = Enabled;
 }
 
-Vec2 MeshHierarchyBuilder::ReadTexCoord(const ufbx_mesh& Mesh, std::size_t SetIndex, std::uint32_t Index) const {
-    if (SetIndex == 0) {
-        if (Mesh.vertex_uv.exists) {
-            const ufbx_vec2 Value{ ufbx_get_vertex_vec2(&Mesh.vertex_uv, Index) };
-            return ToVec2(Value);
-        }
-        return Vec2{ 0.0f, 0.0f };
-    }
+void MeshHierarchyBuilder::SetSplitForShortIndices(bool Enabled) {
+    mSplitForShortIndices = Enabled;
+}
 
-    if (SetIndex < Mesh.uv_sets.count) {
-        const ufbx_uv_set& Set{ Mesh.uv_sets.data[SetIndex] };
-        if (Set.vertex_uv.exists) {
-            const ufbx_vec2 Value{ ufbx_get_vertex_vec2(&Set.vertex_uv, Index) };
-            return ToVec2(Value);
-        }
-    }
-    return Vec2{ 0.0f, 0.0f };
+void MeshHierarchyBuilder::SetProgressCallback(const ImportProgressCallback* Callback) {
+    mProgress = Callback;
 }
 
-Vec4 MeshHierarchyBuilder::ReadColor(const ufbx_mesh& Mesh, std::uint32_t Index) const {
-    if (Mesh.vertex_color.exists) {
-        const ufbx_vec4 Value{ ufbx_get_vertex_vec4(&Mesh.vertex_color, Index) };
-        return ToVec4(Value);
-    }
-    return Vec4{ 1.0f, 1.0f, 1.0f, 1.0f };
+const ScratchArenaStats& MeshHierarchyBuilder::GetScratchStats() const {
+    return mScratchStats;
 }
 
-Vec3 MeshHierarchyBuilder::ReadTangent(const ufbx_mesh& Mesh, std::uint32_t Index) const {
-    if (Mesh.vertex_tangent.exists) {
-        const ufbx_vec3 Value{ ufbx_get_vertex_vec3(&Mesh.vertex_tangent, Index) };
-        return ToVec3(Value);
+ScratchArena& MeshHierarchyBuilder::AcquireArena() {
+    const std::lock_guard<std::mutex> Lock{ mArenaMutex };
+    if (mFreeArenas.empty()) {
+        mArenas.push_back(std::make_unique<ScratchArena>());
+        return *mArenas.back();
     }
-    return Vec3{ 0.0f, 0.0f, 0.0f };
+    ScratchArena* Arena{ mFreeArenas.back() };
+    mFreeArenas.pop_back();
+    return *Arena;
 }
 
-Vec3 MeshHierarchyBuilder::ReadBitangent(const ufbx_mesh& Mesh, std::uint32_t Index) const {
-    if (Mesh.vertex_bitangent.exists) {
-        const ufbx_vec3 Value{ ufbx_get_vertex_vec3(&Mesh.vertex_bitangent, Index) };
-        return ToVec3(Value);
-    }
-    return Vec3{ 0.0f, 0.0f, 0.0f };
+void MeshHierarchyBuilder::ReleaseArena(ScratchArena& Arena) {
+    const std::lock_guard<std::mutex> Lock{ mArenaMutex };
+    mFreeArenas.push_back(&Arena);
 }
 
-void MeshHierarchyBuilder::ReadBoneData(const ufbx_mesh& Mesh, std::uint32_t CornerIndex, UVec4& OutIndices, Vec4& OutWeights) const {
-    std::uint32_t Indices[4]{ 0, 0, 0, 0 };
-    float Weights[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
+MeshHierarchyBuilder::ArenaLease::ArenaLease(MeshHierarchyBuilder& Builder)
+    : mBuilder{ Builder }
+    , mArena{ Builder.AcquireArena() } {
+}
 
-    if (Mesh.skin_deformers.count == 0) {
-        OutIndices = UVec4{ Indices[0], Indices[1], Indices[2], Indices[3] };
-        OutWeights = Vec4{ Weights[0], Weights[1], Weights[2], Weights[3] };
-        return;
-    }
+MeshHierarchyBuilder::ArenaLease::~ArenaLease() {
+    mBuilder.ReleaseArena(mArena);
+}
 
-    const ufbx_skin_deformer* Skin{ Mesh.skin_deformers.data[0] };
-    if (Skin == nullptr) {
-        OutIndices = UVec4{ Indices[0], Indices[1], Indices[2], Indices[3] };
-        OutWeights = Vec4{ Weights[0], Weights[1], Weights[2], Weights[3] };
-        return;
+ScratchArena& MeshHierarchyBuilder::ArenaLease::Get() const {
+    return mArena;
+}
+
+void MeshHierarchyBuilder::OptimizeMesh(ModelMesh& Mesh, ScratchArena& Scratch, VertexCacheReport& OutReport) {
+    std::vector<std::uint32_t>& Indices{ Mesh.Indices() };
+    const std::size_t VertexCount{ Mesh.Vertices().VertexCount() };
+    OutReport.TriangleCount = Indices.size() / 3;
+    OutReport.Before = AnalyzeVertexCache(Indices, VertexCount, DefaultVertexCacheSize, &Scratch);
+    Scratch.Reset();
+    for (const ModelMesh::SubMesh& Range : Mesh.SubMeshes()) {
+        OptimizeVertexCache(std::span<std::uint32_t>{ Indices }.subspan(Range.IndexOffset, Range.IndexCount), &Scratch);
+        Scratch.Reset();
     }
+    OptimizeVertexFetch(Mesh.Vertices(), Indices, &Scratch);
+    Scratch.Reset();
+    OutReport.After = AnalyzeVertexCache(Indices, VertexCount, DefaultVertexCacheSize, &Scratch);
+    Scratch.Reset();
+}
 
-    if (CornerIndex >= Mesh.vertex_indices.count) {
-        OutIndices = UVec4{ Indices[0], Indices[1], Indices[2], Indices[3] };
-        OutWeights = Vec4{ Weights[0], Weights[1], Weights[2], Weights[3] };
-        return;
+void MeshHierarchyBuilder::BuildLods(ModelMesh& Mesh, ScratchArena& Scratch, bool OptimizeCache) {
+    constexpr std::size_t MinReductionDivisor{ 10 };
+    std::vector<std::uint32_t>& Indices{ Mesh.Indices() };
+    const std::span<const Vec3> Positions{ Mesh.Vertices().Positions };
+    std::vector<ModelMesh::Lod>& Lods{ Mesh.Lods() };
+    Lods.clear();
+    // Heap-allocated so Scratch can be reset between levels.
+    std::vector<std::uint32_t> Level{};
+    for (std::size_t SubMeshIndex{ 0 }; SubMeshIndex < Mesh.SubMeshes().size(); ++SubMeshIndex) {
+        const ModelMesh::SubMesh Range{ Mesh.SubMeshes()[SubMeshIndex] };
+        Level.assign(Indices.begin() + static_cast<std::ptrdiff_t>(Range.IndexOffset), Indices.begin() + static_cast<std::ptrdiff_t>(Range.IndexOffset + Range.IndexCount));
+        // Each level is measured against the one before, so the deviation
+        // from the SubMesh is bounded by the sum.
+        float Error{ 0.0f };
+        for (std::size_t LevelIndex{ 1 }; LevelIndex <= DefaultLodCount; ++LevelIndex) {
+            const std::size_t Previous{ Level.size() };
+            float LevelError{ 0.0f };
+            const std::size_t Count{ SimplifyMesh(Level, Positions, Previous / 2, LevelError, &Scratch) };
+            Scratch.Reset();
+            if (Count == 0 || Previous - Count < Previous / MinReductionDivisor) {
+                break;
+            }
+            Level.resize(Count);
+            Error += LevelError;
+            const std::size_t Offset{ Indices.size() };
+            Indices.insert(Indices.end(), Level.begin(), Level.end());
+            if (OptimizeCache) {
+                OptimizeVertexCache(std::span<std::uint32_t>{ Indices }.subspan(Offset, Count), &Scratch);
+                Scratch.Reset();
+            }
+            Lods.push_back(ModelMesh::Lod{ SubMeshIndex, LevelIndex, Offset, Count, Error });
+        }
     }
+}
 
-    const std::uint32_t VertexIndex{ Mesh.vertex_indices.data[CornerIndex] };
-    if (VertexIndex >= Skin->vertices.count) {
-        OutIndices = UVec4{ Indices[0], Indices[1], Indices[2], Indices[3] };
-        OutWeights = Vec4{ Weights[0], Weights[1], Weights[2], Weights[3] };
-        return;
+void MeshHierarchyBuilder::ReportMeshDone(std::uint64_t Corners) {
+    const std::lock_guard<std::mutex> Lock{ mProgressMutex };
+    ++mMeshProgress.MeshesDone;
+    mMeshProgress.CornersDone += Corners;
+    if (mProgress != nullptr && *mProgress && !(*mProgress)(mMeshProgress)) {
+        mCancelled = true;
     }
+}
 
-    const ufbx_skin_vertex& SkinVertex{ Skin->vertices.data[VertexIndex] };
-    const std::size_t WeightCount{ std::min<std::size_t>(SkinVertex.num_weights, 4) };
-    if (WeightCount == 0) {
-        OutIndices = UVec4{ Indices[0], Indices[1], Indices[2], Indices[3] };
-        OutWeights = Vec4{ Weights[0], Weights[1], Weights[2], Weights[3] };
-        return;
+std::pmr::vector<MeshHierarchyBuilder::SkinInfluences> MeshHierarchyBuilder::BuildSkinTable(const ufbx_mesh& Mesh, std::pmr::memory_resource* Resource) {
+    // Indexed by control point, so every corner of a vertex shares one entry.
+    // Control points without a skin vertex keep zero weights.
+    std::pmr::vector<SkinInfluences> Table(Mesh.num_vertices, Resource);
+    if (Mesh.skin_deformers.count == 0 || Mesh.skin_deformers.data[0] == nullptr) {
+        return Table;
     }
 
-    float WeightSum{ 0.0f };
-    for (std::size_t Index{ 0 }; Index < WeightCount; ++Index) {
-        const std::size_t WeightIndex{ SkinVertex.weight_begin + Index };
-        if (WeightIndex >= Skin->weights.count) {
-            break;
+    const ufbx_skin_deformer& Skin{ *Mesh.skin_deformers.data[0] };
+    const std::size_t VertexCount{ std::min(Table.size(), Skin.vertices.count) };
+    for (std::size_t VertexIndex{ 0 }; VertexIndex < VertexCount; ++VertexIndex) {
+        const ufbx_skin_vertex& SkinVertex{ Skin.vertices.data[VertexIndex] };
+        const std::size_t WeightEnd{ std::min<std::size_t>(static_cast<std::size_t>(SkinVertex.weight_begin) + SkinVertex.num_weights, Skin.weights.count) };
+
+        // Insertion into a fixed top-N list; only a strictly larger weight
+        // moves ahead, so equal weights keep their source order.
+        std::array<std::uint32_t, MaxSkinInfluences> Indices{};
+        std::array<float, MaxSkinInfluences> Weights{};
+        std::size_t Count{ 0 };
+        for (std::size_t WeightIndex{ SkinVertex.weight_begin }; WeightIndex < WeightEnd; ++WeightIndex) {
+            const ufbx_skin_weight& Weight{ Skin.weights.data[WeightIndex] };
+            const float Value{ static_cast<float>(Weight.weight) };
+            std::size_t Slot{ Count };
+            while (Slot > 0 && Weights[Slot - 1] < Value) {
+                --Slot;
+            }
+            if (Slot >= MaxSkinInfluences) {
+                continue;
+            }
+            const std::size_t Last{ std::min(Count, MaxSkinInfluences - 1) };
+            for (std::size_t Move{ Last }; Move > Slot; --Move) {
+                Indices[Move] = Indices[Move - 1];
+                Weights[Move] = Weights[Move - 1];
+            }
+            Indices[Slot] = Weight.cluster_index;
+            Weights[Slot] = Value;
+            Count = std::min(Count + 1, MaxSkinInfluences);
         }
-        const ufbx_skin_weight& Weight{ Skin->weights.data[WeightIndex] };
-        Indices[Index] = Weight.cluster_index;
-        Weights[Index] = static_cast<float>(Weight.weight);
-        WeightSum += Weights[Index];
-    }
 
-    if (WeightSum > 0.0f) {
-        for (std::size_t Index{ 0 }; Index < WeightCount; ++Index) {
-            Weights[Index] = Weights[Index] / WeightSum;
+        float WeightSum{ 0.0f };
+        for (std::size_t Index{ 0 }; Index < Count; ++Index) {
+            WeightSum += Weights[Index];
+        }
+        if (WeightSum > 0.0f) {
+            for (std::size_t Index{ 0 }; Index < Count; ++Index) {
+                Weights[Index] = Weights[Index] / WeightSum;
+            }
         }
-    }
 
-    OutIndices = UVec4{ Indices[0], Indices[1], Indices[2], Indices[3] };
-    OutWeights = Vec4{ Weights[0], Weights[1], Weights[2], Weights[3] };
+        Table[VertexIndex].Indices = UVec4{ Indices[0], Indices[1], Indices[2], Indices[3] };
+        Table[VertexIndex].Weights = Vec4{ Weights[0], Weights[1], Weights[2], Weights[3] };
+    }
+    return Table;
 }
 
-std::size_t MeshHierarchyBuilder::ResolveMaterialIndex(const ufbx_node& Node, const ufbx_mesh& Mesh, std::size_t FaceIndex) const {
+std::size_t MeshHierarchyBuilder::ResolveMaterialIndex(const ufbx_node& Node, std::size_t MaterialSlot) const {
     std::size_t MaterialIndex{ 0 };
-    if (mMaterialLookup == nullptr) {
+    if (mMaterialIndices == nullptr || MaterialSlot >= Node.materials.count) {
         return MaterialIndex;
     }
-    if (Node.materials.count == 0) {
-        return MaterialIndex;
-    }
-    std::size_t MaterialSlot{ 0 };
-    if (FaceIndex < Mesh.face_material.count) {
-        MaterialSlot = Mesh.face_material.data[FaceIndex];
-    }
-    if (MaterialSlot >= Node.materials.count) {
-        MaterialSlot = 0;
-    }
     const ufbx_material* MaterialData{ Node.materials.data[MaterialSlot] };
-    if (MaterialData == nullptr) {
+    if (MaterialData == nullptr || MaterialData->typed_id >= mMaterialIndices->size()) {
         return MaterialIndex;
     }
-    auto Lookup{ mMaterialLookup->find(MaterialData) };
-    if (Lookup == mMaterialLookup->end()) {
+    const std::uint32_t Found{ (*mMaterialIndices)[MaterialData->typed_id] };
+    if (Found == MaterialVisitor::NoMaterial) {
         return MaterialIndex;
     }
-    return Lookup->second;
+    return Found;
 }
 
-MeshHierarchyBuilder::PackedVertex MeshHierarchyBuilder::MakePackedVertex(const ufbx_mesh& Mesh, std::uint32_t CornerIndex) const {
-    PackedVertex Packed{};
-    const Vec3 Position{ ReadPosition(Mesh, CornerIndex) };
-    const Vec3 Normal{ ReadNormal(Mesh, CornerIndex) };
-    const Vec4 Color{ ReadColor(Mesh, CornerIndex) };
-    const Vec3 Tangent{ ReadTangent(Mesh, CornerIndex) };
-    const Vec3 Bitangent{ ReadBitangent(Mesh, CornerIndex) };
-    UVec4 BoneIndices{};
-    Vec4 BoneWeights{};
-    ReadBoneData(Mesh, CornerIndex, BoneIndices, BoneWeights);
-
-    Packed.Position[0] = Position.mX;
-    Packed.Position[1] = Position.mY;
-    Packed.Position[2] = Position.mZ;
-    Packed.Normal[0] = Normal.mX;
-    Packed.Normal[1] = Normal.mY;
-    Packed.Normal[2] = Normal.mZ;
-    Packed.Color[0] = Color.mX;
-    Packed.Color[1] = Color.mY;
-    Packed.Color[2] = Color.mZ;
-    Packed.Color[3] = Color.mW;
-    Packed.Tangent[0] = Tangent.mX;
-    Packed.Tangent[1] = Tangent.mY;
-    Packed.Tangent[2] = Tangent.mZ;
-    Packed.Bitangent[0] = Bitangent.mX;
-    Packed.Bitangent[1] = Bitangent.mY;
-    Packed.Bitangent[2] = Bitangent.mZ;
-    Packed.BoneIndices[0] = BoneIndices.mX;
-    Packed.BoneIndices[1] = BoneIndices.mY;
-    Packed.BoneIndices[2] = BoneIndices.mZ;
-    Packed.BoneIndices[3] = BoneIndices.mW;
-    Packed.BoneWeights[0] = BoneWeights.mX;
-    Packed.BoneWeights[1] = BoneWeights.mY;
-    Packed.BoneWeights[2] = BoneWeights.mZ;
-    Packed.BoneWeights[3] = BoneWeights.mW;
-
-    for (std::size_t SetIndex{ 0 }; SetIndex < 4; ++SetIndex) {
-        const Vec2 TexCoord{ ReadTexCoord(Mesh, SetIndex, CornerIndex) };
-        Packed.TexCoord[SetIndex][0] = TexCoord.mX;
-        Packed.TexCoord[SetIndex][1] = TexCoord.mY;
-    }
-
-    return Packed;
+MeshHierarchyBuilder::PresentAttributes MeshHierarchyBuilder::DetectAttributes(const ufbx_mesh& Mesh, const VertexAttributes& Existing) {
+    PresentAttributes Present{};
+    Present.TexCoords[0] = Mesh.vertex_uv.exists;
+    for (std::size_t SetIndex{ 1 }; SetIndex < Present.TexCoords.size(); ++SetIndex) {
+        Present.TexCoords[SetIndex] = SetIndex < Mesh.uv_sets.count && Mesh.uv_sets.data[SetIndex].vertex_uv.exists;
+    }
+    Present.Colors = Mesh.vertex_color.exists;
+    Present.Tangents = Mesh.vertex_tangent.exists;
+    Present.Bitangents = Mesh.vertex_bitangent.exists;
+    Present.Skin = Mesh.skin_deformers.count > 0 && Mesh.skin_deformers.data[0] != nullptr;
+
+    // A stream that is already populated has to stay aligned with Positions.
+    for (std::size_t SetIndex{ 0 }; SetIndex < Present.TexCoords.size(); ++SetIndex) {
+        Present.TexCoords[SetIndex] = Present.TexCoords[SetIndex] || !Existing.TexCoords[SetIndex].empty();
+    }
+    Present.Colors = Present.Colors || !Existing.Colors.empty();
+    Present.Tangents = Present.Tangents || !Existing.Tangents.empty();
+    Present.Bitangents = Present.Bitangents || !Existing.Bitangents.empty();
+    Present.Skin = Present.Skin || !Existing.BoneIndices.empty();
+    return Present;
+}
+
+void MeshHierarchyBuilder::GatherCorners(const ufbx_mesh& Mesh, const PresentAttributes& Present, CornerAttributes& OutCorners) const {
+    // Each attribute is gathered as one column over all corners instead of
+    // one corner at a time across all attributes; skin influences come from
+    // a per-control-point table.
+    const std::size_t NumCorners{ Mesh.num_indices };
+    OutCorners.Positions.resize(NumCorners);
+    GatherVertexVec3(Mesh.vertex_position, OutCorners.Positions);
+    if (Mesh.vertex_normal.exists) {
+        OutCorners.Normals.resize(NumCorners);
+        GatherVertexVec3(Mesh.vertex_normal, OutCorners.Normals);
+        NormalizeVec3s(OutCorners.Normals);
+    }
+    else {
+        OutCorners.Normals.assign(NumCorners, Vec3{ 0.0f, 1.0f, 0.0f });
+    }
+    for (std::size_t SetIndex{ 0 }; SetIndex < Present.TexCoords.size(); ++SetIndex) {
+        if (!Present.TexCoords[SetIndex]) {
+            continue;
+        }
+        const ufbx_vertex_vec2* Source{ nullptr };
+        if (SetIndex == 0) {
+            Source = &Mesh.vertex_uv;
+        }
+        else if (SetIndex < Mesh.uv_sets.count) {
+            Source = &Mesh.uv_sets.data[SetIndex].vertex_uv;
+        }
+        std::pmr::vector<Vec2>& TexCoords{ OutCorners.TexCoords[SetIndex] };
+        if (Source != nullptr && Source->exists) {
+            TexCoords.resize(NumCorners);
+            GatherVertexVec2(*Source, TexCoords);
+        }
+        else {
+            TexCoords.assign(NumCorners, Vec2{ 0.0f, 0.0f });
+        }
+    }
+    if (Present.Colors) {
+        if (Mesh.vertex_color.exists) {
+            OutCorners.Colors.resize(NumCorners);
+            GatherVertexVec4(Mesh.vertex_color, OutCorners.Colors);
+        }
+        else {
+            OutCorners.Colors.assign(NumCorners, Vec4{ 1.0f, 1.0f, 1.0f, 1.0f });
+        }
+    }
+    if (Present.Tangents) {
+        if (Mesh.vertex_tangent.exists) {
+            OutCorners.Tangents.resize(NumCorners);
+            GatherVertexVec3(Mesh.vertex_tangent, OutCorners.Tangents);
+        }
+        else {
+            OutCorners.Tangents.assign(NumCorners, Vec3{ 0.0f, 0.0f, 0.0f });
+        }
+    }
+    if (Present.Bitangents) {
+        if (Mesh.vertex_bitangent.exists) {
+            OutCorners.Bitangents.resize(NumCorners);
+            GatherVertexVec3(Mesh.vertex_bitangent, OutCorners.Bitangents);
+        }
+        else {
+            OutCorners.Bitangents.assign(NumCorners, Vec3{ 0.0f, 0.0f, 0.0f });
+        }
+    }
+    if (Present.Skin) {
+        const std::pmr::vector<SkinInfluences> SkinTable{ BuildSkinTable(Mesh, OutCorners.Positions.get_allocator().resource()) };
+        OutCorners.BoneIndices.resize(NumCorners);
+        OutCorners.BoneWeights.resize(NumCorners);
+        for (std::size_t CornerIndex{ 0 }; CornerIndex < NumCorners; ++CornerIndex) {
+            const SkinInfluences& Influences{ SkinTable[Mesh.vertex_indices.data[CornerIndex]] };
+            OutCorners.BoneIndices[CornerIndex] = Influences.Indices;
+            OutCorners.BoneWeights[CornerIndex] = Influences.Weights;
+        }
+    }
 }
 
-void MeshHierarchyBuilder::AppendIndexedMeshUfbx(const ufbx_node& Node, const ufbx_mesh& Mesh, VertexAttributes& OutVertices, std::vector<std::uint32_t>& OutIndices, std::vector<ModelNode::SubMesh>& OutSubMeshes) const {
+void MeshHierarchyBuilder::AppendIndexedMeshUfbx(const ufbx_node& Node, const ufbx_mesh& Mesh, VertexAttributes& OutVertices, std::vector<std::uint32_t>& OutIndices, std::vector<ModelMesh::SubMesh>& OutSubMeshes, ScratchArena& Scratch) const {
     const std::size_t NumCorners{ Mesh.num_indices };
     if (NumCorners == 0) {
         return;
     }
 
-    std::vector<PackedVertex> CornerVertices{};
-    CornerVertices.resize(NumCorners);
-    for (std::size_t CornerIndex{ 0 }; CornerIndex < NumCorners; ++CornerIndex) {
-        CornerVertices[CornerIndex] = MakePackedVertex(Mesh, static_cast<std::uint32_t>(CornerIndex));
+    // One column per present attribute; ufbx packs them into a compact key
+    // for hashing and compacts every column to the unique vertices in place.
+    const PresentAttributes Present{ DetectAttributes(Mesh, OutVertices) };
+    CornerAttributes Corners{ &Scratch };
+    GatherCorners(Mesh, Present, Corners);
+
+    std::pmr::vector<ufbx_vertex_stream> Streams{ &Scratch };
+    AddDedupStream(Streams, Corners.Positions);
+    AddDedupStream(Streams, Corners.Normals);
+    for (std::pmr::vector<Vec2>& TexCoords : Corners.TexCoords) {
+        AddDedupStream(Streams, TexCoords);
     }
-
-    std::vector<std::uint32_t> Remap{};
-    Remap.resize(NumCorners);
-    ufbx_vertex_stream Stream{};
-    Stream.data = CornerVertices.data();
-    Stream.vertex_count = NumCorners;
-    Stream.vertex_size = sizeof(PackedVertex);
+    AddDedupStream(Streams, Corners.Colors);
+    AddDedupStream(Streams, Corners.Tangents);
+    AddDedupStream(Streams, Corners.Bitangents);
+    AddDedupStream(Streams, Corners.BoneIndices);
+    AddDedupStream(Streams, Corners.BoneWeights);
+
+    std::pmr::vector<std::uint32_t> Remap(NumCorners, &Scratch);
+    const ufbx_allocator_opts Allocator{ Scratch.UfbxAllocator() };
     ufbx_error GenErr{};
-    const std::size_t UniqueVertexCount{ ufbx_generate_indices(&Stream, 1, Remap.data(), NumCorners, nullptr, &GenErr) };
+    const std::size_t UniqueVertexCount{ ufbx_generate_indices(Streams.data(), Streams.size(), Remap.data(), NumCorners, &Allocator, &GenErr) };
     if (UniqueVertexCount == 0) {
         const std::string Desc{ (GenErr.description.data != nullptr) ? std::string{ GenErr.description.data, GenErr.description.length } : std::string{} };
         if (!Desc.empty()) {
@@ -282,55 +491,116 @@ void MeshHierarchyBuilder::AppendIndexedMeshUfbx(const ufbx_node& Node, const uf
         throw AssetError{ "ufbx_generate_indices failed: unknown error" };
     }
 
-    OutVertices.Reserve(OutVertices.VertexCount() + UniqueVertexCount);
-
-    for (std::size_t VertexIndex{ 0 }; VertexIndex < UniqueVertexCount; ++VertexIndex) {
-        const PackedVertex& Packed{ CornerVertices[VertexIndex] };
-        OutVertices.Positions.push_back(Vec3{ Packed.Position[0], Packed.Position[1], Packed.Position[2] });
-        OutVertices.Normals.push_back(Vec3{ Packed.Normal[0], Packed.Normal[1], Packed.Normal[2] });
-        OutVertices.Colors.push_back(Vec4{ Packed.Color[0], Packed.Color[1], Packed.Color[2], Packed.Color[3] });
-        OutVertices.Tangents.push_back(Vec3{ Packed.Tangent[0], Packed.Tangent[1], Packed.Tangent[2] });
-        OutVertices.Bitangents.push_back(Vec3{ Packed.Bitangent[0], Packed.Bitangent[1], Packed.Bitangent[2] });
-        OutVertices.BoneIndices.push_back(UVec4{ Packed.BoneIndices[0], Packed.BoneIndices[1], Packed.BoneIndices[2], Packed.BoneIndices[3] });
-        OutVertices.BoneWeights.push_back(Vec4{ Packed.BoneWeights[0], Packed.BoneWeights[1], Packed.BoneWeights[2], Packed.BoneWeights[3] });
-        for (std::size_t SetIndex{ 0 }; SetIndex < 4; ++SetIndex) {
-            OutVertices.TexCoords[SetIndex].push_back(Vec2{ Packed.TexCoord[SetIndex][0], Packed.TexCoord[SetIndex][1] });
-        }
+    const std::size_t BaseCount{ OutVertices.VertexCount() };
+    AppendStream(OutVertices.Positions, Corners.Positions, BaseCount, UniqueVertexCount, Vec3{ 0.0f, 0.0f, 0.0f });
+    AppendStream(OutVertices.Normals, Corners.Normals, BaseCount, UniqueVertexCount, Vec3{ 0.0f, 1.0f, 0.0f });
+    for (std::size_t SetIndex{ 0 }; SetIndex < Corners.TexCoords.size(); ++SetIndex) {
+        AppendStream(OutVertices.TexCoords[SetIndex], Corners.TexCoords[SetIndex], BaseCount, UniqueVertexCount, Vec2{ 0.0f, 0.0f });
+    }
+    AppendStream(OutVertices.Colors, Corners.Colors, BaseCount, UniqueVertexCount, Vec4{ 1.0f, 1.0f, 1.0f, 1.0f });
+    AppendStream(OutVertices.Tangents, Corners.Tangents, BaseCount, UniqueVertexCount, Vec3{ 0.0f, 0.0f, 0.0f });
+    AppendStream(OutVertices.Bitangents, Corners.Bitangents, BaseCount, UniqueVertexCount, Vec3{ 0.0f, 0.0f, 0.0f });
+    AppendStream(OutVertices.BoneIndices, Corners.BoneIndices, BaseCount, UniqueVertexCount, UVec4{ 0, 0, 0, 0 });
+    AppendStream(OutVertices.BoneWeights, Corners.BoneWeights, BaseCount, UniqueVertexCount, Vec4{ 0.0f, 0.0f, 0.0f, 0.0f });
+
+    // Triangles go straight into OutIndices grouped by material: one pass
+    // counts the indices every face range contributes to each batch, a prefix
+    // sum turns the counts into write cursors, and a second pass triangulates
+    // and scatters. Batches are in ascending material order and keep face
+    // order within a batch, so the result does not depend on the range count.
+    const std::size_t SlotCount{ std::max<std::size_t>(Node.materials.count, 1) };
+    std::pmr::vector<std::size_t> SlotMaterials(SlotCount, &Scratch);
+    for (std::size_t Slot{ 0 }; Slot < SlotCount; ++Slot) {
+        SlotMaterials[Slot] = ResolveMaterialIndex(Node, Slot);
+    }
+    std::pmr::vector<std::size_t> BatchMaterials{ SlotMaterials, &Scratch };
+    std::sort(BatchMaterials.begin(), BatchMaterials.end());
+    BatchMaterials.erase(std::unique(BatchMaterials.begin(), BatchMaterials.end()), BatchMaterials.end());
+    const std::size_t BatchCount{ BatchMaterials.size() };
+    std::pmr::vector<std::uint32_t> SlotBatches(SlotCount, &Scratch);
+    for (std::size_t Slot{ 0 }; Slot < SlotCount; ++Slot) {
+        SlotBatches[Slot] = static_cast<std::uint32_t>(std::lower_bound(BatchMaterials.begin(), BatchMaterials.end(), SlotMaterials[Slot]) - BatchMaterials.begin());
     }
+    const auto FaceBatch{ [&](std::size_t FaceIndex) {
+        std::size_t Slot{ (FaceIndex < Mesh.face_material.count) ? Mesh.face_material.data[FaceIndex] : 0 };
+        if (Slot >= SlotCount) {
+            Slot = 0;
+        }
+        return SlotBatches[Slot];
+    } };
 
-    std::map<std::size_t, std::vector<std::uint32_t>> MaterialBatches{};
-    std::vector<std::uint32_t> TriCorners{};
-    TriCorners.resize(static_cast<std::size_t>(Mesh.max_face_triangles) * 3);
-    for (std::size_t FaceIndex{ 0 }; FaceIndex < Mesh.faces.count; ++FaceIndex) {
-        const ufbx_face Face{ Mesh.faces.data[FaceIndex] };
-        if (Face.num_indices < 3) {
-            continue;
+    const std::size_t FaceCount{ Mesh.faces.count };
+    std::size_t RangeCount{ 1 };
+    if (mThreadPool != nullptr && mThreadPool->GetWorkerCount() > 1) {
+        RangeCount = std::clamp<std::size_t>(FaceCount / MinFacesPerRange, 1, mThreadPool->GetWorkerCount());
+    }
+    const std::size_t FacesPerRange{ (FaceCount + RangeCount - 1) / RangeCount };
+    const auto ForEachRange{ [&](const std::function<void(std::size_t)>& Body) {
+        if (RangeCount > 1) {
+            mThreadPool->ParallelFor(RangeCount, Body);
+            return;
         }
-        const std::size_t MaterialIndex{ ResolveMaterialIndex(Node, Mesh, FaceIndex) };
-        std::vector<std::uint32_t>& MaterialIndices{ MaterialBatches[MaterialIndex] };
-        const std::uint32_t NumTris{ ufbx_triangulate_face(TriCorners.data(), TriCorners.size(), &Mesh, Face) };
-        for (std::uint32_t TriIndex{ 0 }; TriIndex < NumTris; ++TriIndex) {
-            const std::uint32_t Corner0{ TriCorners[TriIndex * 3 + 0] };
-            const std::uint32_t Corner1{ TriCorners[TriIndex * 3 + 1] };
-            const std::uint32_t Corner2{ TriCorners[TriIndex * 3 + 2] };
-            MaterialIndices.push_back(Remap[Corner0]);
-            MaterialIndices.push_back(Remap[Corner1]);
-            MaterialIndices.push_back(Remap[Corner2]);
+        Body(0);
+    } };
+
+    // Cursors[Range * BatchCount + Batch]: index count, then write position.
+    std::pmr::vector<std::size_t> Cursors(RangeCount * BatchCount, 0, &Scratch);
+    ForEachRange([&](std::size_t Range) {
+        std::size_t* Counts{ Cursors.data() + Range * BatchCount };
+        const std::size_t End{ std::min(FaceCount, (Range + 1) * FacesPerRange) };
+        for (std::size_t FaceIndex{ Range * FacesPerRange }; FaceIndex < End; ++FaceIndex) {
+            const std::uint32_t NumCorners{ Mesh.faces.data[FaceIndex].num_indices };
+            if (NumCorners >= 3) {
+                Counts[FaceBatch(FaceIndex)] += static_cast<std::size_t>(NumCorners - 2) * 3;
+            }
+        }
+    });
+
+    const std::size_t BaseIndex{ OutIndices.size() };
+    std::pmr::vector<std::size_t> BatchOffsets(BatchCount + 1, &Scratch);
+    std::size_t Offset{ BaseIndex };
+    for (std::size_t Batch{ 0 }; Batch < BatchCount; ++Batch) {
+        BatchOffsets[Batch] = Offset;
+        for (std::size_t Range{ 0 }; Range < RangeCount; ++Range) {
+            const std::size_t Count{ Cursors[Range * BatchCount + Batch] };
+            Cursors[Range * BatchCount + Batch] = Offset;
+            Offset += Count;
         }
     }
+    BatchOffsets[BatchCount] = Offset;
+    OutIndices.resize(Offset);
+
+    // Ranges run concurrently and the arena is not thread-safe, so every
+    // range gets its slice of one triangulation buffer up front.
+    const std::size_t TriCornerCount{ static_cast<std::size_t>(Mesh.max_face_triangles) * 3 };
+    std::pmr::vector<std::uint32_t> RangeTriCorners(RangeCount * TriCornerCount, &Scratch);
+    ForEachRange([&](std::size_t Range) {
+        std::size_t* Writes{ Cursors.data() + Range * BatchCount };
+        const std::span<std::uint32_t> TriCorners{ RangeTriCorners.data() + Range * TriCornerCount, TriCornerCount };
+        const std::size_t End{ std::min(FaceCount, (Range + 1) * FacesPerRange) };
+        for (std::size_t FaceIndex{ Range * FacesPerRange }; FaceIndex < End; ++FaceIndex) {
+            const ufbx_face Face{ Mesh.faces.data[FaceIndex] };
+            if (Face.num_indices < 3) {
+                continue;
+            }
+            std::size_t& Write{ Writes[FaceBatch(FaceIndex)] };
+            const std::uint32_t NumTris{ ufbx_triangulate_face(TriCorners.data(), TriCorners.size(), &Mesh, Face) };
+            for (std::size_t Corner{ 0 }; Corner < static_cast<std::size_t>(NumTris) * 3; ++Corner) {
+                OutIndices[Write + Corner] = Remap[TriCorners[Corner]];
+            }
+            Write += static_cast<std::size_t>(Face.num_indices - 2) * 3;
+        }
+    });
 
-    std::size_t IndexOffset{ 0 };
-    for (const auto& Pair : MaterialBatches) {
-        const std::vector<std::uint32_t>& BatchIndices{ Pair.second };
-        if (BatchIndices.empty()) {
+    for (std::size_t Batch{ 0 }; Batch < BatchCount; ++Batch) {
+        const std::size_t IndexCount{ BatchOffsets[Batch + 1] - BatchOffsets[Batch] };
+        if (IndexCount == 0) {
             continue;
         }
-        OutIndices.insert(OutIndices.end(), BatchIndices.begin(), BatchIndices.end());
-        ModelNode::SubMesh SubMesh{};
-        SubMesh.IndexOffset = IndexOffset;
-        SubMesh.IndexCount = BatchIndices.size();
-        SubMesh.MaterialIndex = Pair.first;
+        ModelMesh::SubMesh SubMesh{};
+        SubMesh.IndexOffset = BatchOffsets[Batch];
+        SubMesh.IndexCount = IndexCount;
+        SubMesh.MaterialIndex = BatchMaterials[Batch];
         OutSubMeshes.push_back(SubMesh);
-        IndexOffset += BatchIndices.size();
     }
 }
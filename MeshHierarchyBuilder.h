@@ -1,17 +1,28 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <unordered_map>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <utility>
 #include <vector>
 
+#include "MeshOptimizer.h"
 #include "ModelResult.h"
 #include "SceneVisitor.h"
+#include "ScratchArena.h"
+#include "ThreadPool.h"
 
 namespace asset {
     class MeshHierarchyBuilder final : public ISceneNodeVisitor {
     public:
-        explicit MeshHierarchyBuilder(ModelResult& OutResult, const std::unordered_map<const ufbx_material*, std::size_t>* MaterialLookup);
+        // Meshes are extracted after the traversal, in parallel on Pool when
+        // one is given; Pool may be null.
+        MeshHierarchyBuilder(ModelResult& OutResult, const std::vector<std::uint32_t>* MaterialIndices, ThreadPool* Pool);
         ~MeshHierarchyBuilder();
 
         MeshHierarchyBuilder(const MeshHierarchyBuilder& Other) = delete;
@@ -22,41 +33,158 @@ namespace asset {
     public:
         void OnNodeBegin(const ufbx_scene& Scene, const ufbx_node& Node, const NodeVisitContext& Context) override;
         void OnNodeEnd(const ufbx_scene& Scene, const ufbx_node& Node) override;
+        void OnSceneEnd(const ufbx_scene& Scene) override;
+
+        // When disabled, nodes keep their names and transforms but reference
+        // no mesh; used for hierarchy-only imports. Enabled by default.
+        void SetExtractMeshes(bool Enabled);
+
+        // Reorders every extracted mesh for the post-transform cache and then
+        // for vertex fetch. Off by default.
+        void SetOptimizeMeshes(bool Enabled);
+        // One entry per optimised mesh of the last OnSceneEnd, in mesh order.
+        const std::vector<VertexCacheReport>& GetVertexCacheReports() const;
+        // Splits every extracted mesh into meshlets for cluster culling, after
+        // optimisation when both are on. Off by default.
+        void SetBuildMeshlets(bool Enabled);
+        // Appends up to DefaultLodCount simplified levels per SubMesh (see
+        // SimplifyMesh), after optimisation and before meshlets. Off by
+        // default.
+        void SetBuildLods(bool Enabled);
+        // Splits meshes whose SubMeshes span more than 65535 vertices so every
+        // SubMesh can be written with 16-bit indices (see
+        // SplitForShortIndices), after optimisation and before LODs. Off by
+        // default.
+        void SetSplitForShortIndices(bool Enabled);
+
+        // Receives ImportStage::Meshes progress after every extracted mesh;
+        // may be null. Not owned. When it cancels, meshes not yet started
+        // are skipped and OnSceneEnd throws AssetError.
+        void SetProgressCallback(const ImportProgressCallback* Callback);
+
+        // Scratch memory use of the meshes extracted so far.
+        const ScratchArenaStats& GetScratchStats() const;
 
     private:
-        struct PackedVertex final {
+        // Matches the four lanes of the BoneIndices/BoneWeights streams.
+        static constexpr std::size_t MaxSkinInfluences{ 4 };
+        // Meshes with fewer faces per worker batch their triangles serially.
+        static constexpr std::size_t MinFacesPerRange{ 16384 };
+
+        // First node seen for a mesh table entry; the entry is filled from
+        // it after the traversal.
+        struct PendingMesh final {
+        public:
+            const ufbx_node* Node{ nullptr };
+            std::uint32_t MeshIndex{ ModelNode::NoMesh };
+        };
+
+        // Holds an arena from AcquireArena for one extraction and hands it
+        // back even when a stage throws.
+        class ArenaLease final {
+        public:
+            explicit ArenaLease(MeshHierarchyBuilder& Builder);
+            ~ArenaLease();
+            ArenaLease(const ArenaLease&) = delete;
+            ArenaLease& operator=(const ArenaLease&) = delete;
+
+            ScratchArena& Get() const;
+
+        private:
+            MeshHierarchyBuilder& mBuilder;
+            ScratchArena& mArena;
+        };
+
+        // Nodes that point at the same ufbx_mesh with the same material slots
+        // produce identical geometry and share one mesh table entry.
+        using MeshKey = std::pair<const ufbx_mesh*, std::vector<const ufbx_material*>>;
+
+        // Streams the source mesh actually carries. Absent ones stay empty in
+        // VertexAttributes instead of being filled with defaults, and only the
+        // present ones make up the deduplication key.
+        struct PresentAttributes final {
+        public:
+            std::array<bool, 4> TexCoords{};
+            bool Colors{ false };
+            bool Tangents{ false };
+            bool Bitangents{ false };
+            bool Skin{ false };
+        };
+
+        // Per-corner attribute columns, in scratch memory. Absent streams
+        // stay empty as in VertexAttributes.
+        struct CornerAttributes final {
+        public:
+            explicit CornerAttributes(std::pmr::memory_resource* Resource);
+
+            std::pmr::vector<Vec3> Positions;
+            std::pmr::vector<Vec3> Normals;
+            std::array<std::pmr::vector<Vec2>, 4> TexCoords;
+            std::pmr::vector<Vec4> Colors;
+            std::pmr::vector<Vec3> Tangents;
+            std::pmr::vector<Vec3> Bitangents;
+            std::pmr::vector<UVec4> BoneIndices;
+            std::pmr::vector<Vec4> BoneWeights;
+        };
+
+        // Skin influences of one control point: the strongest MaxSkinInfluences
+        // weights in decreasing order, normalised to sum to one.
+        struct SkinInfluences final {
         public:
-            float Position[3]{ 0.0f, 0.0f, 0.0f };
-            float Normal[3]{ 0.0f, 0.0f, 0.0f };
-            float TexCoord[4][2]{ { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f } };
-            float Color[4]{ 1.0f, 1.0f, 1.0f, 1.0f };
-            float Tangent[3]{ 0.0f, 0.0f, 0.0f };
-            float Bitangent[3]{ 0.0f, 0.0f, 0.0f };
-            std::uint32_t BoneIndices[4]{ 0, 0, 0, 0 };
-            float BoneWeights[4]{ 0.0f, 0.0f, 0.0f, 0.0f };
+            UVec4 Indices{};
+            Vec4 Weights{};
         };
 
     private:
-        static Vec3 ToVec3(const ufbx_vec3& Value);
-        static Vec2 ToVec2(const ufbx_vec2& Value);
-        static Vec4 ToVec4(const ufbx_vec4& Value);
+        static PresentAttributes DetectAttributes(const ufbx_mesh& Mesh, const VertexAttributes& Existing);
+
+        void GatherCorners(const ufbx_mesh& Mesh, const PresentAttributes& Present, CornerAttributes& OutCorners) const;
+
+        static std::pmr::vector<SkinInfluences> BuildSkinTable(const ufbx_mesh& Mesh, std::pmr::memory_resource* Resource);
+        // Global material index bound to one of Node's material slots.
+        std::size_t ResolveMaterialIndex(const ufbx_node& Node, std::size_t MaterialSlot) const;
+
+        // Every temporary comes from Scratch; only the outputs are heap-allocated.
+        void AppendIndexedMeshUfbx(const ufbx_node& Node, const ufbx_mesh& Mesh, VertexAttributes& OutVertices, std::vector<std::uint32_t>& OutIndices, std::vector<ModelMesh::SubMesh>& OutSubMeshes, ScratchArena& Scratch) const;
 
-        PackedVertex MakePackedVertex(const ufbx_mesh& Mesh, std::uint32_t CornerIndex) const;
+        // Runs OptimizeVertexCache on each SubMesh range, then
+        // OptimizeVertexFetch over the whole mesh. Resets Scratch as it goes.
+        static void OptimizeMesh(ModelMesh& Mesh, ScratchArena& Scratch, VertexCacheReport& OutReport);
+        // Simplifies each SubMesh level by level, every level from the one
+        // before, and stops early once a level saves less than a tenth.
+        // Levels are cache-optimised when OptimizeCache is set.
+        static void BuildLods(ModelMesh& Mesh, ScratchArena& Scratch, bool OptimizeCache);
 
-        Vec3 ReadPosition(const ufbx_mesh& Mesh, std::uint32_t Index) const;
-        Vec3 ReadNormal(const ufbx_mesh& Mesh, std::uint32_t Index) const;
-        Vec2 ReadTexCoord(const ufbx_mesh& Mesh, std::size_t SetIndex, std::uint32_t Index) const;
-        Vec4 ReadColor(const ufbx_mesh& Mesh, std::uint32_t Index) const;
-        Vec3 ReadTangent(const ufbx_mesh& Mesh, std::uint32_t Index) const;
-        Vec3 ReadBitangent(const ufbx_mesh& Mesh, std::uint32_t Index) const;
-        void ReadBoneData(const ufbx_mesh& Mesh, std::uint32_t CornerIndex, UVec4& OutIndices, Vec4& OutWeights) const;
-        std::size_t ResolveMaterialIndex(const ufbx_node& Node, const ufbx_mesh& Mesh, std::size_t FaceIndex) const;
+        // Serialises callback calls from concurrent extractions and records
+        // a cancellation in mCancelled.
+        void ReportMeshDone(std::uint64_t Corners);
 
-        void AppendIndexedMeshUfbx(const ufbx_node& Node, const ufbx_mesh& Mesh, VertexAttributes& OutVertices, std::vector<std::uint32_t>& OutIndices, std::vector<ModelNode::SubMesh>& OutSubMeshes) const;
+        // One arena per concurrently extracted mesh. Arenas are reused by
+        // later meshes and freed together with the builder.
+        ScratchArena& AcquireArena();
+        void ReleaseArena(ScratchArena& Arena);
 
     private:
         ModelResult& mResult;
         std::vector<ModelNode*> mNodeStack{};
-        const std::unordered_map<const ufbx_material*, std::size_t>* mMaterialLookup{ nullptr };
+        // MaterialVisitor's table, indexed by ufbx_material::typed_id.
+        const std::vector<std::uint32_t>* mMaterialIndices{ nullptr };
+        ThreadPool* mThreadPool{ nullptr };
+        bool mExtractMeshes{ true };
+        bool mOptimizeMeshes{ false };
+        bool mBuildMeshlets{ false };
+        bool mBuildLods{ false };
+        bool mSplitForShortIndices{ false };
+        std::vector<VertexCacheReport> mCacheReports{};
+        const ImportProgressCallback* mProgress{ nullptr };
+        std::mutex mProgressMutex{};
+        ImportProgress mMeshProgress{};
+        std::atomic<bool> mCancelled{ false };
+        std::vector<PendingMesh> mPendingMeshes{};
+        std::map<MeshKey, std::uint32_t> mMeshLookup{};
+        std::mutex mArenaMutex{};
+        std::vector<std::unique_ptr<ScratchArena>> mArenas{};
+        std::vector<ScratchArena*> mFreeArenas{};
+        ScratchArenaStats mScratchStats{};
     };
 }
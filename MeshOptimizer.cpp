@@ -0,0 +1,340 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+using namespace asset;
+
+namespace {
+    // Forsyth's tuning: vertex scores see a 32-entry LRU cache, the three
+    // vertices of the last triangle score a flat 0.75 so the next triangle
+    // does not simply reuse its edge, and low-valence vertices get a boost so
+    // lone triangles are not left behind.
+    constexpr std::size_t ScoringCacheSize{ 32 };
+    constexpr float CacheDecayPower{ 1.5f };
+    constexpr float LastTriangleScore{ 0.75f };
+    constexpr float ValenceBoostScale{ 2.0f };
+    constexpr float ValenceBoostPower{ 0.5f };
+    constexpr std::size_t ValenceTableSize{ 64 };
+    constexpr std::uint32_t NoTriangle{ 0xFFFFFFFFu };
+    constexpr std::uint32_t NoVertex{ 0xFFFFFFFFu };
+
+    struct ScoreTables final {
+    public:
+        std::array<float, ScoringCacheSize> Cache{};
+        std::array<float, ValenceTableSize> Valence{};
+    };
+
+    ScoreTables BuildScoreTables() {
+        ScoreTables Tables{};
+        for (std::size_t Position{ 0 }; Position < ScoringCacheSize; ++Position) {
+            if (Position < 3) {
+                Tables.Cache[Position] = LastTriangleScore;
+                continue;
+            }
+            const float Scale{ 1.0f / static_cast<float>(ScoringCacheSize - 3) };
+            Tables.Cache[Position] = std::pow(1.0f - static_cast<float>(Position - 3) * Scale, CacheDecayPower);
+        }
+        for (std::size_t Valence{ 1 }; Valence < ValenceTableSize; ++Valence) {
+            Tables.Valence[Valence] = ValenceBoostScale * std::pow(static_cast<float>(Valence), -ValenceBoostPower);
+        }
+        return Tables;
+    }
+
+    const ScoreTables& GetScoreTables() {
+        static const ScoreTables Tables{ BuildScoreTables() };
+        return Tables;
+    }
+
+    float VertexScore(const ScoreTables& Tables, std::int32_t CachePosition, std::uint32_t LiveTriangles) {
+        if (LiveTriangles == 0) {
+            return -1.0f;
+        }
+        float Score{ Tables.Valence[std::min<std::size_t>(LiveTriangles, ValenceTableSize - 1)] };
+        if (CachePosition >= 0) {
+            Score += Tables.Cache[static_cast<std::size_t>(CachePosition)];
+        }
+        return Score;
+    }
+
+    template <typename T>
+    void PermuteStream(std::vector<T>& Stream, const std::pmr::vector<std::uint32_t>& NewIndices, std::pmr::memory_resource* Resource) {
+        if (Stream.empty()) {
+            return;
+        }
+        const std::pmr::vector<T> Original{ Stream.begin(), Stream.end(), Resource };
+        for (std::size_t Vertex{ 0 }; Vertex < Original.size(); ++Vertex) {
+            Stream[NewIndices[Vertex]] = Original[Vertex];
+        }
+    }
+
+    // Replaces Stream with one element per entry of Sources, copied from the
+    // original element it names.
+    template <typename T>
+    void GatherStream(std::vector<T>& Stream, const std::pmr::vector<std::uint32_t>& Sources, std::pmr::memory_resource* Resource) {
+        if (Stream.empty()) {
+            return;
+        }
+        const std::pmr::vector<T> Original{ Stream.begin(), Stream.end(), Resource };
+        Stream.resize(Sources.size());
+        for (std::size_t Vertex{ 0 }; Vertex < Sources.size(); ++Vertex) {
+            Stream[Vertex] = Original[Sources[Vertex]];
+        }
+    }
+
+    bool SpansShortIndexLimit(const std::vector<std::uint32_t>& Indices, const ModelMesh::SubMesh& SubMesh) {
+        if (SubMesh.IndexCount == 0) {
+            return false;
+        }
+        const auto First{ Indices.begin() + static_cast<std::ptrdiff_t>(SubMesh.IndexOffset) };
+        const auto [Low, High]{ std::minmax_element(First, First + static_cast<std::ptrdiff_t>(SubMesh.IndexCount)) };
+        return static_cast<std::size_t>(*High - *Low) >= ShortIndexVertexLimit;
+    }
+}
+
+namespace asset {
+    VertexCacheStats AnalyzeVertexCache(std::span<const std::uint32_t> Indices, std::size_t VertexCount, std::size_t CacheSize, std::pmr::memory_resource* Resource) {
+        VertexCacheStats Stats{};
+        if (Indices.size() < 3 || VertexCount == 0) {
+            return Stats;
+        }
+        // A vertex is still cached when fewer than CacheSize misses happened
+        // since its own; the timestamps start high enough that nothing is.
+        std::pmr::vector<std::size_t> MissTimes(VertexCount, 0, Resource);
+        std::size_t Time{ CacheSize + 1 };
+        std::size_t Misses{ 0 };
+        for (const std::uint32_t Index : Indices) {
+            if (Time - MissTimes[Index] > CacheSize) {
+                MissTimes[Index] = Time++;
+                ++Misses;
+            }
+        }
+        Stats.Acmr = static_cast<double>(Misses) / static_cast<double>(Indices.size() / 3);
+        Stats.Atvr = static_cast<double>(Misses) / static_cast<double>(VertexCount);
+        return Stats;
+    }
+
+    void OptimizeVertexCache(std::span<std::uint32_t> Indices, std::pmr::memory_resource* Resource) {
+        const std::size_t TriangleCount{ Indices.size() / 3 };
+        if (TriangleCount < 2) {
+            return;
+        }
+        const ScoreTables& Tables{ GetScoreTables() };
+
+        // Work on a dense local numbering of the vertices this range uses, so
+        // the cost follows the range and not the whole mesh's vertex count.
+        std::pmr::vector<std::uint32_t> UsedVertices{ Indices.begin(), Indices.begin() + TriangleCount * 3, Resource };
+        std::sort(UsedVertices.begin(), UsedVertices.end());
+        UsedVertices.erase(std::unique(UsedVertices.begin(), UsedVertices.end()), UsedVertices.end());
+        const std::size_t VertexCount{ UsedVertices.size() };
+        std::pmr::vector<std::uint32_t> LocalIndices(TriangleCount * 3, Resource);
+        for (std::size_t Corner{ 0 }; Corner < TriangleCount * 3; ++Corner) {
+            LocalIndices[Corner] = static_cast<std::uint32_t>(std::lower_bound(UsedVertices.begin(), UsedVertices.end(), Indices[Corner]) - UsedVertices.begin());
+        }
+
+        // Live triangles of every vertex, packed per vertex; the live ones
+        // are kept at the front of each vertex's slice.
+        std::pmr::vector<std::uint32_t> LiveTriangles(VertexCount, 0, Resource);
+        for (std::size_t Corner{ 0 }; Corner < TriangleCount * 3; ++Corner) {
+            ++LiveTriangles[LocalIndices[Corner]];
+        }
+        std::pmr::vector<std::size_t> AdjacencyOffsets(VertexCount + 1, 0, Resource);
+        for (std::size_t Vertex{ 0 }; Vertex < VertexCount; ++Vertex) {
+            AdjacencyOffsets[Vertex + 1] = AdjacencyOffsets[Vertex] + LiveTriangles[Vertex];
+        }
+        std::pmr::vector<std::uint32_t> Adjacency(TriangleCount * 3, Resource);
+        {
+            std::pmr::vector<std::size_t> Fill{ AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1, Resource };
+            for (std::size_t Corner{ 0 }; Corner < TriangleCount * 3; ++Corner) {
+                Adjacency[Fill[LocalIndices[Corner]]++] = static_cast<std::uint32_t>(Corner / 3);
+            }
+        }
+
+        std::pmr::vector<std::int32_t> CachePositions(VertexCount, -1, Resource);
+        std::pmr::vector<float> VertexScores(VertexCount, Resource);
+        for (std::size_t Vertex{ 0 }; Vertex < VertexCount; ++Vertex) {
+            VertexScores[Vertex] = VertexScore(Tables, -1, LiveTriangles[Vertex]);
+        }
+        std::uint32_t BestTriangle{ 0 };
+        float BestScore{ -1.0f };
+        for (std::size_t Triangle{ 0 }; Triangle < TriangleCount; ++Triangle) {
+            const std::uint32_t* Corners{ LocalIndices.data() + Triangle * 3 };
+            const float Score{ VertexScores[Corners[0]] + VertexScores[Corners[1]] + VertexScores[Corners[2]] };
+            if (Score > BestScore) {
+                BestScore = Score;
+                BestTriangle = static_cast<std::uint32_t>(Triangle);
+            }
+        }
+
+        std::pmr::vector<std::uint8_t> Emitted(TriangleCount, 0, Resource);
+        std::pmr::vector<std::uint32_t> Output(TriangleCount * 3, Resource);
+        std::array<std::uint32_t, ScoringCacheSize + 3> Cache{};
+        std::array<std::uint32_t, ScoringCacheSize + 3> NextCache{};
+        std::size_t CacheCount{ 0 };
+        std::size_t FallbackCursor{ 0 };
+
+        for (std::size_t OutTriangle{ 0 }; OutTriangle < TriangleCount; ++OutTriangle) {
+            // Nothing in the cache has live triangles left: continue with the
+            // next unemitted triangle in input order.
+            if (BestTriangle == NoTriangle) {
+                while (Emitted[FallbackCursor] != 0) {
+                    ++FallbackCursor;
+                }
+                BestTriangle = static_cast<std::uint32_t>(FallbackCursor);
+            }
+            const std::uint32_t* Corners{ LocalIndices.data() + static_cast<std::size_t>(BestTriangle) * 3 };
+            std::copy_n(Indices.data() + static_cast<std::size_t>(BestTriangle) * 3, 3, Output.data() + OutTriangle * 3);
+            Emitted[BestTriangle] = 1;
+
+            std::size_t NextCount{ 0 };
+            for (std::size_t Corner{ 0 }; Corner < 3; ++Corner) {
+                const std::uint32_t Vertex{ Corners[Corner] };
+                std::uint32_t* Live{ Adjacency.data() + AdjacencyOffsets[Vertex] };
+                std::uint32_t* LiveEnd{ Live + LiveTriangles[Vertex] };
+                std::uint32_t* Found{ std::find(Live, LiveEnd, BestTriangle) };
+                if (Found != LiveEnd) {
+                    *Found = *(LiveEnd - 1);
+                    --LiveTriangles[Vertex];
+                }
+                if (std::find(NextCache.begin(), NextCache.begin() + NextCount, Vertex) == NextCache.begin() + NextCount) {
+                    NextCache[NextCount++] = Vertex;
+                }
+            }
+            for (std::size_t Slot{ 0 }; Slot < CacheCount; ++Slot) {
+                const std::uint32_t Vertex{ Cache[Slot] };
+                if (Vertex != Corners[0] && Vertex != Corners[1] && Vertex != Corners[2]) {
+                    NextCache[NextCount++] = Vertex;
+                }
+            }
+
+            // Rescore every vertex that entered, moved or dropped out, and the
+            // live triangles around them; the best of those goes next.
+            for (std::size_t Slot{ 0 }; Slot < NextCount; ++Slot) {
+                const std::uint32_t Vertex{ NextCache[Slot] };
+                CachePositions[Vertex] = (Slot < ScoringCacheSize) ? static_cast<std::int32_t>(Slot) : -1;
+                VertexScores[Vertex] = VertexScore(Tables, CachePositions[Vertex], LiveTriangles[Vertex]);
+            }
+            BestTriangle = NoTriangle;
+            BestScore = -1.0f;
+            for (std::size_t Slot{ 0 }; Slot < NextCount; ++Slot) {
+                const std::uint32_t Vertex{ NextCache[Slot] };
+                const std::uint32_t* Live{ Adjacency.data() + AdjacencyOffsets[Vertex] };
+                for (std::uint32_t Entry{ 0 }; Entry < LiveTriangles[Vertex]; ++Entry) {
+                    const std::uint32_t Triangle{ Live[Entry] };
+                    const std::uint32_t* TriangleCorners{ LocalIndices.data() + static_cast<std::size_t>(Triangle) * 3 };
+                    const float Score{ VertexScores[TriangleCorners[0]] + VertexScores[TriangleCorners[1]] + VertexScores[TriangleCorners[2]] };
+                    if (Score > BestScore) {
+                        BestScore = Score;
+                        BestTriangle = Triangle;
+                    }
+                }
+            }
+            CacheCount = std::min(NextCount, ScoringCacheSize);
+            std::copy(NextCache.begin(), NextCache.begin() + CacheCount, Cache.begin());
+        }
+        std::copy(Output.begin(), Output.end(), Indices.begin());
+    }
+
+    void OptimizeVertexFetch(VertexAttributes& Vertices, std::span<std::uint32_t> Indices, std::pmr::memory_resource* Resource) {
+        const std::size_t VertexCount{ Vertices.VertexCount() };
+        std::pmr::vector<std::uint32_t> NewIndices(VertexCount, NoVertex, Resource);
+        std::uint32_t NextIndex{ 0 };
+        for (std::uint32_t& Index : Indices) {
+            if (NewIndices[Index] == NoVertex) {
+                NewIndices[Index] = NextIndex++;
+            }
+            Index = NewIndices[Index];
+        }
+        for (std::uint32_t& NewIndex : NewIndices) {
+            if (NewIndex == NoVertex) {
+                NewIndex = NextIndex++;
+            }
+        }
+
+        PermuteStream(Vertices.Positions, NewIndices, Resource);
+        PermuteStream(Vertices.Normals, NewIndices, Resource);
+        for (std::vector<Vec2>& TexCoords : Vertices.TexCoords) {
+            PermuteStream(TexCoords, NewIndices, Resource);
+        }
+        PermuteStream(Vertices.Colors, NewIndices, Resource);
+        PermuteStream(Vertices.Tangents, NewIndices, Resource);
+        PermuteStream(Vertices.Bitangents, NewIndices, Resource);
+        PermuteStream(Vertices.BoneIndices, NewIndices, Resource);
+        PermuteStream(Vertices.BoneWeights, NewIndices, Resource);
+    }
+
+    bool SplitForShortIndices(ModelMesh& Mesh, std::pmr::memory_resource* Resource) {
+        std::vector<std::uint32_t>& Indices{ Mesh.Indices() };
+        const std::vector<ModelMesh::SubMesh>& SubMeshes{ Mesh.GetSubMeshes() };
+        if (std::none_of(SubMeshes.begin(), SubMeshes.end(), [&](const ModelMesh::SubMesh& SubMesh) { return SpansShortIndexLimit(Indices, SubMesh); })) {
+            return false;
+        }
+
+        // Sources maps every new vertex to the one it copies; Local maps an
+        // original vertex to its copy in the current block.
+        std::pmr::vector<std::uint32_t> Local(Mesh.Vertices().VertexCount(), NoVertex, Resource);
+        std::pmr::vector<std::uint32_t> Sources{ Resource };
+        std::pmr::vector<std::uint32_t> NewIndices{ Resource };
+        NewIndices.reserve(Indices.size());
+        std::vector<ModelMesh::SubMesh> NewSubMeshes{};
+        std::size_t BlockBegin{ 0 };
+        ModelMesh::SubMesh Block{};
+        const auto CloseBlock{ [&]() {
+            Block.IndexCount = NewIndices.size() - Block.IndexOffset;
+            if (Block.IndexCount > 0) {
+                NewSubMeshes.push_back(Block);
+            }
+            for (std::size_t Vertex{ BlockBegin }; Vertex < Sources.size(); ++Vertex) {
+                Local[Sources[Vertex]] = NoVertex;
+            }
+            BlockBegin = Sources.size();
+            Block.IndexOffset = NewIndices.size();
+        } };
+        for (const ModelMesh::SubMesh& SubMesh : SubMeshes) {
+            CloseBlock();
+            Block.MaterialIndex = SubMesh.MaterialIndex;
+            const std::size_t End{ SubMesh.IndexOffset + SubMesh.IndexCount };
+            for (std::size_t Offset{ SubMesh.IndexOffset }; Offset < End; Offset += 3) {
+                const std::size_t CornerCount{ std::min<std::size_t>(3, End - Offset) };
+                std::array<std::uint32_t, 3> Corners{};
+                std::size_t Added{ 0 };
+                for (std::size_t Corner{ 0 }; Corner < CornerCount; ++Corner) {
+                    Corners[Corner] = static_cast<std::uint32_t>(Indices[Offset + Corner] + SubMesh.BaseVertex);
+                    const bool Repeated{ (Corner > 0 && Corners[Corner] == Corners[0]) || (Corner > 1 && Corners[Corner] == Corners[1]) };
+                    Added += (Local[Corners[Corner]] == NoVertex && !Repeated) ? 1 : 0;
+                }
+                if (Sources.size() - BlockBegin + Added > ShortIndexVertexLimit) {
+                    CloseBlock();
+                }
+                for (std::size_t Corner{ 0 }; Corner < CornerCount; ++Corner) {
+                    std::uint32_t& Copy{ Local[Corners[Corner]] };
+                    if (Copy == NoVertex) {
+                        Copy = static_cast<std::uint32_t>(Sources.size());
+                        Sources.push_back(Corners[Corner]);
+                    }
+                    NewIndices.push_back(Copy);
+                }
+            }
+        }
+        CloseBlock();
+
+        VertexAttributes& Vertices{ Mesh.Vertices() };
+        GatherStream(Vertices.Positions, Sources, Resource);
+        GatherStream(Vertices.Normals, Sources, Resource);
+        for (std::vector<Vec2>& TexCoords : Vertices.TexCoords) {
+            GatherStream(TexCoords, Sources, Resource);
+        }
+        GatherStream(Vertices.Colors, Sources, Resource);
+        GatherStream(Vertices.Tangents, Sources, Resource);
+        GatherStream(Vertices.Bitangents, Sources, Resource);
+        GatherStream(Vertices.BoneIndices, Sources, Resource);
+        GatherStream(Vertices.BoneWeights, Sources, Resource);
+        Indices.assign(NewIndices.begin(), NewIndices.end());
+        Mesh.SetSubMeshes(std::move(NewSubMeshes));
+        Mesh.Lods().clear();
+        Mesh.Meshlets().clear();
+        return true;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string>
+
+#include "Common.h"
+#include "ModelResult.h"
+
+namespace asset {
+    // Post-transform cache behaviour of a triangle list, simulated with a
+    // FIFO cache of CacheSize entries. ACMR is vertex shader invocations per
+    // triangle (0.5 at best for a regular grid, 3 at worst); ATVR is
+    // invocations per vertex (1 at best).
+    struct VertexCacheStats final {
+    public:
+        double Acmr{ 0.0 };
+        double Atvr{ 0.0 };
+    };
+
+    constexpr std::size_t DefaultVertexCacheSize{ 16 };
+
+    // Before and after figures of one optimised mesh, named after the first
+    // node that references it.
+    struct VertexCacheReport final {
+    public:
+        std::string NodeName{};
+        std::uint32_t MeshIndex{ 0 };
+        std::size_t TriangleCount{ 0 };
+        VertexCacheStats Before{};
+        VertexCacheStats After{};
+    };
+
+    VertexCacheStats AnalyzeVertexCache(std::span<const std::uint32_t> Indices, std::size_t VertexCount, std::size_t CacheSize, std::pmr::memory_resource* Resource);
+
+    // Reorders the triangles of Indices in place for the post-transform cache
+    // with Forsyth's linear-speed greedy scheme. The set of triangles and their
+    // winding are unchanged. Call it once per SubMesh range so batches stay
+    // contiguous; temporaries scale with the range, not the mesh.
+    void OptimizeVertexCache(std::span<std::uint32_t> Indices, std::pmr::memory_resource* Resource);
+
+    // Renumbers vertices in order of first use in Indices and permutes every
+    // present stream to match, so vertex fetch walks memory forward. Vertices
+    // no index refers to keep their relative order after the used ones.
+    void OptimizeVertexFetch(VertexAttributes& Vertices, std::span<std::uint32_t> Indices, std::pmr::memory_resource* Resource);
+
+    // Most vertices one SubMesh may span to be drawn with 16-bit indices.
+    constexpr std::size_t ShortIndexVertexLimit{ 65536 };
+
+    // Splits every SubMesh into consecutive SubMeshes of the same material
+    // whose triangles use at most ShortIndexVertexLimit vertices, and lays
+    // the vertices out in one contiguous block per SubMesh, in order of first
+    // use. Vertices shared across blocks are duplicated, vertices no SubMesh
+    // uses are dropped and triangle order is kept. Run it after
+    // optimisation and before LODs and meshlets, whose ranges it would
+    // invalidate; existing ones are cleared. Returns false and leaves the
+    // mesh alone when no SubMesh spans more than the limit or there are no
+    // SubMeshes.
+    bool SplitForShortIndices(ModelMesh& Mesh, std::pmr::memory_resource* Resource);
+}
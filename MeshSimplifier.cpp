@@ -0,0 +1,468 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace asset;
+
+namespace {
+    constexpr std::uint32_t NoVertex{ 0xFFFFFFFFu };
+    // More than one open edge leaves or enters the vertex.
+    constexpr std::uint32_t ManyVertices{ 0xFFFFFFFEu };
+    // Open edges weigh this much more than faces so outlines, seams and
+    // material boundaries keep their shape.
+    constexpr double BoundaryWeight{ 10.0 };
+    // A pass accepts collapses up to this factor above the error of the one
+    // that would just reach its goal, since many cheaper collapses are
+    // blocked by a neighbour collapsing in the same pass.
+    constexpr double PassErrorSlack{ 1.5 };
+    // A collapse may leave a triangle's normal at most 60 degrees from both
+    // its normal before the collapse and its normal in the input.
+    constexpr double MinNormalCosine{ 0.5 };
+
+    enum class VertexKind : std::uint8_t {
+        // Interior vertex with a position of its own; collapses onto any
+        // neighbour.
+        Manifold,
+        // On one open boundary loop; only slides along it.
+        Border,
+        // One of two vertices sharing a position across an attribute seam;
+        // slides along the seam together with its twin.
+        Seam,
+        // Never moves: border corners, seam ends, non-manifold fans.
+        Locked,
+    };
+
+    struct Quadric final {
+    public:
+        double A00{ 0.0 };
+        double A11{ 0.0 };
+        double A22{ 0.0 };
+        double A01{ 0.0 };
+        double A02{ 0.0 };
+        double A12{ 0.0 };
+        double B0{ 0.0 };
+        double B1{ 0.0 };
+        double B2{ 0.0 };
+        double C{ 0.0 };
+        double Weight{ 0.0 };
+    };
+
+    struct EdgeCollapse final {
+    public:
+        std::uint32_t From{ 0 };
+        std::uint32_t To{ 0 };
+        double Error{ 0.0 };
+    };
+
+    // Per-vertex lists packed into one array, rebuilt every pass.
+    struct VertexLists final {
+    public:
+        explicit VertexLists(std::pmr::memory_resource* Resource)
+            : Offsets{ Resource },
+            Items{ Resource } {
+        }
+
+        std::pmr::vector<std::uint32_t> Offsets;
+        std::pmr::vector<std::uint32_t> Items;
+    };
+
+    Vec3 Subtract(const Vec3& A, const Vec3& B) {
+        return Vec3{ A.mX - B.mX, A.mY - B.mY, A.mZ - B.mZ };
+    }
+
+    Vec3 Cross(const Vec3& A, const Vec3& B) {
+        return Vec3{ (A.mY * B.mZ) - (A.mZ * B.mY), (A.mZ * B.mX) - (A.mX * B.mZ), (A.mX * B.mY) - (A.mY * B.mX) };
+    }
+
+    double Dot(const Vec3& A, const Vec3& B) {
+        return (static_cast<double>(A.mX) * B.mX) + (static_cast<double>(A.mY) * B.mY) + (static_cast<double>(A.mZ) * B.mZ);
+    }
+
+    // Adds the squared distance to the plane N.P + D = 0, with N unit length.
+    void AddPlane(Quadric& Q, double NX, double NY, double NZ, double D, double Weight) {
+        Q.A00 += Weight * NX * NX;
+        Q.A11 += Weight * NY * NY;
+        Q.A22 += Weight * NZ * NZ;
+        Q.A01 += Weight * NX * NY;
+        Q.A02 += Weight * NX * NZ;
+        Q.A12 += Weight * NY * NZ;
+        Q.B0 += Weight * NX * D;
+        Q.B1 += Weight * NY * D;
+        Q.B2 += Weight * NZ * D;
+        Q.C += Weight * D * D;
+        Q.Weight += Weight;
+    }
+
+    void AddQuadric(Quadric& Target, const Quadric& Source) {
+        Target.A00 += Source.A00;
+        Target.A11 += Source.A11;
+        Target.A22 += Source.A22;
+        Target.A01 += Source.A01;
+        Target.A02 += Source.A02;
+        Target.A12 += Source.A12;
+        Target.B0 += Source.B0;
+        Target.B1 += Source.B1;
+        Target.B2 += Source.B2;
+        Target.C += Source.C;
+        Target.Weight += Source.Weight;
+    }
+
+    // Weighted mean squared distance from P to the planes of Q.
+    double Evaluate(const Quadric& Q, const Vec3& P) {
+        if (Q.Weight <= 0.0) {
+            return 0.0;
+        }
+        const double X{ P.mX };
+        const double Y{ P.mY };
+        const double Z{ P.mZ };
+        const double Value{ (Q.A00 * X * X) + (Q.A11 * Y * Y) + (Q.A22 * Z * Z)
+            + 2.0 * ((Q.A01 * X * Y) + (Q.A02 * X * Z) + (Q.A12 * Y * Z))
+            + 2.0 * ((Q.B0 * X) + (Q.B1 * Y) + (Q.B2 * Z)) + Q.C };
+        return std::abs(Value) / Q.Weight;
+    }
+
+    // Outgoing half-edge targets of every vertex (PerTriangle false), or the
+    // triangles around every vertex (PerTriangle true).
+    void BuildLists(const std::pmr::vector<std::uint32_t>& Indices, std::size_t VertexCount, bool PerTriangle, VertexLists& Lists) {
+        Lists.Offsets.assign(VertexCount + 1, 0);
+        for (const std::uint32_t Vertex : Indices) {
+            ++Lists.Offsets[Vertex + 1];
+        }
+        std::partial_sum(Lists.Offsets.begin(), Lists.Offsets.end(), Lists.Offsets.begin());
+        Lists.Items.resize(Indices.size());
+        for (std::size_t Corner{ 0 }; Corner < Indices.size(); ++Corner) {
+            const std::size_t Next{ (Corner % 3 == 2) ? Corner - 2 : Corner + 1 };
+            Lists.Items[Lists.Offsets[Indices[Corner]]++] = PerTriangle ? static_cast<std::uint32_t>(Corner / 3) : Indices[Next];
+        }
+        // The fill advanced every offset to the start of the next vertex.
+        for (std::size_t Vertex{ VertexCount }; Vertex > 0; --Vertex) {
+            Lists.Offsets[Vertex] = Lists.Offsets[Vertex - 1];
+        }
+        Lists.Offsets[0] = 0;
+    }
+
+    bool HasEdge(const VertexLists& Edges, std::uint32_t From, std::uint32_t To) {
+        const auto Begin{ Edges.Items.begin() + Edges.Offsets[From] };
+        const auto End{ Edges.Items.begin() + Edges.Offsets[From + 1] };
+        return std::find(Begin, End, To) != End;
+    }
+
+    void NoteOpenEdge(std::uint32_t& Slot, std::uint32_t Vertex) {
+        Slot = (Slot == NoVertex) ? Vertex : ManyVertices;
+    }
+
+    bool IsSingle(std::uint32_t Vertex) {
+        return Vertex < ManyVertices;
+    }
+}
+
+namespace asset {
+    std::size_t SimplifyMesh(std::span<std::uint32_t> Indices, std::span<const Vec3> Positions, std::size_t TargetIndexCount, float& OutError, std::pmr::memory_resource* Resource) {
+        OutError = 0.0f;
+        const std::size_t IndexCount{ Indices.size() - Indices.size() % 3 };
+        const std::size_t Target{ TargetIndexCount - TargetIndexCount % 3 };
+        if (IndexCount <= Target) {
+            return IndexCount;
+        }
+
+        // Dense local numbering of the vertices the range uses, as in
+        // OptimizeVertexCache.
+        std::pmr::vector<std::uint32_t> UsedVertices{ Indices.begin(), Indices.begin() + IndexCount, Resource };
+        std::sort(UsedVertices.begin(), UsedVertices.end());
+        UsedVertices.erase(std::unique(UsedVertices.begin(), UsedVertices.end()), UsedVertices.end());
+        const std::size_t VertexCount{ UsedVertices.size() };
+        std::pmr::vector<std::uint32_t> Working(IndexCount, Resource);
+        for (std::size_t Corner{ 0 }; Corner < IndexCount; ++Corner) {
+            Working[Corner] = static_cast<std::uint32_t>(std::lower_bound(UsedVertices.begin(), UsedVertices.end(), Indices[Corner]) - UsedVertices.begin());
+        }
+        std::pmr::vector<Vec3> Points(VertexCount, Resource);
+        for (std::size_t Vertex{ 0 }; Vertex < VertexCount; ++Vertex) {
+            Points[Vertex] = Positions[UsedVertices[Vertex]];
+        }
+
+        // Remap[v] is the first vertex at v's position; Wedge links the
+        // vertices at one position into a ring.
+        std::pmr::vector<std::uint32_t> Remap(VertexCount, Resource);
+        std::pmr::vector<std::uint32_t> Wedge(VertexCount, Resource);
+        {
+            std::pmr::vector<std::uint32_t> Order(VertexCount, Resource);
+            std::iota(Order.begin(), Order.end(), 0u);
+            const auto Less = [&](std::uint32_t A, std::uint32_t B) {
+                const Vec3& PA{ Points[A] };
+                const Vec3& PB{ Points[B] };
+                if (PA.mX != PB.mX) {
+                    return PA.mX < PB.mX;
+                }
+                if (PA.mY != PB.mY) {
+                    return PA.mY < PB.mY;
+                }
+                if (PA.mZ != PB.mZ) {
+                    return PA.mZ < PB.mZ;
+                }
+                return A < B;
+            };
+            std::sort(Order.begin(), Order.end(), Less);
+            std::size_t GroupBegin{ 0 };
+            for (std::size_t Index{ 1 }; Index <= VertexCount; ++Index) {
+                if (Index < VertexCount) {
+                    const Vec3& First{ Points[Order[GroupBegin]] };
+                    const Vec3& Current{ Points[Order[Index]] };
+                    if (First.mX == Current.mX && First.mY == Current.mY && First.mZ == Current.mZ) {
+                        continue;
+                    }
+                }
+                for (std::size_t Member{ GroupBegin }; Member < Index; ++Member) {
+                    Remap[Order[Member]] = Order[GroupBegin];
+                    Wedge[Order[Member]] = Order[(Member + 1 < Index) ? Member + 1 : GroupBegin];
+                }
+                GroupBegin = Index;
+            }
+        }
+
+        // Open edges have no opposite half-edge. OpenOut/OpenIn hold the
+        // boundary neighbour of every vertex on exactly one boundary loop.
+        VertexLists Edges{ Resource };
+        VertexLists Triangles{ Resource };
+        BuildLists(Working, VertexCount, false, Edges);
+        std::pmr::vector<std::uint32_t> OpenOut(VertexCount, NoVertex, Resource);
+        std::pmr::vector<std::uint32_t> OpenIn(VertexCount, NoVertex, Resource);
+        for (std::size_t Corner{ 0 }; Corner < IndexCount; ++Corner) {
+            const std::uint32_t From{ Working[Corner] };
+            const std::uint32_t To{ Working[(Corner % 3 == 2) ? Corner - 2 : Corner + 1] };
+            if (!HasEdge(Edges, To, From)) {
+                NoteOpenEdge(OpenOut[From], To);
+                NoteOpenEdge(OpenIn[To], From);
+            }
+        }
+
+        std::pmr::vector<VertexKind> Kinds(VertexCount, VertexKind::Locked, Resource);
+        for (std::uint32_t Vertex{ 0 }; Vertex < VertexCount; ++Vertex) {
+            const std::uint32_t Twin{ Wedge[Vertex] };
+            if (Twin == Vertex) {
+                if (OpenOut[Vertex] == NoVertex && OpenIn[Vertex] == NoVertex) {
+                    Kinds[Vertex] = VertexKind::Manifold;
+                }
+                else if (IsSingle(OpenOut[Vertex]) && IsSingle(OpenIn[Vertex])) {
+                    Kinds[Vertex] = VertexKind::Border;
+                }
+                continue;
+            }
+            // A seam: both sides are open, and each side's boundary runs to
+            // the positions the other side's runs from.
+            if (Wedge[Twin] == Vertex && IsSingle(OpenOut[Vertex]) && IsSingle(OpenIn[Vertex]) && IsSingle(OpenOut[Twin]) && IsSingle(OpenIn[Twin])
+                && Remap[OpenOut[Vertex]] == Remap[OpenIn[Twin]] && Remap[OpenIn[Vertex]] == Remap[OpenOut[Twin]]) {
+                Kinds[Vertex] = VertexKind::Seam;
+            }
+        }
+
+        // Normals keeps each surviving triangle's input normal, so turns
+        // that each pass the per-step limit cannot add up to a flip.
+        std::pmr::vector<Quadric> Quadrics(VertexCount, Resource);
+        std::pmr::vector<Vec3> Normals(IndexCount / 3, Resource);
+        for (std::size_t Corner{ 0 }; Corner < IndexCount; Corner += 3) {
+            const std::uint32_t* Triangle{ Working.data() + Corner };
+            const Vec3& P0{ Points[Triangle[0]] };
+            const Vec3 Normal{ Cross(Subtract(Points[Triangle[1]], P0), Subtract(Points[Triangle[2]], P0)) };
+            Normals[Corner / 3] = Normal;
+            const double Length{ std::sqrt(Dot(Normal, Normal)) };
+            if (Length <= 0.0) {
+                continue;
+            }
+            const double NX{ Normal.mX / Length };
+            const double NY{ Normal.mY / Length };
+            const double NZ{ Normal.mZ / Length };
+            const double D{ -((NX * P0.mX) + (NY * P0.mY) + (NZ * P0.mZ)) };
+            for (std::size_t Offset{ 0 }; Offset < 3; ++Offset) {
+                AddPlane(Quadrics[Remap[Triangle[Offset]]], NX, NY, NZ, D, Length * 0.5);
+            }
+            // Open edges also get a plane through the edge, perpendicular to
+            // the face, so moving off the boundary costs as much as leaving
+            // the surface.
+            for (std::size_t Offset{ 0 }; Offset < 3; ++Offset) {
+                const std::uint32_t From{ Triangle[Offset] };
+                const std::uint32_t To{ Triangle[(Offset + 1) % 3] };
+                if (HasEdge(Edges, To, From)) {
+                    continue;
+                }
+                const Vec3 Edge{ Subtract(Points[To], Points[From]) };
+                const Vec3 Side{ Cross(Edge, Vec3{ static_cast<float>(NX), static_cast<float>(NY), static_cast<float>(NZ) }) };
+                const double SideLength{ std::sqrt(Dot(Side, Side)) };
+                if (SideLength <= 0.0) {
+                    continue;
+                }
+                const double SX{ Side.mX / SideLength };
+                const double SY{ Side.mY / SideLength };
+                const double SZ{ Side.mZ / SideLength };
+                const double SD{ -((SX * Points[From].mX) + (SY * Points[From].mY) + (SZ * Points[From].mZ)) };
+                const double Weight{ Dot(Edge, Edge) * BoundaryWeight };
+                AddPlane(Quadrics[Remap[From]], SX, SY, SZ, SD, Weight);
+                AddPlane(Quadrics[Remap[To]], SX, SY, SZ, SD, Weight);
+            }
+        }
+
+        // The seam twin's collapse target for From -> To: the neighbour of
+        // From's twin that lies at To's position on the other side.
+        const auto TwinTarget = [&](std::uint32_t From, std::uint32_t To) {
+            const std::uint32_t Twin{ Wedge[From] };
+            const std::uint32_t Candidate{ (OpenOut[From] == To) ? OpenIn[Twin] : OpenOut[Twin] };
+            return (IsSingle(Candidate) && Remap[Candidate] == Remap[To] && Candidate != To) ? Candidate : NoVertex;
+        };
+        const auto CanCollapse = [&](std::uint32_t From, std::uint32_t To) {
+            if (Remap[From] == Remap[To]) {
+                return false;
+            }
+            const VertexKind Kind{ Kinds[From] };
+            if (Kind == VertexKind::Manifold) {
+                return true;
+            }
+            if (Kind == VertexKind::Locked || Kinds[To] != Kind || (OpenOut[From] != To && OpenIn[From] != To)) {
+                return false;
+            }
+            return Kind == VertexKind::Border || TwinTarget(From, To) != NoVertex;
+        };
+        // True when moving From onto To degenerates a surviving triangle
+        // around From or turns it too far; see MinNormalCosine.
+        const auto FlipsTriangle = [&](std::uint32_t From, std::uint32_t To) {
+            for (std::uint32_t Item{ Triangles.Offsets[From] }; Item < Triangles.Offsets[From + 1]; ++Item) {
+                const std::size_t TriangleIndex{ Triangles.Items[Item] };
+                const std::uint32_t* Triangle{ Working.data() + TriangleIndex * 3 };
+                if (Remap[Triangle[0]] == Remap[To] || Remap[Triangle[1]] == Remap[To] || Remap[Triangle[2]] == Remap[To]) {
+                    continue;
+                }
+                std::size_t Slot{ 0 };
+                while (Triangle[Slot] != From) {
+                    ++Slot;
+                }
+                const Vec3& P1{ Points[Triangle[(Slot + 1) % 3]] };
+                const Vec3& P2{ Points[Triangle[(Slot + 2) % 3]] };
+                const Vec3 Before{ Cross(Subtract(P1, Points[From]), Subtract(P2, Points[From])) };
+                const Vec3 After{ Cross(Subtract(P1, Points[To]), Subtract(P2, Points[To])) };
+                const Vec3& Input{ Normals[TriangleIndex] };
+                const double Lengths{ std::sqrt(Dot(Before, Before) * Dot(After, After)) };
+                const double InputLengths{ std::sqrt(Dot(Input, Input) * Dot(After, After)) };
+                if (Dot(Before, After) <= MinNormalCosine * Lengths || Dot(Input, After) < MinNormalCosine * InputLengths) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // The flip test assumes every other corner of the triangles around a
+        // moving vertex stays put, so those vertices sit out the pass.
+        std::pmr::vector<std::uint8_t> Touched(VertexCount, Resource);
+        const auto LockRing = [&](std::uint32_t Vertex) {
+            for (std::uint32_t Item{ Triangles.Offsets[Vertex] }; Item < Triangles.Offsets[Vertex + 1]; ++Item) {
+                const std::uint32_t* Triangle{ Working.data() + static_cast<std::size_t>(Triangles.Items[Item]) * 3 };
+                Touched[Remap[Triangle[0]]] = 1;
+                Touched[Remap[Triangle[1]]] = 1;
+                Touched[Remap[Triangle[2]]] = 1;
+            }
+        };
+
+        std::pmr::vector<EdgeCollapse> Collapses{ Resource };
+        std::pmr::vector<std::uint32_t> CollapseTo(VertexCount, Resource);
+        double MaxError{ 0.0 };
+        while (Working.size() > Target) {
+            BuildLists(Working, VertexCount, false, Edges);
+            BuildLists(Working, VertexCount, true, Triangles);
+
+            // Interior edges are seen from both triangles; only the half-edge
+            // with the smaller source proposes them.
+            Collapses.clear();
+            for (std::size_t Corner{ 0 }; Corner < Working.size(); ++Corner) {
+                const std::uint32_t A{ Working[Corner] };
+                const std::uint32_t B{ Working[(Corner % 3 == 2) ? Corner - 2 : Corner + 1] };
+                if (A > B && HasEdge(Edges, B, A)) {
+                    continue;
+                }
+                if (CanCollapse(A, B)) {
+                    Collapses.push_back(EdgeCollapse{ A, B, Evaluate(Quadrics[Remap[A]], Points[B]) });
+                }
+                if (CanCollapse(B, A)) {
+                    Collapses.push_back(EdgeCollapse{ B, A, Evaluate(Quadrics[Remap[B]], Points[A]) });
+                }
+            }
+            if (Collapses.empty()) {
+                break;
+            }
+            std::sort(Collapses.begin(), Collapses.end(), [](const EdgeCollapse& A, const EdgeCollapse& B) { return A.Error < B.Error; });
+
+            // A manifold collapse removes two triangles, a border one one.
+            const std::size_t TrianglesToRemove{ (Working.size() - Target) / 3 };
+            const std::size_t CollapseGoal{ TrianglesToRemove / 2 };
+            const double ErrorLimit{ (CollapseGoal < Collapses.size()) ? PassErrorSlack * Collapses[CollapseGoal].Error : std::numeric_limits<double>::infinity() };
+            std::fill(Touched.begin(), Touched.end(), std::uint8_t{ 0 });
+            std::iota(CollapseTo.begin(), CollapseTo.end(), 0u);
+            std::size_t Removed{ 0 };
+            std::size_t Applied{ 0 };
+            for (const EdgeCollapse& Collapse : Collapses) {
+                if (Removed >= TrianglesToRemove || Collapse.Error > ErrorLimit) {
+                    break;
+                }
+                const std::uint32_t From{ Remap[Collapse.From] };
+                const std::uint32_t To{ Remap[Collapse.To] };
+                if (Touched[From] != 0 || Touched[To] != 0) {
+                    continue;
+                }
+                const bool Seam{ Kinds[Collapse.From] == VertexKind::Seam };
+                const std::uint32_t TwinFrom{ Wedge[Collapse.From] };
+                const std::uint32_t TwinTo{ Seam ? TwinTarget(Collapse.From, Collapse.To) : NoVertex };
+                if (FlipsTriangle(Collapse.From, Collapse.To) || (Seam && FlipsTriangle(TwinFrom, TwinTo))) {
+                    continue;
+                }
+                AddQuadric(Quadrics[To], Quadrics[From]);
+                CollapseTo[Collapse.From] = Collapse.To;
+                LockRing(Collapse.From);
+                if (Seam) {
+                    CollapseTo[TwinFrom] = TwinTo;
+                    LockRing(TwinFrom);
+                }
+                Removed += (Kinds[Collapse.From] == VertexKind::Border) ? 1 : 2;
+                MaxError = std::max(MaxError, Collapse.Error);
+                ++Applied;
+            }
+            if (Applied == 0) {
+                break;
+            }
+
+            std::size_t Write{ 0 };
+            for (std::size_t Corner{ 0 }; Corner < Working.size(); Corner += 3) {
+                const std::uint32_t A{ CollapseTo[Working[Corner]] };
+                const std::uint32_t B{ CollapseTo[Working[Corner + 1]] };
+                const std::uint32_t C{ CollapseTo[Working[Corner + 2]] };
+                if (Remap[A] == Remap[B] || Remap[B] == Remap[C] || Remap[A] == Remap[C]) {
+                    continue;
+                }
+                Normals[Write / 3] = Normals[Corner / 3];
+                Working[Write++] = A;
+                Working[Write++] = B;
+                Working[Write++] = C;
+            }
+            Working.resize(Write);
+            Normals.resize(Write / 3);
+
+            // Boundary neighbours that collapsed now point at their target;
+            // a vertex whose neighbour collapsed into it takes over the
+            // neighbour's own boundary link.
+            for (std::pmr::vector<std::uint32_t>* Loop : { &OpenOut, &OpenIn }) {
+                for (std::uint32_t Vertex{ 0 }; Vertex < VertexCount; ++Vertex) {
+                    const std::uint32_t Neighbour{ (*Loop)[Vertex] };
+                    if (!IsSingle(Neighbour) || CollapseTo[Neighbour] == Neighbour) {
+                        continue;
+                    }
+                    (*Loop)[Vertex] = (CollapseTo[Neighbour] == Vertex) ? (*Loop)[Neighbour] : CollapseTo[Neighbour];
+                }
+            }
+        }
+
+        for (std::size_t Corner{ 0 }; Corner < Working.size(); ++Corner) {
+            Indices[Corner] = UsedVertices[Working[Corner]];
+        }
+        OutError = static_cast<float>(std::sqrt(MaxError));
+        return Working.size();
+    }
+}
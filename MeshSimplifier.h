@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+
+#include "Common.h"
+
+namespace asset {
+    // Simplified levels generated per SubMesh by the LOD cook stage; each
+    // level targets half the triangles of the one before it.
+    constexpr std::size_t DefaultLodCount{ 4 };
+
+    // Reduces the triangle list Indices towards TargetIndexCount indices with
+    // greedy quadric-error edge collapses and writes the result to the front
+    // of Indices. Collapses move a vertex onto a neighbour, so no vertices are
+    // created and every attribute stays exact. Open borders (material and
+    // SubMesh boundaries) only slide along themselves, vertices split across
+    // a normal or UV seam move with their twin along the seam, and corners
+    // where more edges meet are locked. Collapses that would leave a triangle's
+    // normal more than 60 degrees from its previous or its input normal are
+    // skipped, so no triangle flips and the result can stay above the target.
+    //
+    // Returns the new index count. OutError receives the root of the largest
+    // quadric error accepted, an estimate in position units of how far the
+    // result strays from the input surface.
+    std::size_t SimplifyMesh(std::span<std::uint32_t> Indices, std::span<const Vec3> Positions, std::size_t TargetIndexCount, float& OutError, std::pmr::memory_resource* Resource);
+}
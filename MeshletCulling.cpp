@@ -0,0 +1,90 @@
+#include "MeshletCulling.h"
+
+#include <cmath>
+
+namespace {
+    // Relative difference between axis scales still treated as uniform.
+    constexpr float UniformScaleTolerance{ 1.0e-3f };
+
+    bool PreservesCones(const glm::mat4& World) {
+        const glm::mat3 Linear{ World };
+        if (glm::determinant(Linear) <= 0.0f) {
+            return false;
+        }
+        const float ScaleX{ glm::length(Linear[0]) };
+        const float ScaleY{ glm::length(Linear[1]) };
+        const float ScaleZ{ glm::length(Linear[2]) };
+        const float Tolerance{ UniformScaleTolerance * ScaleX };
+        return std::abs(ScaleX - ScaleY) <= Tolerance && std::abs(ScaleX - ScaleZ) <= Tolerance;
+    }
+}
+
+namespace asset {
+    std::size_t MeshletCullStats::SubmittedTriangles() const {
+        return TriangleCount - FrustumCulledTriangles - BackfaceCulledTriangles;
+    }
+
+    void MeshletCuller::Begin(const glm::mat4& ViewProjection, const glm::vec3& CameraPosition) {
+        mPlanes = ExtractFrustumPlanes(ViewProjection);
+        mCameraPosition = CameraPosition;
+        mStats = MeshletCullStats{};
+    }
+
+    void MeshletCuller::SetInstances(std::span<const glm::mat4> Transforms) {
+        mInstances.clear();
+        for (const glm::mat4& World : Transforms) {
+            mInstances.push_back(Instance{ World, MaxAxisScale(World), PreservesCones(World) });
+        }
+    }
+
+    void MeshletCuller::Cull(std::span<const ModelMesh::Meshlet> Meshlets, std::vector<IndexRange>& OutRanges) {
+        for (const ModelMesh::Meshlet& Meshlet : Meshlets) {
+            const std::size_t Triangles{ Meshlet.IndexCount / 3 };
+            ++mStats.MeshletCount;
+            mStats.TriangleCount += Triangles;
+            const Visibility Result{ Classify(Meshlet) };
+            if (Result == Visibility::Visible) {
+                if (!OutRanges.empty() && OutRanges.back().IndexOffset + OutRanges.back().IndexCount == Meshlet.IndexOffset) {
+                    OutRanges.back().IndexCount += Meshlet.IndexCount;
+                    continue;
+                }
+                OutRanges.push_back(IndexRange{ Meshlet.IndexOffset, Meshlet.IndexCount });
+                continue;
+            }
+            ++mStats.CulledMeshletCount;
+            if (Result == Visibility::Backfacing) {
+                mStats.BackfaceCulledTriangles += Triangles;
+                continue;
+            }
+            mStats.FrustumCulledTriangles += Triangles;
+        }
+    }
+
+    const MeshletCullStats& MeshletCuller::GetStats() const {
+        return mStats;
+    }
+
+    MeshletCuller::Visibility MeshletCuller::Classify(const ModelMesh::Meshlet& Meshlet) const {
+        const glm::vec3 Center{ ToGlmVec3(Meshlet.Center) };
+        const glm::vec3 Axis{ ToGlmVec3(Meshlet.ConeAxis) };
+        const bool HasCone{ Meshlet.ConeCutoff < 1.0f };
+        Visibility Result{ Visibility::OutsideFrustum };
+        for (const Instance& Item : mInstances) {
+            const glm::vec3 WorldCenter{ Item.World * glm::vec4{ Center, 1.0f } };
+            const float WorldRadius{ Meshlet.Radius * Item.RadiusScale };
+            if (!SphereInFrustum(mPlanes, WorldCenter, WorldRadius)) {
+                continue;
+            }
+            if (!HasCone || !Item.ConeValid) {
+                return Visibility::Visible;
+            }
+            const glm::vec3 WorldAxis{ glm::normalize(glm::mat3{ Item.World } * Axis) };
+            const glm::vec3 View{ WorldCenter - mCameraPosition };
+            if (glm::dot(View, WorldAxis) < Meshlet.ConeCutoff * glm::length(View) + WorldRadius) {
+                return Visibility::Visible;
+            }
+            Result = Visibility::Backfacing;
+        }
+        return Result;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ModelResult.h"
+#include "ViewerMath.h"
+
+namespace asset {
+    struct IndexRange final {
+    public:
+        std::size_t IndexOffset{ 0 };
+        std::size_t IndexCount{ 0 };
+    };
+
+    // Triangle counts over every Cull call since the last Begin. A meshlet is
+    // counted as backfacing when its sphere is inside the frustum for at least
+    // one instance but its cone rejects it for all of them.
+    struct MeshletCullStats final {
+    public:
+        std::size_t MeshletCount{ 0 };
+        std::size_t CulledMeshletCount{ 0 };
+        std::size_t TriangleCount{ 0 };
+        std::size_t FrustumCulledTriangles{ 0 };
+        std::size_t BackfaceCulledTriangles{ 0 };
+
+        std::size_t SubmittedTriangles() const;
+    };
+
+    // CPU cluster culling for instanced draws: a meshlet is kept when its
+    // bounding sphere is in the frustum and its normal cone faces the camera
+    // for any instance. The cone test is skipped for instances with
+    // non-uniform scale or a mirroring transform, where it does not hold.
+    class MeshletCuller final {
+    public:
+        MeshletCuller() = default;
+        ~MeshletCuller() = default;
+
+        MeshletCuller(const MeshletCuller& Other) = delete;
+        MeshletCuller& operator=(const MeshletCuller& Other) = delete;
+        MeshletCuller(MeshletCuller&& Other) noexcept = default;
+        MeshletCuller& operator=(MeshletCuller&& Other) noexcept = default;
+
+    public:
+        // Starts a frame and clears the stats.
+        void Begin(const glm::mat4& ViewProjection, const glm::vec3& CameraPosition);
+        // World transforms used by the following Cull calls.
+        void SetInstances(std::span<const glm::mat4> Transforms);
+        // Appends the index ranges of the surviving meshlets to OutRanges,
+        // merging neighbours that touch so each run is one draw.
+        void Cull(std::span<const ModelMesh::Meshlet> Meshlets, std::vector<IndexRange>& OutRanges);
+
+        const MeshletCullStats& GetStats() const;
+
+    private:
+        struct Instance final {
+        public:
+            glm::mat4 World{ 1.0f };
+            float RadiusScale{ 1.0f };
+            bool ConeValid{ false };
+        };
+
+        enum class Visibility {
+            Visible,
+            OutsideFrustum,
+            Backfacing,
+        };
+
+        Visibility Classify(const ModelMesh::Meshlet& Meshlet) const;
+
+    private:
+        FrustumPlanes mPlanes{};
+        glm::vec3 mCameraPosition{ 0.0f };
+        std::vector<Instance> mInstances{};
+        MeshletCullStats mStats{};
+    };
+}
@@ -0,0 +1,152 @@
+#include "Meshlets.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+using namespace asset;
+
+namespace {
+    constexpr std::uint32_t NoMeshlet{ 0xFFFFFFFFu };
+    // Below this the cone spans more than ~84 degrees off its axis and culls
+    // too rarely to be worth testing.
+    constexpr float MinConeDot{ 0.1f };
+
+    Vec3 Subtract(const Vec3& A, const Vec3& B) {
+        return Vec3{ A.mX - B.mX, A.mY - B.mY, A.mZ - B.mZ };
+    }
+
+    float Dot(const Vec3& A, const Vec3& B) {
+        return (A.mX * B.mX) + (A.mY * B.mY) + (A.mZ * B.mZ);
+    }
+
+    Vec3 Cross(const Vec3& A, const Vec3& B) {
+        return Vec3{ (A.mY * B.mZ) - (A.mZ * B.mY), (A.mZ * B.mX) - (A.mX * B.mZ), (A.mX * B.mY) - (A.mY * B.mX) };
+    }
+
+    // Unit normal of a counter-clockwise triangle; false when it has no area.
+    bool TriangleNormal(const std::vector<Vec3>& Positions, const std::uint32_t* Triangle, Vec3& OutNormal) {
+        const Vec3& A{ Positions[Triangle[0]] };
+        const Vec3 Normal{ Cross(Subtract(Positions[Triangle[1]], A), Subtract(Positions[Triangle[2]], A)) };
+        const float Length{ std::sqrt(Dot(Normal, Normal)) };
+        if (Length <= 0.0f) {
+            return false;
+        }
+        OutNormal = Vec3{ Normal.mX / Length, Normal.mY / Length, Normal.mZ / Length };
+        return true;
+    }
+
+    void ComputeBounds(const std::vector<Vec3>& Positions, std::span<const std::uint32_t> Indices, ModelMesh::Meshlet& Meshlet) {
+        Vec3 Min{ Positions[Indices[0]] };
+        Vec3 Max{ Min };
+        for (const std::uint32_t Index : Indices) {
+            const Vec3& Position{ Positions[Index] };
+            Min = Vec3{ std::min(Min.mX, Position.mX), std::min(Min.mY, Position.mY), std::min(Min.mZ, Position.mZ) };
+            Max = Vec3{ std::max(Max.mX, Position.mX), std::max(Max.mY, Position.mY), std::max(Max.mZ, Position.mZ) };
+        }
+        Meshlet.Center = Vec3{ (Min.mX + Max.mX) * 0.5f, (Min.mY + Max.mY) * 0.5f, (Min.mZ + Max.mZ) * 0.5f };
+        float RadiusSquared{ 0.0f };
+        for (const std::uint32_t Index : Indices) {
+            const Vec3 Offset{ Subtract(Positions[Index], Meshlet.Center) };
+            RadiusSquared = std::max(RadiusSquared, Dot(Offset, Offset));
+        }
+        Meshlet.Radius = std::sqrt(RadiusSquared);
+
+        Vec3 Sum{};
+        for (std::size_t Corner{ 0 }; Corner < Indices.size(); Corner += 3) {
+            Vec3 Normal{};
+            if (TriangleNormal(Positions, &Indices[Corner], Normal)) {
+                Sum = Vec3{ Sum.mX + Normal.mX, Sum.mY + Normal.mY, Sum.mZ + Normal.mZ };
+            }
+        }
+        const float SumLength{ std::sqrt(Dot(Sum, Sum)) };
+        Meshlet.ConeAxis = Vec3{};
+        Meshlet.ConeCutoff = 1.0f;
+        if (SumLength <= 0.0f) {
+            return;
+        }
+        const Vec3 Axis{ Sum.mX / SumLength, Sum.mY / SumLength, Sum.mZ / SumLength };
+        float MinDot{ 1.0f };
+        for (std::size_t Corner{ 0 }; Corner < Indices.size(); Corner += 3) {
+            Vec3 Normal{};
+            if (TriangleNormal(Positions, &Indices[Corner], Normal)) {
+                MinDot = std::min(MinDot, Dot(Normal, Axis));
+            }
+        }
+        if (MinDot <= MinConeDot) {
+            return;
+        }
+        // The cone holds every normal; the test in ModelMesh::Meshlet wants the
+        // sine of its half-angle.
+        Meshlet.ConeAxis = Axis;
+        Meshlet.ConeCutoff = std::sqrt(1.0f - (MinDot * MinDot));
+    }
+
+    void AppendMeshlets(const ModelMesh& Mesh, std::size_t IndexOffset, std::size_t IndexCount, std::pmr::vector<std::uint32_t>& LastMeshlet, std::vector<ModelMesh::Meshlet>& OutMeshlets) {
+        const std::vector<std::uint32_t>& Indices{ Mesh.Indices() };
+        const std::vector<Vec3>& Positions{ Mesh.Vertices().Positions };
+        const std::size_t End{ IndexOffset + (IndexCount - IndexCount % 3) };
+        std::size_t Begin{ IndexOffset };
+        std::size_t VertexCount{ 0 };
+        std::uint32_t Current{ static_cast<std::uint32_t>(OutMeshlets.size()) };
+        auto Close = [&](std::size_t Corner) {
+            ModelMesh::Meshlet Meshlet{};
+            Meshlet.IndexOffset = Begin;
+            Meshlet.IndexCount = Corner - Begin;
+            ComputeBounds(Positions, std::span<const std::uint32_t>{ Indices }.subspan(Begin, Corner - Begin), Meshlet);
+            OutMeshlets.push_back(Meshlet);
+            Begin = Corner;
+            VertexCount = 0;
+            Current = static_cast<std::uint32_t>(OutMeshlets.size());
+        };
+        // Vertices of the triangle at Corner not yet in the open meshlet; a
+        // vertex repeated within the triangle counts once.
+        auto CountNewVertices = [&](std::size_t Corner) {
+            std::size_t Count{ 0 };
+            for (std::size_t Offset{ 0 }; Offset < 3; ++Offset) {
+                const std::uint32_t Vertex{ Indices[Corner + Offset] };
+                const bool Repeated{ (Offset > 0 && Indices[Corner] == Vertex) || (Offset > 1 && Indices[Corner + 1] == Vertex) };
+                Count += (LastMeshlet[Vertex] != Current && !Repeated) ? 1 : 0;
+            }
+            return Count;
+        };
+        for (std::size_t Corner{ IndexOffset }; Corner < End; Corner += 3) {
+            std::size_t NewVertices{ CountNewVertices(Corner) };
+            if (VertexCount + NewVertices > MaxMeshletVertices || (Corner - Begin) / 3 == MaxMeshletTriangles) {
+                Close(Corner);
+                NewVertices = CountNewVertices(Corner);
+            }
+            for (std::size_t Offset{ 0 }; Offset < 3; ++Offset) {
+                LastMeshlet[Indices[Corner + Offset]] = Current;
+            }
+            VertexCount += NewVertices;
+        }
+        if (End > Begin) {
+            Close(End);
+        }
+    }
+}
+
+namespace asset {
+    void BuildMeshlets(ModelMesh& Mesh, std::pmr::memory_resource* Resource) {
+        std::vector<ModelMesh::Meshlet>& Meshlets{ Mesh.Meshlets() };
+        Meshlets.clear();
+        if (Mesh.Indices().size() < 3 || Mesh.Vertices().Positions.empty()) {
+            return;
+        }
+        // LastMeshlet[v] is the meshlet v was last added to, so membership of
+        // the open meshlet is one compare.
+        std::pmr::vector<std::uint32_t> LastMeshlet(Mesh.Vertices().Positions.size(), NoMeshlet, Resource);
+        const std::vector<ModelMesh::SubMesh>& SubMeshes{ Mesh.GetSubMeshes() };
+        if (SubMeshes.empty()) {
+            AppendMeshlets(Mesh, 0, Mesh.Indices().size(), LastMeshlet, Meshlets);
+            return;
+        }
+        for (const ModelMesh::SubMesh& SubMesh : SubMeshes) {
+            AppendMeshlets(Mesh, SubMesh.IndexOffset, SubMesh.IndexCount, LastMeshlet, Meshlets);
+        }
+        std::sort(Meshlets.begin(), Meshlets.end(), [](const ModelMesh::Meshlet& A, const ModelMesh::Meshlet& B) { return A.IndexOffset < B.IndexOffset; });
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "ModelResult.h"
+
+namespace asset {
+    // Limits that fit a mesh shader workgroup and keep a meshlet small enough
+    // for its cone to be tight on curved surfaces.
+    constexpr std::size_t MaxMeshletVertices{ 64 };
+    constexpr std::size_t MaxMeshletTriangles{ 124 };
+
+    // Replaces Mesh.Meshlets() with a partition of every SubMesh (of the whole
+    // index buffer when there are none) into runs of consecutive triangles with
+    // at most MaxMeshletVertices unique vertices and MaxMeshletTriangles
+    // triangles. The index buffer is not modified, so run this after any
+    // triangle reordering; a cache-optimised order also gives compact meshlets.
+    void BuildMeshlets(ModelMesh& Mesh, std::pmr::memory_resource* Resource);
+}
@@ -3,6 +3,8 @@
 #include "ViewerMath.h"
 
 #include <cstddef>
+#include <optional>
+#include <utility>
 #ifdef min 
 #undef min
 #endif 
@@ -11,6 +13,17 @@
 #undef max 
 #endif 
 
+namespace {
+    // Matches aInstanceModel in shaders/lit.vert.
+    constexpr GLuint InstanceAttributeIndex{ 11 };
+    // Matches aOctahedralNormal in shaders/lit.vert.
+    constexpr GLuint OctahedralNormalAttributeIndex{ 15 };
+
+    std::size_t IndexTypeSize(GLenum IndexType) {
+        return (IndexType == GL_UNSIGNED_SHORT) ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+    }
+}
+
 namespace asset {
     Model::~Model() {
         Destroy();
@@ -19,33 +32,33 @@ namespace asset {
     Model::Model(Model&& Other) noexcept
         : mVao{ Other.mVao },
 		mIndexBuffer{ Other.mIndexBuffer },
-		mPositionBuffer{ Other.mPositionBuffer },
-		mNormalBuffer{ Other.mNormalBuffer },
-		mTexCoordBuffers{ Other.mTexCoordBuffers },
-		mColorBuffer{ Other.mColorBuffer },
-		mTangentBuffer{ Other.mTangentBuffer },
-		mBitangentBuffer{ Other.mBitangentBuffer },
-		mBoneIndexBuffer{ Other.mBoneIndexBuffer },
-		mBoneWeightBuffer{ Other.mBoneWeightBuffer },
+		mVertexBuffer{ Other.mVertexBuffer },
+		mInstanceBuffer{ Other.mInstanceBuffer },
+		mLayout{ std::move(Other.mLayout) },
+		mArena{ Other.mArena },
+		mSlice{ Other.mSlice },
 		mBounds{ Other.mBounds },
 		mBoundRadius{ Other.mBoundRadius },
 		mHasBounds{ Other.mHasBounds },
+		mOctahedralNormals{ Other.mOctahedralNormals },
 		mIndexCount{ Other.mIndexCount },
+		mIndexType{ Other.mIndexType },
+		mInstanceCount{ Other.mInstanceCount },
 		mPrimitive{ Other.mPrimitive } {
         Other.mVao = 0;
         Other.mIndexBuffer = 0;
-        Other.mPositionBuffer = 0;
-        Other.mNormalBuffer = 0;
-        Other.mTexCoordBuffers = {};
-        Other.mColorBuffer = 0;
-        Other.mTangentBuffer = 0;
-        Other.mBitangentBuffer = 0;
-        Other.mBoneIndexBuffer = 0;
-        Other.mBoneWeightBuffer = 0;
+        Other.mVertexBuffer = 0;
+        Other.mInstanceBuffer = 0;
+        Other.mLayout = {};
+        Other.mArena = nullptr;
+        Other.mSlice = {};
         Other.mBounds = {};
         Other.mBoundRadius = 0.0f;
         Other.mHasBounds = false;
+        Other.mOctahedralNormals = false;
         Other.mIndexCount = 0;
+        Other.mIndexType = GL_UNSIGNED_INT;
+        Other.mInstanceCount = 0;
         Other.mPrimitive = GL_TRIANGLES;
     }
 
@@ -55,34 +68,34 @@ namespace asset {
 
             mVao = Other.mVao;
             mIndexBuffer = Other.mIndexBuffer;
-            mPositionBuffer = Other.mPositionBuffer;
-            mNormalBuffer = Other.mNormalBuffer;
-            mTexCoordBuffers = Other.mTexCoordBuffers;
-            mColorBuffer = Other.mColorBuffer;
-            mTangentBuffer = Other.mTangentBuffer;
-            mBitangentBuffer = Other.mBitangentBuffer;
-            mBoneIndexBuffer = Other.mBoneIndexBuffer;
-            mBoneWeightBuffer = Other.mBoneWeightBuffer;
+            mVertexBuffer = Other.mVertexBuffer;
+            mInstanceBuffer = Other.mInstanceBuffer;
+            mLayout = std::move(Other.mLayout);
+            mArena = Other.mArena;
+            mSlice = Other.mSlice;
             mBounds = Other.mBounds;
             mBoundRadius = Other.mBoundRadius;
             mHasBounds = Other.mHasBounds;
+            mOctahedralNormals = Other.mOctahedralNormals;
             mIndexCount = Other.mIndexCount;
+            mIndexType = Other.mIndexType;
+            mInstanceCount = Other.mInstanceCount;
             mPrimitive = Other.mPrimitive;
 
             Other.mVao = 0;
             Other.mIndexBuffer = 0;
-            Other.mPositionBuffer = 0;
-            Other.mNormalBuffer = 0;
-            Other.mTexCoordBuffers = {};
-            Other.mColorBuffer = 0;
-            Other.mTangentBuffer = 0;
-            Other.mBitangentBuffer = 0;
-            Other.mBoneIndexBuffer = 0;
-            Other.mBoneWeightBuffer = 0;
+            Other.mVertexBuffer = 0;
+            Other.mInstanceBuffer = 0;
+            Other.mLayout = {};
+            Other.mArena = nullptr;
+            Other.mSlice = {};
             Other.mBounds = {};
             Other.mBoundRadius = 0.0f;
             Other.mHasBounds = false;
+            Other.mOctahedralNormals = false;
             Other.mIndexCount = 0;
+            Other.mIndexType = GL_UNSIGNED_INT;
+            Other.mInstanceCount = 0;
             Other.mPrimitive = GL_TRIANGLES;
         }
         return *this;
@@ -96,21 +109,43 @@ namespace asset {
         return (Max - Min) * 0.5f;
     }
 
+    void Model::SetArena(GeometryArena* Arena) {
+        mArena = Arena;
+    }
+
     bool Model::Create(const VertexAttributes& Vertices, const std::vector<std::uint32_t>& Indices, GLenum Primitive) {
         return Create(Vertices, std::span<const std::uint32_t>{ Indices.data(), Indices.size() }, Primitive);
     }
 
     bool Model::Create(const VertexAttributes& Vertices, std::span<const std::uint32_t> Indices, GLenum Primitive) {
+        return Create(VertexAttributeView{ Vertices }, Indices, Primitive);
+    }
+
+    bool Model::Create(const VertexAttributeView& Vertices, std::span<const std::uint32_t> Indices, GLenum Primitive) {
+        return Create(PackedVertexView{ Vertices }, Indices, Primitive);
+    }
+
+    bool Model::Create(const PackedVertexView& Vertices, std::span<const std::uint32_t> Indices, GLenum Primitive) {
+        return CreateBuffers(Vertices, std::as_bytes(Indices), GL_UNSIGNED_INT, Primitive);
+    }
+
+    bool Model::Create(const PackedVertexView& Vertices, std::span<const std::uint16_t> Indices, GLenum Primitive) {
+        return CreateBuffers(Vertices, std::as_bytes(Indices), GL_UNSIGNED_SHORT, Primitive);
+    }
+
+    bool Model::CreateBuffers(const PackedVertexView& Vertices, std::span<const std::byte> Indices, GLenum IndexType, GLenum Primitive) {
         Destroy();
 
         if (!ValidateVertexData(Vertices) || Indices.empty()) {
             return false;
         }
 
-        mBounds.Min = ToGlmVec3(Vertices.Positions.front());
-        mBounds.Max = ToGlmVec3(Vertices.Positions.front());
+        const std::span<const std::byte> PositionBytes{ Vertices.Get(BinaryStream::Positions).Bytes };
+        const std::span<const Vec3> Positions{ reinterpret_cast<const Vec3*>(PositionBytes.data()), Vertices.VertexCount() };
+        mBounds.Min = ToGlmVec3(Positions.front());
+        mBounds.Max = ToGlmVec3(Positions.front());
 
-        for (const Vec3& Position : Vertices.Positions) {
+        for (const Vec3& Position : Positions) {
             const glm::vec3 Converted{ ToGlmVec3(Position) };
             mBounds.Min = glm::min(mBounds.Min, Converted);
             mBounds.Max = glm::max(mBounds.Max, Converted);
@@ -120,8 +155,19 @@ namespace asset {
         mBoundRadius = glm::length(Extents);
         mHasBounds = true;
 
-        mIndexCount = static_cast<GLsizei>(Indices.size());
+        mIndexCount = static_cast<GLsizei>(Indices.size() / IndexTypeSize(IndexType));
+        mIndexType = IndexType;
         mPrimitive = Primitive;
+        mOctahedralNormals = Vertices.Get(BinaryStream::Normals).Format == BinaryElementFormat::OctSnorm16;
+
+        // One buffer holds every present stream, interleaved; the layout
+        // drives the attribute pointers.
+        mLayout = BuildVertexLayout(Vertices);
+        std::vector<std::byte> Interleaved(Vertices.VertexCount() * mLayout.Stride);
+        InterleaveVertices(Vertices, mLayout, Interleaved);
+        if (mArena != nullptr) {
+            return CreateInArena(Interleaved, Indices);
+        }
 
         glGenVertexArrays(1, &mVao);
         glGenBuffers(1, &mIndexBuffer);
@@ -129,42 +175,129 @@ namespace asset {
         glBindVertexArray(mVao);
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(Indices.size_bytes()), Indices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(Indices.size()), Indices.data(), GL_STATIC_DRAW);
 
-        SetupVertexBuffer(mPositionBuffer, std::span<const std::byte>{ reinterpret_cast<const std::byte*>(Vertices.Positions.data()), Vertices.Positions.size() * sizeof(Vec3) }, 0, 3, GL_FLOAT, false, false);
-        SetupVertexBuffer(mNormalBuffer, std::span<const std::byte>{ reinterpret_cast<const std::byte*>(Vertices.Normals.data()), Vertices.Normals.size() * sizeof(Vec3) }, 1, 3, GL_FLOAT, false, false);
-
-        for (std::size_t Index{ 0 }; Index < Vertices.TexCoords.size(); ++Index) {
-            const std::vector<Vec2>& TexCoords{ Vertices.TexCoords[Index] };
-            const GLuint AttributeIndex{ static_cast<GLuint>(2 + Index) };
-            SetupVertexBuffer(mTexCoordBuffers[Index], std::span<const std::byte>{ reinterpret_cast<const std::byte*>(TexCoords.data()), TexCoords.size() * sizeof(Vec2) }, AttributeIndex, 2, GL_FLOAT, false, false);
-        }
-
-        SetupVertexBuffer(mColorBuffer, std::span<const std::byte>{ reinterpret_cast<const std::byte*>(Vertices.Colors.data()), Vertices.Colors.size() * sizeof(Vec4) }, 6, 4, GL_FLOAT, false, false);
-        SetupVertexBuffer(mTangentBuffer, std::span<const std::byte>{ reinterpret_cast<const std::byte*>(Vertices.Tangents.data()), Vertices.Tangents.size() * sizeof(Vec3) }, 7, 3, GL_FLOAT, false, false);
-        SetupVertexBuffer(mBitangentBuffer, std::span<const std::byte>{ reinterpret_cast<const std::byte*>(Vertices.Bitangents.data()), Vertices.Bitangents.size() * sizeof(Vec3) }, 8, 3, GL_FLOAT, false, false);
-        SetupVertexBuffer(mBoneIndexBuffer, std::span<const std::byte>{ reinterpret_cast<const std::byte*>(Vertices.BoneIndices.data()), Vertices.BoneIndices.size() * sizeof(UVec4) }, 9, 4, GL_UNSIGNED_INT, false, true);
-        SetupVertexBuffer(mBoneWeightBuffer, std::span<const std::byte>{ reinterpret_cast<const std::byte*>(Vertices.BoneWeights.data()), Vertices.BoneWeights.size() * sizeof(Vec4) }, 10, 4, GL_FLOAT, false, false);
+        glGenBuffers(1, &mVertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(Interleaved.size()), Interleaved.data(), GL_STATIC_DRAW);
+        SetupVertexAttributes(mLayout);
 
         glBindVertexArray(0);
 
         return true;
     }
 
+    bool Model::CreateInArena(std::span<const std::byte> Vertices, std::span<const std::byte> Indices) {
+        const std::optional<GeometrySlice> Slice{ mArena->Allocate(mLayout, Vertices, Indices) };
+        if (!Slice.has_value()) {
+            Destroy();
+            return false;
+        }
+        mSlice = *Slice;
+        return true;
+    }
+
+    void Model::SetInstanceTransforms(std::span<const glm::mat4> Transforms) {
+        if (mSlice.Valid()) {
+            // The arena points its VAO at the buffer when drawing.
+            if (mInstanceBuffer == 0) {
+                glGenBuffers(1, &mInstanceBuffer);
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(Transforms.size_bytes()), Transforms.data(), GL_STATIC_DRAW);
+            mInstanceCount = static_cast<GLsizei>(Transforms.size());
+            return;
+        }
+        if (mVao == 0) {
+            return;
+        }
+        glBindVertexArray(mVao);
+        if (mInstanceBuffer == 0) {
+            glGenBuffers(1, &mInstanceBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+            // A mat4 attribute takes four consecutive locations, one per column.
+            for (GLuint Column{ 0 }; Column < 4; ++Column) {
+                const GLuint AttributeIndex{ InstanceAttributeIndex + Column };
+                glEnableVertexAttribArray(AttributeIndex);
+                glVertexAttribPointer(AttributeIndex, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<const void*>(Column * sizeof(glm::vec4)));
+                glVertexAttribDivisor(AttributeIndex, 1);
+            }
+        }
+        else {
+            glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+        }
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(Transforms.size_bytes()), Transforms.data(), GL_STATIC_DRAW);
+        glBindVertexArray(0);
+        mInstanceCount = static_cast<GLsizei>(Transforms.size());
+    }
+
     void Model::Draw() const {
+        if (mSlice.Valid()) {
+            DrawRange(0, static_cast<std::size_t>(mIndexCount));
+            return;
+        }
+        ApplyConstantAttributes();
         glBindVertexArray(mVao);
-        glDrawElements(mPrimitive, mIndexCount, GL_UNSIGNED_INT, nullptr);
+        glDrawElements(mPrimitive, mIndexCount, mIndexType, nullptr);
         glBindVertexArray(0);
     }
 
-    void Model::DrawRange(std::size_t IndexOffset, std::size_t IndexCount) const {
+    void Model::DrawRange(std::size_t IndexOffset, std::size_t IndexCount, std::size_t BaseVertex) const {
         if (IndexCount == 0) {
             return;
         }
+        ApplyConstantAttributes();
+        const GLsizei Count{ static_cast<GLsizei>(IndexCount) };
+        const std::size_t OffsetBytes{ IndexOffset * IndexTypeSize(mIndexType) };
+        if (mSlice.Valid()) {
+            mArena->BindForDraw(mSlice.Pool, 0, 0);
+            glDrawElementsBaseVertex(mPrimitive, Count, mIndexType, reinterpret_cast<const void*>(mSlice.IndexByteOffset + OffsetBytes), static_cast<GLint>(mSlice.BaseVertex + BaseVertex));
+            return;
+        }
+        glBindVertexArray(mVao);
+        glDrawElementsBaseVertex(mPrimitive, Count, mIndexType, reinterpret_cast<const void*>(OffsetBytes), static_cast<GLint>(BaseVertex));
+        glBindVertexArray(0);
+    }
+
+    void Model::DrawInstanced() const {
+        DrawRangeInstanced(0, static_cast<std::size_t>(mIndexCount));
+    }
+
+    void Model::DrawRangeInstanced(std::size_t IndexOffset, std::size_t IndexCount) const {
+        DrawRangeInstanced(IndexOffset, IndexCount, 0, static_cast<std::size_t>(mInstanceCount));
+    }
+
+    void Model::DrawRangeInstanced(std::size_t IndexOffset, std::size_t IndexCount, std::size_t FirstInstance, std::size_t InstanceCount, std::size_t BaseVertex) const {
+        if (IndexCount == 0 || InstanceCount == 0 || FirstInstance + InstanceCount > static_cast<std::size_t>(mInstanceCount)) {
+            return;
+        }
+        ApplyConstantAttributes();
+        if (mSlice.Valid()) {
+            // Consecutive draws from the same pool keep its VAO bound.
+            mArena->BindForDraw(mSlice.Pool, mInstanceBuffer, FirstInstance);
+            const std::size_t OffsetBytes{ mSlice.IndexByteOffset + IndexOffset * IndexTypeSize(mIndexType) };
+            glDrawElementsInstancedBaseVertex(mPrimitive, static_cast<GLsizei>(IndexCount), mIndexType, reinterpret_cast<const void*>(OffsetBytes), static_cast<GLsizei>(InstanceCount), static_cast<GLint>(mSlice.BaseVertex + BaseVertex));
+            return;
+        }
         glBindVertexArray(mVao);
+        // GL 3.3 has no base instance, so later groups move the instance
+        // attribute pointers and put them back afterwards.
+        const auto PointInstanceAttributes = [&](std::size_t Instance) {
+            glBindBuffer(GL_ARRAY_BUFFER, mInstanceBuffer);
+            for (GLuint Column{ 0 }; Column < 4; ++Column) {
+                const std::size_t OffsetBytes{ Instance * sizeof(glm::mat4) + Column * sizeof(glm::vec4) };
+                glVertexAttribPointer(InstanceAttributeIndex + Column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<const void*>(OffsetBytes));
+            }
+        };
+        if (FirstInstance != 0) {
+            PointInstanceAttributes(FirstInstance);
+        }
         const GLsizei Count{ static_cast<GLsizei>(IndexCount) };
-        const std::size_t OffsetBytes{ IndexOffset * sizeof(std::uint32_t) };
-        glDrawElements(mPrimitive, Count, GL_UNSIGNED_INT, reinterpret_cast<const void*>(OffsetBytes));
+        const std::size_t OffsetBytes{ IndexOffset * IndexTypeSize(mIndexType) };
+        glDrawElementsInstancedBaseVertex(mPrimitive, Count, mIndexType, reinterpret_cast<const void*>(OffsetBytes), static_cast<GLsizei>(InstanceCount), static_cast<GLint>(BaseVertex));
+        if (FirstInstance != 0) {
+            PointInstanceAttributes(0);
+        }
         glBindVertexArray(0);
     }
 
@@ -181,95 +314,59 @@ namespace asset {
     }
 
     void Model::Destroy() {
+        if (mSlice.Valid()) {
+            mArena->Free(mSlice);
+            mSlice = {};
+        }
         if (mIndexBuffer != 0) {
             glDeleteBuffers(1, &mIndexBuffer);
             mIndexBuffer = 0;
         }
-        if (mPositionBuffer != 0) {
-            glDeleteBuffers(1, &mPositionBuffer);
-            mPositionBuffer = 0;
-        }
-        if (mNormalBuffer != 0) {
-            glDeleteBuffers(1, &mNormalBuffer);
-            mNormalBuffer = 0;
-        }
-        for (GLuint& Buffer : mTexCoordBuffers) {
-            if (Buffer != 0) {
-                glDeleteBuffers(1, &Buffer);
-                Buffer = 0;
-            }
+        if (mVertexBuffer != 0) {
+            glDeleteBuffers(1, &mVertexBuffer);
+            mVertexBuffer = 0;
         }
-        if (mColorBuffer != 0) {
-            glDeleteBuffers(1, &mColorBuffer);
-            mColorBuffer = 0;
-        }
-        if (mTangentBuffer != 0) {
-            glDeleteBuffers(1, &mTangentBuffer);
-            mTangentBuffer = 0;
-        }
-        if (mBitangentBuffer != 0) {
-            glDeleteBuffers(1, &mBitangentBuffer);
-            mBitangentBuffer = 0;
-        }
-        if (mBoneIndexBuffer != 0) {
-            glDeleteBuffers(1, &mBoneIndexBuffer);
-            mBoneIndexBuffer = 0;
-        }
-        if (mBoneWeightBuffer != 0) {
-            glDeleteBuffers(1, &mBoneWeightBuffer);
-            mBoneWeightBuffer = 0;
+        if (mInstanceBuffer != 0) {
+            glDeleteBuffers(1, &mInstanceBuffer);
+            mInstanceBuffer = 0;
         }
         if (mVao != 0) {
             glDeleteVertexArrays(1, &mVao);
             mVao = 0;
         }
 
+        mLayout = {};
         mIndexCount = 0;
+        mIndexType = GL_UNSIGNED_INT;
+        mInstanceCount = 0;
     }
 
-    bool Model::ValidateVertexData(const VertexAttributes& Vertices) const {
-        const std::size_t Count{ Vertices.Positions.size() };
+    bool Model::ValidateVertexData(const PackedVertexView& Vertices) const {
+        const std::size_t Count{ Vertices.VertexCount() };
         if (Count == 0) {
             return false;
         }
-        if (!Vertices.Normals.empty() && Vertices.Normals.size() != Count) {
-            return false;
-        }
-        for (const std::vector<Vec2>& TexCoords : Vertices.TexCoords) {
-            if (!TexCoords.empty() && TexCoords.size() != Count) {
+        for (const PackedVertexStream& Stream : Vertices.Streams) {
+            if (Stream.Bytes.empty()) {
+                continue;
+            }
+            if (!IsVertexAttributeFormat(Stream.Format) || Stream.Bytes.size() != Count * BinaryElementSize(Stream.Format)) {
                 return false;
             }
         }
-        if (!Vertices.Colors.empty() && Vertices.Colors.size() != Count) {
-            return false;
-        }
-        if (!Vertices.Tangents.empty() && Vertices.Tangents.size() != Count) {
-            return false;
-        }
-        if (!Vertices.Bitangents.empty() && Vertices.Bitangents.size() != Count) {
-            return false;
-        }
-        if (!Vertices.BoneIndices.empty() && Vertices.BoneIndices.size() != Count) {
-            return false;
-        }
-        if (!Vertices.BoneWeights.empty() && Vertices.BoneWeights.size() != Count) {
-            return false;
-        }
         return true;
     }
 
-    void Model::SetupVertexBuffer(GLuint& Buffer, std::span<const std::byte> Bytes, GLuint AttributeIndex, GLint ComponentCount, GLenum Type, bool Normalized, bool IsInteger) {
-        if (Bytes.empty()) {
-            return;
+    // Streams the mesh does not carry have no buffer and read the current
+    // generic attribute value instead. That value is context state rather
+    // than VAO state, so it is set before every draw.
+    void Model::ApplyConstantAttributes() const {
+        if (!mLayout.Has(BinaryStream::Normals)) {
+            glVertexAttrib3f(1, 0.0f, 1.0f, 0.0f);
         }
-        glGenBuffers(1, &Buffer);
-        glBindBuffer(GL_ARRAY_BUFFER, Buffer);
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(Bytes.size()), Bytes.data(), GL_STATIC_DRAW);
-        glEnableVertexAttribArray(AttributeIndex);
-        if (IsInteger) {
-            glVertexAttribIPointer(AttributeIndex, ComponentCount, Type, 0, nullptr);
-            return;
+        if (!mLayout.Has(BinaryStream::Colors)) {
+            glVertexAttrib4f(6, 1.0f, 1.0f, 1.0f, 1.0f);
         }
-        glVertexAttribPointer(AttributeIndex, ComponentCount, Type, Normalized ? GL_TRUE : GL_FALSE, 0, nullptr);
+        glVertexAttrib1f(OctahedralNormalAttributeIndex, mOctahedralNormals ? 1.0f : 0.0f);
     }
 }
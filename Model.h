@@ -1,6 +1,5 @@
 #pragma once
 
-#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <span>
@@ -10,6 +9,9 @@
 #include <glm/glm.hpp>
 
 #include "Common.h"
+#include "GeometryArena.h"
+#include "VertexLayout.h"
+#include "VertexQuantization.h"
 
 namespace asset {
     class Model {
@@ -34,11 +36,36 @@ namespace asset {
         Model& operator=(Model&& Other) noexcept;
 
     public:
+        // Models given an arena keep their geometry in it instead of owning
+        // a VAO and buffers, and their draws leave the arena's VAO bound; see
+        // GeometryArena::EndDraws. Takes effect on the next Create; Arena
+        // must outlive the model.
+        void SetArena(GeometryArena* Arena);
+
         bool Create(const VertexAttributes& Vertices, const std::vector<std::uint32_t>& Indices, GLenum Primitive = GL_TRIANGLES);
         bool Create(const VertexAttributes& Vertices, std::span<const std::uint32_t> Indices, GLenum Primitive = GL_TRIANGLES);
+        bool Create(const VertexAttributeView& Vertices, std::span<const std::uint32_t> Indices, GLenum Primitive = GL_TRIANGLES);
+        // Uploads every stream in its stored format, quantised ones included,
+        // interleaved into one vertex buffer; positions must be Float3.
+        bool Create(const PackedVertexView& Vertices, std::span<const std::uint32_t> Indices, GLenum Primitive = GL_TRIANGLES);
+        // Same with 16-bit indices, which halve the index buffer; draw
+        // ranges then need the BaseVertex of their SubMesh.
+        bool Create(const PackedVertexView& Vertices, std::span<const std::uint16_t> Indices, GLenum Primitive = GL_TRIANGLES);
+
+        // Uploads one model matrix per instance into attributes 11-14, which
+        // advance once per instance. Replaces any previous set.
+        void SetInstanceTransforms(std::span<const glm::mat4> Transforms);
 
         void Draw() const;
-        void DrawRange(std::size_t IndexOffset, std::size_t IndexCount) const;
+        // BaseVertex is added to every index of the range.
+        void DrawRange(std::size_t IndexOffset, std::size_t IndexCount, std::size_t BaseVertex = 0) const;
+        // Draw every instance given to SetInstanceTransforms in one call.
+        void DrawInstanced() const;
+        void DrawRangeInstanced(std::size_t IndexOffset, std::size_t IndexCount) const;
+        // Draws InstanceCount instances starting at FirstInstance of the
+        // uploaded set, so callers can group instances and draw each group
+        // with different ranges.
+        void DrawRangeInstanced(std::size_t IndexOffset, std::size_t IndexCount, std::size_t FirstInstance, std::size_t InstanceCount, std::size_t BaseVertex = 0) const;
 
         GLenum Primitive() const;
 
@@ -47,26 +74,28 @@ namespace asset {
 
     private:
         void Destroy();
-        bool ValidateVertexData(const VertexAttributes& Vertices) const;
-        void SetupVertexBuffer(GLuint& Buffer, std::span<const std::byte> Bytes, GLuint AttributeIndex, GLint ComponentCount, GLenum Type, bool Normalized, bool IsInteger);
+        bool CreateBuffers(const PackedVertexView& Vertices, std::span<const std::byte> Indices, GLenum IndexType, GLenum Primitive);
+        bool ValidateVertexData(const PackedVertexView& Vertices) const;
+        bool CreateInArena(std::span<const std::byte> Vertices, std::span<const std::byte> Indices);
+        void ApplyConstantAttributes() const;
 
     private:
         GLuint mVao{ 0 };
         GLuint mIndexBuffer{ 0 };
-        GLuint mPositionBuffer{ 0 };
-        GLuint mNormalBuffer{ 0 };
-        std::array<GLuint, 4> mTexCoordBuffers{};
-        GLuint mColorBuffer{ 0 };
-        GLuint mTangentBuffer{ 0 };
-        GLuint mBitangentBuffer{ 0 };
-        GLuint mBoneIndexBuffer{ 0 };
-        GLuint mBoneWeightBuffer{ 0 };
+        GLuint mVertexBuffer{ 0 };
+        GLuint mInstanceBuffer{ 0 };
+        VertexLayout mLayout{};
+        GeometryArena* mArena{ nullptr };
+        GeometrySlice mSlice{};
 
         Bounds mBounds{};
         float mBoundRadius{ 0.0f };
         bool mHasBounds{ false };
+        bool mOctahedralNormals{ false };
 
         GLsizei mIndexCount{ 0 };
+        GLenum mIndexType{ GL_UNSIGNED_INT };
+        GLsizei mInstanceCount{ 0 };
         GLenum mPrimitive{ GL_TRIANGLES };
     };
 }
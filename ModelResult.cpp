@@ -4,6 +4,58 @@
 
 using namespace asset;
 
+VertexAttributes& ModelMesh::Vertices() {
+    return mVertices;
+}
+
+const VertexAttributes& ModelMesh::Vertices() const {
+    return mVertices;
+}
+
+std::vector<std::uint32_t>& ModelMesh::Indices() {
+    return mIndices;
+}
+
+const std::vector<std::uint32_t>& ModelMesh::Indices() const {
+    return mIndices;
+}
+
+std::vector<ModelMesh::SubMesh>& ModelMesh::SubMeshes() {
+    return mSubMeshes;
+}
+
+const std::vector<ModelMesh::SubMesh>& ModelMesh::SubMeshes() const {
+    return mSubMeshes;
+}
+
+void ModelMesh::SetSubMeshes(std::vector<SubMesh> SubMeshes) {
+    mSubMeshes = std::move(SubMeshes);
+}
+
+const std::vector<ModelMesh::SubMesh>& ModelMesh::GetSubMeshes() const {
+    return mSubMeshes;
+}
+
+std::vector<ModelMesh::Meshlet>& ModelMesh::Meshlets() {
+    return mMeshlets;
+}
+
+const std::vector<ModelMesh::Meshlet>& ModelMesh::Meshlets() const {
+    return mMeshlets;
+}
+
+std::vector<ModelMesh::Lod>& ModelMesh::Lods() {
+    return mLods;
+}
+
+const std::vector<ModelMesh::Lod>& ModelMesh::Lods() const {
+    return mLods;
+}
+
+bool ModelMesh::Empty() const {
+    return mVertices.Empty() && mIndices.empty() && mSubMeshes.empty();
+}
+
 ModelNode::ModelNode(Id IdValue, std::string Name)
     : mId{ IdValue },
 	mName{ std::move(Name) } {
@@ -47,28 +99,16 @@ void ModelNode::AddChild(ModelNode* Child) {
     Child->mParent = this;
 }
 
-VertexAttributes& ModelNode::Vertices() {
-    return mVertices;
+std::uint32_t ModelNode::GetMeshIndex() const {
+    return mMeshIndex;
 }
 
-const VertexAttributes& ModelNode::Vertices() const {
-    return mVertices;
+void ModelNode::SetMeshIndex(std::uint32_t MeshIndex) {
+    mMeshIndex = MeshIndex;
 }
 
-std::vector<std::uint32_t>& ModelNode::Indices() {
-    return mIndices;
-}
-
-const std::vector<std::uint32_t>& ModelNode::Indices() const {
-    return mIndices;
-}
-
-std::vector<ModelNode::SubMesh>& ModelNode::SubMeshes() {
-    return mSubMeshes;
-}
-
-const std::vector<ModelNode::SubMesh>& ModelNode::SubMeshes() const {
-    return mSubMeshes;
+bool ModelNode::HasMesh() const {
+    return mMeshIndex != NoMesh;
 }
 
 std::vector<const ModelNode*> ModelNode::GetChildChain() const {
@@ -82,14 +122,6 @@ std::vector<const ModelNode*> ModelNode::GetChildChain() const {
     return Chain;
 }
 
-void ModelNode::SetSubMeshes(std::vector<SubMesh> SubMeshes) {
-    mSubMeshes = std::move(SubMeshes);
-}
-
-const std::vector<ModelNode::SubMesh>& ModelNode::GetSubMeshes() const {
-    return mSubMeshes;
-}
-
 ModelResult::ModelResult() = default;
 
 ModelNode* ModelResult::GetRoot() const {
@@ -134,3 +166,35 @@ void ModelResult::ForEachDfs(const std::function<void(ModelNode&)>& Function) co
         }
     }
 }
+
+std::uint32_t ModelResult::CreateMesh() {
+    const std::uint32_t MeshIndex{ static_cast<std::uint32_t>(mMeshes.size()) };
+    mMeshes.push_back(std::make_unique<ModelMesh>());
+    return MeshIndex;
+}
+
+std::size_t ModelResult::MeshCount() const {
+    return mMeshes.size();
+}
+
+ModelMesh& ModelResult::GetMesh(std::uint32_t MeshIndex) {
+    return *mMeshes[MeshIndex];
+}
+
+const ModelMesh& ModelResult::GetMesh(std::uint32_t MeshIndex) const {
+    return *mMeshes[MeshIndex];
+}
+
+ModelMesh* ModelResult::FindMesh(const ModelNode& Node) {
+    if (!Node.HasMesh() || Node.GetMeshIndex() >= mMeshes.size()) {
+        return nullptr;
+    }
+    return mMeshes[Node.GetMeshIndex()].get();
+}
+
+const ModelMesh* ModelResult::FindMesh(const ModelNode& Node) const {
+    if (!Node.HasMesh() || Node.GetMeshIndex() >= mMeshes.size()) {
+        return nullptr;
+    }
+    return mMeshes[Node.GetMeshIndex()].get();
+}
@@ -10,16 +10,95 @@
 #include "Common.h"
 
 namespace asset {
-    class ModelNode final {
+    // Vertex, index and submesh data. Owned by ModelResult and referenced by
+    // index from every node that instances it.
+    class ModelMesh final {
     public:
-        using Id = std::uint32_t;
+        // Index I of the SubMesh (and of its Lods and Meshlets) refers to
+        // vertex BaseVertex + I. The cook keeps BaseVertex at 0; files
+        // written with 16-bit indices set it per SubMesh.
         struct SubMesh final {
         public:
             std::size_t IndexOffset{ 0 };
             std::size_t IndexCount{ 0 };
             std::size_t MaterialIndex{ 0 };
+            std::size_t BaseVertex{ 0 };
+        };
+
+        // A run of consecutive triangles inside one SubMesh (see BuildMeshlets),
+        // with a bounding sphere and a normal cone for culling. The cluster is
+        // backfacing for every camera position P with
+        // dot(Center - P, ConeAxis) >= ConeCutoff * length(Center - P) + Radius.
+        struct Meshlet final {
+        public:
+            std::size_t IndexOffset{ 0 };
+            std::size_t IndexCount{ 0 };
+            Vec3 Center{};
+            float Radius{ 0.0f };
+            Vec3 ConeAxis{};
+            float ConeCutoff{ 1.0f };
         };
 
+        // A simplified copy of one SubMesh (see BuildLods). Its indices are
+        // appended after those of every SubMesh and use the same vertices and
+        // material. Error is how far, in mesh units, the level strays from
+        // the full SubMesh.
+        struct Lod final {
+        public:
+            std::size_t SubMeshIndex{ 0 };
+            std::size_t Level{ 0 };
+            std::size_t IndexOffset{ 0 };
+            std::size_t IndexCount{ 0 };
+            float Error{ 0.0f };
+        };
+
+    public:
+        ModelMesh() = default;
+        ~ModelMesh() = default;
+
+        ModelMesh(const ModelMesh& Other) = delete;
+        ModelMesh& operator=(const ModelMesh& Other) = delete;
+        ModelMesh(ModelMesh&& Other) = default;
+        ModelMesh& operator=(ModelMesh&& Other) = default;
+
+    public:
+        VertexAttributes& Vertices();
+        const VertexAttributes& Vertices() const;
+
+        std::vector<std::uint32_t>& Indices();
+        const std::vector<std::uint32_t>& Indices() const;
+
+        std::vector<SubMesh>& SubMeshes();
+        const std::vector<SubMesh>& SubMeshes() const;
+
+        void SetSubMeshes(std::vector<SubMesh> SubMeshes);
+        const std::vector<SubMesh>& GetSubMeshes() const;
+
+        // Sorted by IndexOffset; empty unless the mesh was cooked with meshlets.
+        std::vector<Meshlet>& Meshlets();
+        const std::vector<Meshlet>& Meshlets() const;
+
+        // Sorted by SubMeshIndex, then Level from 1 up; empty unless the mesh
+        // was cooked with LODs.
+        std::vector<Lod>& Lods();
+        const std::vector<Lod>& Lods() const;
+
+        // True when there is nothing to draw or store.
+        bool Empty() const;
+
+    private:
+        VertexAttributes mVertices{};
+        std::vector<std::uint32_t> mIndices{};
+        std::vector<SubMesh> mSubMeshes{};
+        std::vector<Meshlet> mMeshlets{};
+        std::vector<Lod> mLods{};
+    };
+
+    class ModelNode final {
+    public:
+        using Id = std::uint32_t;
+        static constexpr std::uint32_t NoMesh{ 0xFFFFFFFFu };
+
     public:
         ModelNode(Id IdValue, std::string Name);
         ~ModelNode() = default;
@@ -43,18 +122,12 @@ namespace asset {
         const std::vector<ModelNode*>& GetChildren() const;
         void AddChild(ModelNode* Child);
 
-        VertexAttributes& Vertices();
-        const VertexAttributes& Vertices() const;
-
-        std::vector<std::uint32_t>& Indices();
-        const std::vector<std::uint32_t>& Indices() const;
-
-        std::vector<SubMesh>& SubMeshes();
-        const std::vector<SubMesh>& SubMeshes() const;
+        // Index into ModelResult's mesh table, or NoMesh.
+        std::uint32_t GetMeshIndex() const;
+        void SetMeshIndex(std::uint32_t MeshIndex);
+        bool HasMesh() const;
 
         std::vector<const ModelNode*> GetChildChain() const;
-        void SetSubMeshes(std::vector<SubMesh> SubMeshes);
-        const std::vector<SubMesh>& GetSubMeshes() const;
 
     private:
         Id mId{ 0 };
@@ -66,9 +139,7 @@ namespace asset {
         ModelNode* mParent{ nullptr };
         std::vector<ModelNode*> mChildren{};
 
-        VertexAttributes mVertices{};
-        std::vector<std::uint32_t> mIndices{};
-        std::vector<SubMesh> mSubMeshes{};
+        std::uint32_t mMeshIndex{ NoMesh };
     };
 
     class ModelResult final {
@@ -89,8 +160,18 @@ namespace asset {
         ModelNode& CreateNode(std::string Name, ModelNode* Parent);
         void ForEachDfs(const std::function<void(ModelNode&)>& Function) const;
 
+        // Appends an empty mesh and returns its index.
+        std::uint32_t CreateMesh();
+        std::size_t MeshCount() const;
+        ModelMesh& GetMesh(std::uint32_t MeshIndex);
+        const ModelMesh& GetMesh(std::uint32_t MeshIndex) const;
+        // Null when Node has no mesh.
+        ModelMesh* FindMesh(const ModelNode& Node);
+        const ModelMesh* FindMesh(const ModelNode& Node) const;
+
     private:
         std::vector<std::unique_ptr<ModelNode>> mNodes{};
+        std::vector<std::unique_ptr<ModelMesh>> mMeshes{};
         ModelNode* mRoot{ nullptr };
         std::uint64_t mNextId{ 1 };
     };
@@ -0,0 +1,224 @@
+#include "OffsetAllocator.h"
+
+#include <bit>
+
+using namespace asset;
+
+namespace {
+    constexpr std::uint32_t MantissaBits{ 3 };
+    constexpr std::uint32_t MantissaValue{ 1u << MantissaBits };
+    constexpr std::uint32_t MantissaMask{ MantissaValue - 1 };
+
+    // Sizes below MantissaValue get a bin each; above, a bin covers sizes
+    // with the same top four bits. Rounding up gives the first bin whose
+    // every range fits Size, rounding down the bin a free range of Size
+    // belongs to.
+    std::uint32_t SizeToBin(std::uint32_t Size, bool RoundUp) {
+        if (Size < MantissaValue) {
+            return Size;
+        }
+        const std::uint32_t HighestBit{ 31u - static_cast<std::uint32_t>(std::countl_zero(Size)) };
+        const std::uint32_t MantissaStart{ HighestBit - MantissaBits };
+        const std::uint32_t Exponent{ MantissaStart + 1 };
+        std::uint32_t Mantissa{ (Size >> MantissaStart) & MantissaMask };
+        const std::uint32_t LowMask{ (1u << MantissaStart) - 1 };
+        if (RoundUp && (Size & LowMask) != 0) {
+            ++Mantissa;
+        }
+        // A mantissa that overflows carries into the exponent.
+        return (Exponent << MantissaBits) + Mantissa;
+    }
+
+    // Index of the lowest set bit of Mask at or above Start, or NoSpace.
+    std::uint32_t LowestBitFrom(std::uint32_t Mask, std::uint32_t Start) {
+        if (Start >= 32) {
+            return OffsetAllocator::NoSpace;
+        }
+        const std::uint32_t Masked{ Mask & (0xFFFFFFFFu << Start) };
+        return (Masked == 0) ? OffsetAllocator::NoSpace : static_cast<std::uint32_t>(std::countr_zero(Masked));
+    }
+}
+
+bool OffsetAllocator::Allocation::Valid() const {
+    return Node != NoSpace;
+}
+
+OffsetAllocator::OffsetAllocator(std::uint32_t Size) {
+    mBinHeads.fill(NoSpace);
+    Grow(Size);
+}
+
+OffsetAllocator::Allocation OffsetAllocator::Allocate(std::uint32_t Size) {
+    if (Size == 0 || Size > mFreeSize) {
+        return Allocation{};
+    }
+    // Smallest non-empty bin whose ranges all fit: first in the same
+    // exponent group, then in any larger one.
+    const std::uint32_t MinBin{ SizeToBin(Size, true) };
+    const std::uint32_t MinTop{ MinBin >> MantissaBits };
+    std::uint32_t Bin{ NoSpace };
+    if (MinTop < mUsedBins.size()) {
+        const std::uint32_t Leaf{ LowestBitFrom(mUsedBins[MinTop], MinBin & MantissaMask) };
+        if (Leaf != NoSpace) {
+            Bin = (MinTop << MantissaBits) | Leaf;
+        }
+    }
+    if (Bin == NoSpace) {
+        const std::uint32_t Top{ LowestBitFrom(mUsedTopBins, MinTop + 1) };
+        if (Top == NoSpace) {
+            return Allocation{};
+        }
+        Bin = (Top << MantissaBits) | static_cast<std::uint32_t>(std::countr_zero(static_cast<std::uint32_t>(mUsedBins[Top])));
+    }
+
+    const std::uint32_t Index{ mBinHeads[Bin] };
+    RemoveFree(Index);
+    const std::uint32_t Remainder{ mNodes[Index].Size - Size };
+    mNodes[Index].Size = Size;
+    mNodes[Index].Used = true;
+    mFreeSize -= Size;
+    if (Remainder > 0) {
+        const std::uint32_t Split{ CreateNode(mNodes[Index].Offset + Size, Remainder) };
+        mNodes[Split].NeighborPrevious = Index;
+        mNodes[Split].NeighborNext = mNodes[Index].NeighborNext;
+        if (mNodes[Index].NeighborNext != NoSpace) {
+            mNodes[mNodes[Index].NeighborNext].NeighborPrevious = Split;
+        }
+        mNodes[Index].NeighborNext = Split;
+        if (mLastNode == Index) {
+            mLastNode = Split;
+        }
+        InsertFree(Split);
+    }
+    return Allocation{ mNodes[Index].Offset, Index };
+}
+
+void OffsetAllocator::Free(const Allocation& Value) {
+    if (!Value.Valid() || Value.Node >= mNodes.size() || !mNodes[Value.Node].Used) {
+        return;
+    }
+    const std::uint32_t Index{ Value.Node };
+    mNodes[Index].Used = false;
+    mFreeSize += mNodes[Index].Size;
+
+    const std::uint32_t Previous{ mNodes[Index].NeighborPrevious };
+    if (Previous != NoSpace && !mNodes[Previous].Used) {
+        RemoveFree(Previous);
+        mNodes[Index].Offset = mNodes[Previous].Offset;
+        mNodes[Index].Size += mNodes[Previous].Size;
+        mNodes[Index].NeighborPrevious = mNodes[Previous].NeighborPrevious;
+        if (mNodes[Index].NeighborPrevious != NoSpace) {
+            mNodes[mNodes[Index].NeighborPrevious].NeighborNext = Index;
+        }
+        ReleaseNode(Previous);
+    }
+    const std::uint32_t Next{ mNodes[Index].NeighborNext };
+    if (Next != NoSpace && !mNodes[Next].Used) {
+        RemoveFree(Next);
+        mNodes[Index].Size += mNodes[Next].Size;
+        mNodes[Index].NeighborNext = mNodes[Next].NeighborNext;
+        if (mNodes[Index].NeighborNext != NoSpace) {
+            mNodes[mNodes[Index].NeighborNext].NeighborPrevious = Index;
+        }
+        if (mLastNode == Next) {
+            mLastNode = Index;
+        }
+        ReleaseNode(Next);
+    }
+    InsertFree(Index);
+}
+
+void OffsetAllocator::Grow(std::uint32_t NewSize) {
+    if (NewSize <= mSize) {
+        return;
+    }
+    const std::uint32_t Added{ NewSize - mSize };
+    mFreeSize += Added;
+    if (mLastNode != NoSpace && !mNodes[mLastNode].Used) {
+        RemoveFree(mLastNode);
+        mNodes[mLastNode].Size += Added;
+        InsertFree(mLastNode);
+    }
+    else {
+        const std::uint32_t Index{ CreateNode(mSize, Added) };
+        mNodes[Index].NeighborPrevious = mLastNode;
+        if (mLastNode != NoSpace) {
+            mNodes[mLastNode].NeighborNext = Index;
+        }
+        mLastNode = Index;
+        InsertFree(Index);
+    }
+    mSize = NewSize;
+}
+
+std::uint32_t OffsetAllocator::AllocationSize(const Allocation& Value) const {
+    if (!Value.Valid() || Value.Node >= mNodes.size()) {
+        return 0;
+    }
+    return mNodes[Value.Node].Size;
+}
+
+std::uint32_t OffsetAllocator::Size() const {
+    return mSize;
+}
+
+std::uint32_t OffsetAllocator::FreeSize() const {
+    return mFreeSize;
+}
+
+std::uint32_t OffsetAllocator::CreateNode(std::uint32_t Offset, std::uint32_t Size) {
+    std::uint32_t Index{ 0 };
+    if (mUnusedNodes.empty()) {
+        Index = static_cast<std::uint32_t>(mNodes.size());
+        mNodes.emplace_back();
+    }
+    else {
+        Index = mUnusedNodes.back();
+        mUnusedNodes.pop_back();
+        mNodes[Index] = Node{};
+    }
+    mNodes[Index].Offset = Offset;
+    mNodes[Index].Size = Size;
+    return Index;
+}
+
+void OffsetAllocator::ReleaseNode(std::uint32_t Index) {
+    mNodes[Index] = Node{};
+    mUnusedNodes.push_back(Index);
+}
+
+void OffsetAllocator::InsertFree(std::uint32_t Index) {
+    const std::uint32_t Bin{ SizeToBin(mNodes[Index].Size, false) };
+    const std::uint32_t Head{ mBinHeads[Bin] };
+    mNodes[Index].BinPrevious = NoSpace;
+    mNodes[Index].BinNext = Head;
+    if (Head != NoSpace) {
+        mNodes[Head].BinPrevious = Index;
+    }
+    mBinHeads[Bin] = Index;
+    mUsedBins[Bin >> MantissaBits] |= static_cast<std::uint8_t>(1u << (Bin & MantissaMask));
+    mUsedTopBins |= 1u << (Bin >> MantissaBits);
+}
+
+void OffsetAllocator::RemoveFree(std::uint32_t Index) {
+    Node& Target{ mNodes[Index] };
+    if (Target.BinPrevious != NoSpace) {
+        mNodes[Target.BinPrevious].BinNext = Target.BinNext;
+    }
+    else {
+        const std::uint32_t Bin{ SizeToBin(Target.Size, false) };
+        mBinHeads[Bin] = Target.BinNext;
+        if (Target.BinNext == NoSpace) {
+            const std::uint32_t Top{ Bin >> MantissaBits };
+            mUsedBins[Top] &= static_cast<std::uint8_t>(~(1u << (Bin & MantissaMask)));
+            if (mUsedBins[Top] == 0) {
+                mUsedTopBins &= ~(1u << Top);
+            }
+        }
+    }
+    if (Target.BinNext != NoSpace) {
+        mNodes[Target.BinNext].BinPrevious = Target.BinPrevious;
+    }
+    Target.BinPrevious = NoSpace;
+    Target.BinNext = NoSpace;
+}
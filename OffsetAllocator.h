@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace asset {
+    // Hands out ranges of an abstract address space [0, Size), such as the
+    // elements of a GPU buffer; it never touches the memory itself, so it
+    // works without a GL context. Free ranges sit in 256 size bins (a 5-bit
+    // exponent and a 3-bit mantissa, as in TLSF) found through two levels of
+    // bitmasks, which makes Allocate and Free constant time. Freed ranges
+    // merge with free neighbours. To stay constant time Allocate only takes
+    // from bins whose every range fits, so it can fail while a range less
+    // than 1/8 larger than asked for is free. Sizes must stay below 2^31.
+    // Not thread-safe.
+    class OffsetAllocator final {
+    public:
+        static constexpr std::uint32_t NoSpace{ 0xFFFFFFFFu };
+
+        struct Allocation final {
+        public:
+            std::uint32_t Offset{ NoSpace };
+            std::uint32_t Node{ NoSpace };
+
+            bool Valid() const;
+        };
+
+    public:
+        explicit OffsetAllocator(std::uint32_t Size = 0);
+        ~OffsetAllocator() = default;
+
+        OffsetAllocator(const OffsetAllocator& Other) = default;
+        OffsetAllocator& operator=(const OffsetAllocator& Other) = default;
+        OffsetAllocator(OffsetAllocator&& Other) noexcept = default;
+        OffsetAllocator& operator=(OffsetAllocator&& Other) noexcept = default;
+
+    public:
+        // An invalid Allocation when no free range fits Size, or Size is 0.
+        Allocation Allocate(std::uint32_t Size);
+        // Returns the range of Value; invalid allocations are ignored.
+        void Free(const Allocation& Value);
+        // Appends free space so the address space becomes [0, NewSize), for
+        // when the memory behind it has been enlarged. Smaller sizes are ignored.
+        void Grow(std::uint32_t NewSize);
+
+        std::uint32_t AllocationSize(const Allocation& Value) const;
+        std::uint32_t Size() const;
+        std::uint32_t FreeSize() const;
+
+    private:
+        static constexpr std::uint32_t BinCount{ 256 };
+
+        // Every range of the address space, used or free, is a node; nodes
+        // are linked to their address neighbours and free ones also into
+        // the list of their bin.
+        struct Node final {
+        public:
+            std::uint32_t Offset{ 0 };
+            std::uint32_t Size{ 0 };
+            std::uint32_t BinPrevious{ NoSpace };
+            std::uint32_t BinNext{ NoSpace };
+            std::uint32_t NeighborPrevious{ NoSpace };
+            std::uint32_t NeighborNext{ NoSpace };
+            bool Used{ false };
+        };
+
+    private:
+        std::uint32_t CreateNode(std::uint32_t Offset, std::uint32_t Size);
+        void ReleaseNode(std::uint32_t Index);
+        void InsertFree(std::uint32_t Index);
+        void RemoveFree(std::uint32_t Index);
+
+    private:
+        std::vector<Node> mNodes{};
+        std::vector<std::uint32_t> mUnusedNodes{};
+        std::array<std::uint32_t, BinCount> mBinHeads{};
+        // Bit T of mUsedTopBins is set when any bin of mUsedBins[T] is.
+        std::uint32_t mUsedTopBins{ 0 };
+        std::array<std::uint8_t, BinCount / 8> mUsedBins{};
+        // The node at the end of the address space, which Grow extends.
+        std::uint32_t mLastNode{ NoSpace };
+        std::uint32_t mSize{ 0 };
+        std::uint32_t mFreeSize{ 0 };
+    };
+}
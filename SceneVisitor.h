@@ -23,5 +23,8 @@ namespace asset {
     public:
         virtual void OnNodeBegin(const ufbx_scene& Scene, const ufbx_node& Node, const NodeVisitContext& Ctx) = 0;
         virtual void OnNodeEnd(const ufbx_scene& Scene, const ufbx_node& Node) = 0;
+        // Called once after the whole hierarchy has been visited, while the
+        // scene is still alive.
+        virtual void OnSceneEnd(const ufbx_scene& Scene) = 0;
     };
 }
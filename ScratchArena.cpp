@@ -0,0 +1,146 @@
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+using namespace asset;
+
+namespace {
+    // ufbx requires at least 8-byte alignment and stores SIMD-friendly data.
+    constexpr std::size_t UfbxAlignment{ alignof(std::max_align_t) };
+
+    // ufbx is C: running out of memory must come back as null so it can
+    // unwind and report the failure, never as an exception through its frames.
+    void* UfbxAlloc(void* User, std::size_t Size) {
+        try {
+            return static_cast<ScratchArena*>(User)->allocate(std::max<std::size_t>(Size, 1), UfbxAlignment);
+        }
+        catch (const std::bad_alloc&) {
+            return nullptr;
+        }
+    }
+
+    void* UfbxRealloc(void* User, void* OldPointer, std::size_t OldSize, std::size_t NewSize) {
+        void* NewPointer{ UfbxAlloc(User, NewSize) };
+        if (NewPointer != nullptr && OldPointer != nullptr) {
+            std::memcpy(NewPointer, OldPointer, std::min(OldSize, NewSize));
+        }
+        return NewPointer;
+    }
+
+    void UfbxFree(void* User, void* Pointer, std::size_t Size) {
+        static_cast<void>(User);
+        static_cast<void>(Pointer);
+        static_cast<void>(Size);
+    }
+}
+
+void ScratchArenaStats::Merge(const ScratchArenaStats& Other) {
+    Requests += Other.Requests;
+    SystemAllocations += Other.SystemAllocations;
+    PeakBytes = std::max(PeakBytes, Other.PeakBytes);
+}
+
+ScratchArena::ScratchArena(std::size_t InitialBlockSize)
+    : mNextBlockSize{ std::max<std::size_t>(InitialBlockSize, 4096) } {
+}
+
+ScratchArena::~ScratchArena() {
+    FreeBlocks();
+}
+
+void ScratchArena::Reset() {
+    if (mBlocks.size() > 1) {
+        std::size_t Total{ 0 };
+        for (const Block& Entry : mBlocks) {
+            Total += Entry.Size;
+        }
+        FreeBlocks();
+        AddBlock(Total);
+    }
+    mOffset = 0;
+    mUsedBytes = 0;
+}
+
+const ScratchArenaStats& ScratchArena::GetStats() const {
+    return mStats;
+}
+
+void ScratchArena::SetReserveLimit(std::size_t Limit) {
+    mReserveLimit = Limit;
+}
+
+ufbx_allocator_opts ScratchArena::UfbxAllocator() {
+    ufbx_allocator_opts Options{};
+    Options.allocator.alloc_fn = &UfbxAlloc;
+    Options.allocator.realloc_fn = &UfbxRealloc;
+    Options.allocator.free_fn = &UfbxFree;
+    Options.allocator.user = this;
+    return Options;
+}
+
+void* ScratchArena::do_allocate(std::size_t Bytes, std::size_t Alignment) {
+    ++mStats.Requests;
+    void* Pointer{ Bump(Bytes, Alignment) };
+    if (Pointer == nullptr) {
+        AddBlock(Bytes + Alignment);
+        Pointer = Bump(Bytes, Alignment);
+    }
+    return Pointer;
+}
+
+void ScratchArena::do_deallocate(void* Pointer, std::size_t Bytes, std::size_t Alignment) {
+    static_cast<void>(Pointer);
+    static_cast<void>(Bytes);
+    static_cast<void>(Alignment);
+}
+
+bool ScratchArena::do_is_equal(const std::pmr::memory_resource& Other) const noexcept {
+    return this == &Other;
+}
+
+void ScratchArena::AddBlock(std::size_t MinimumSize) {
+    std::size_t Size{ std::max(MinimumSize, mNextBlockSize) };
+    if (mReserveLimit != 0) {
+        // Doubling stops at the cap; the last block gets what is left.
+        const std::size_t Remaining{ mReserveLimit - std::min(mReservedBytes, mReserveLimit) };
+        if (MinimumSize > Remaining) {
+            throw std::bad_alloc{};
+        }
+        Size = std::min(Size, Remaining);
+    }
+    Block Entry{};
+    Entry.Data = static_cast<std::byte*>(::operator new(Size, std::align_val_t{ UfbxAlignment }));
+    Entry.Size = Size;
+    mBlocks.push_back(Entry);
+    mOffset = 0;
+    mReservedBytes += Size;
+    mNextBlockSize = Size * 2;
+    ++mStats.SystemAllocations;
+}
+
+void* ScratchArena::Bump(std::size_t Bytes, std::size_t Alignment) {
+    if (mBlocks.empty()) {
+        return nullptr;
+    }
+    const Block& Current{ mBlocks.back() };
+    const std::uintptr_t Base{ reinterpret_cast<std::uintptr_t>(Current.Data) };
+    const std::size_t Aligned{ static_cast<std::size_t>(((Base + mOffset + Alignment - 1) & ~(static_cast<std::uintptr_t>(Alignment) - 1)) - Base) };
+    if (Aligned > Current.Size || Bytes > Current.Size - Aligned) {
+        return nullptr;
+    }
+    mUsedBytes += Bytes + (Aligned - mOffset);
+    mOffset = Aligned + Bytes;
+    mStats.PeakBytes = std::max<std::uint64_t>(mStats.PeakBytes, mUsedBytes);
+    return Current.Data + Aligned;
+}
+
+void ScratchArena::FreeBlocks() {
+    for (const Block& Entry : mBlocks) {
+        ::operator delete(Entry.Data, std::align_val_t{ UfbxAlignment });
+    }
+    mBlocks.clear();
+    mOffset = 0;
+    mReservedBytes = 0;
+}
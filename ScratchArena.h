@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "Common.h"
+
+namespace asset {
+    struct ScratchArenaStats final {
+    public:
+        // Allocations served by the arena.
+        std::uint64_t Requests{ 0 };
+        // Blocks the arena had to take from the system to serve them.
+        std::uint64_t SystemAllocations{ 0 };
+        std::uint64_t PeakBytes{ 0 };
+
+        void Merge(const ScratchArenaStats& Other);
+    };
+
+    // Monotonic memory for the temporaries of one task. Allocation bumps a
+    // pointer through large blocks and deallocate does nothing; Reset rewinds
+    // for the next task and folds the blocks into one big enough for
+    // everything the last task used, so a long-lived arena stops touching the
+    // system allocator once it has seen its largest task. Not thread-safe.
+    class ScratchArena final : public std::pmr::memory_resource {
+    public:
+        explicit ScratchArena(std::size_t InitialBlockSize = 1 << 20);
+        ~ScratchArena() override;
+
+        ScratchArena(const ScratchArena& Other) = delete;
+        ScratchArena& operator=(const ScratchArena& Other) = delete;
+        ScratchArena(ScratchArena&& Other) = delete;
+        ScratchArena& operator=(ScratchArena&& Other) = delete;
+
+    public:
+        // Invalidates everything allocated since the last Reset.
+        void Reset();
+        const ScratchArenaStats& GetStats() const;
+        // Caps the bytes held in blocks; 0, the default, means no cap. Once a
+        // block would cross it the request fails with std::bad_alloc, which
+        // the ufbx callbacks turn into an out-of-memory error.
+        void SetReserveLimit(std::size_t Limit);
+
+        // Callbacks that route ufbx's own temporary allocations here. The
+        // arena must outlive every ufbx call that is given them.
+        ufbx_allocator_opts UfbxAllocator();
+
+    private:
+        struct Block final {
+        public:
+            std::byte* Data{ nullptr };
+            std::size_t Size{ 0 };
+        };
+
+    private:
+        void* do_allocate(std::size_t Bytes, std::size_t Alignment) override;
+        void do_deallocate(void* Pointer, std::size_t Bytes, std::size_t Alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& Other) const noexcept override;
+
+        // Null when the current block cannot fit the request.
+        void* Bump(std::size_t Bytes, std::size_t Alignment);
+        void AddBlock(std::size_t MinimumSize);
+        void FreeBlocks();
+
+    private:
+        std::vector<Block> mBlocks{};
+        std::size_t mOffset{ 0 };
+        std::size_t mUsedBytes{ 0 };
+        std::size_t mNextBlockSize{ 0 };
+        std::size_t mReservedBytes{ 0 };
+        std::size_t mReserveLimit{ 0 };
+        ScratchArenaStats mStats{};
+    };
+}
@@ -0,0 +1,179 @@
+#include "ThreadPool.h"
+
+#include <utility>
+
+using namespace asset;
+
+namespace {
+    thread_local const ThreadPool* CurrentPool{ nullptr };
+    thread_local std::size_t CurrentWorkerIndex{ 0 };
+}
+
+bool ThreadPool::TaskGroup::Done() const {
+    return mPending.load(std::memory_order_acquire) == 0;
+}
+
+ThreadPool::ThreadPool(std::size_t WorkerCount) {
+    if (WorkerCount == 0) {
+        WorkerCount = DefaultWorkerCount();
+    }
+    mQueues.reserve(WorkerCount);
+    for (std::size_t Index{ 0 }; Index < WorkerCount; ++Index) {
+        mQueues.push_back(std::make_unique<WorkQueue>());
+    }
+    mWorkers.reserve(WorkerCount);
+    for (std::size_t Index{ 0 }; Index < WorkerCount; ++Index) {
+        mWorkers.emplace_back([this, Index]() { WorkerLoop(Index); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> Lock{ mSleepMutex };
+        mStopping = true;
+    }
+    mWake.notify_all();
+    for (std::thread& Worker : mWorkers) {
+        if (Worker.joinable()) {
+            Worker.join();
+        }
+    }
+}
+
+std::size_t ThreadPool::DefaultWorkerCount() {
+    const unsigned int Count{ std::thread::hardware_concurrency() };
+    return Count == 0 ? 1 : static_cast<std::size_t>(Count);
+}
+
+std::size_t ThreadPool::GetWorkerCount() const {
+    return mWorkers.size();
+}
+
+void ThreadPool::Submit(TaskGroup& Group, Task Work) {
+    Group.mPending.fetch_add(1, std::memory_order_relaxed);
+    std::size_t QueueIndex{ CurrentQueueIndex() };
+    if (CurrentPool != this) {
+        QueueIndex = mNextQueue.fetch_add(1, std::memory_order_relaxed) % mQueues.size();
+    }
+    {
+        WorkQueue& Queue{ *mQueues[QueueIndex] };
+        std::lock_guard<std::mutex> Lock{ Queue.Mutex };
+        Queue.Tasks.push_back(QueuedTask{ std::move(Work), &Group });
+    }
+    {
+        std::lock_guard<std::mutex> Lock{ mSleepMutex };
+        mQueuedCount.fetch_add(1, std::memory_order_release);
+    }
+    mWake.notify_one();
+}
+
+void ThreadPool::Wait(TaskGroup& Group) {
+    while (!Group.Done()) {
+        if (TryRunOne()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> Lock{ mSleepMutex };
+        mWake.wait(Lock, [this, &Group]() { return Group.Done() || mQueuedCount.load(std::memory_order_acquire) > 0; });
+    }
+
+    std::exception_ptr Error{};
+    {
+        std::lock_guard<std::mutex> Lock{ Group.mErrorMutex };
+        Error = std::exchange(Group.mError, nullptr);
+    }
+    if (Error) {
+        std::rethrow_exception(Error);
+    }
+}
+
+void ThreadPool::ParallelFor(std::size_t Count, const std::function<void(std::size_t)>& Body) {
+    if (Count == 0) {
+        return;
+    }
+    if (Count == 1) {
+        Body(0);
+        return;
+    }
+    TaskGroup Group{};
+    for (std::size_t Index{ 0 }; Index < Count; ++Index) {
+        Submit(Group, [&Body, Index]() { Body(Index); });
+    }
+    Wait(Group);
+}
+
+void ThreadPool::WorkerLoop(std::size_t WorkerIndex) {
+    CurrentPool = this;
+    CurrentWorkerIndex = WorkerIndex;
+    while (true) {
+        if (TryRunOne()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> Lock{ mSleepMutex };
+        mWake.wait(Lock, [this]() { return mStopping || mQueuedCount.load(std::memory_order_acquire) > 0; });
+        if (mStopping && mQueuedCount.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::TryRunOne() {
+    const std::size_t QueueCount{ mQueues.size() };
+    const std::size_t Self{ CurrentQueueIndex() };
+    QueuedTask Entry{};
+    if (TryPop(Self, false, Entry)) {
+        Execute(Entry);
+        return true;
+    }
+    for (std::size_t Offset{ 1 }; Offset < QueueCount; ++Offset) {
+        if (TryPop((Self + Offset) % QueueCount, true, Entry)) {
+            Execute(Entry);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::TryPop(std::size_t QueueIndex, bool Steal, QueuedTask& OutTask) {
+    WorkQueue& Queue{ *mQueues[QueueIndex] };
+    std::lock_guard<std::mutex> Lock{ Queue.Mutex };
+    if (Queue.Tasks.empty()) {
+        return false;
+    }
+    if (Steal) {
+        OutTask = std::move(Queue.Tasks.front());
+        Queue.Tasks.pop_front();
+    }
+    else {
+        OutTask = std::move(Queue.Tasks.back());
+        Queue.Tasks.pop_back();
+    }
+    mQueuedCount.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void ThreadPool::Execute(QueuedTask& Entry) {
+    TaskGroup& Group{ *Entry.Group };
+    try {
+        Entry.Work();
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> Lock{ Group.mErrorMutex };
+        if (!Group.mError) {
+            Group.mError = std::current_exception();
+        }
+    }
+    Entry.Work = nullptr;
+    if (Group.mPending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        {
+            std::lock_guard<std::mutex> Lock{ mSleepMutex };
+        }
+        mWake.notify_all();
+    }
+}
+
+std::size_t ThreadPool::CurrentQueueIndex() const {
+    if (CurrentPool == this) {
+        return CurrentWorkerIndex;
+    }
+    return mNextQueue.load(std::memory_order_relaxed) % mQueues.size();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace asset {
+    // Work-stealing pool. Every worker owns a queue it pops from the back; idle
+    // workers steal from the front of the other queues. Threads that wait on a
+    // TaskGroup keep executing queued work, so waits may be nested inside tasks.
+    class ThreadPool final {
+    public:
+        using Task = std::function<void()>;
+
+        class TaskGroup final {
+        public:
+            TaskGroup() = default;
+            ~TaskGroup() = default;
+
+            TaskGroup(const TaskGroup& Other) = delete;
+            TaskGroup& operator=(const TaskGroup& Other) = delete;
+            TaskGroup(TaskGroup&& Other) = delete;
+            TaskGroup& operator=(TaskGroup&& Other) = delete;
+
+        public:
+            bool Done() const;
+
+        private:
+            friend class ThreadPool;
+
+            std::atomic<std::size_t> mPending{ 0 };
+            std::mutex mErrorMutex{};
+            std::exception_ptr mError{};
+        };
+
+    public:
+        explicit ThreadPool(std::size_t WorkerCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool& Other) = delete;
+        ThreadPool& operator=(const ThreadPool& Other) = delete;
+        ThreadPool(ThreadPool&& Other) = delete;
+        ThreadPool& operator=(ThreadPool&& Other) = delete;
+
+    public:
+        static std::size_t DefaultWorkerCount();
+
+        std::size_t GetWorkerCount() const;
+
+        void Submit(TaskGroup& Group, Task Work);
+        void Wait(TaskGroup& Group);
+        void ParallelFor(std::size_t Count, const std::function<void(std::size_t)>& Body);
+
+    private:
+        struct QueuedTask final {
+        public:
+            Task Work{};
+            TaskGroup* Group{ nullptr };
+        };
+
+        struct WorkQueue final {
+        public:
+            std::mutex Mutex{};
+            std::deque<QueuedTask> Tasks{};
+        };
+
+    private:
+        void WorkerLoop(std::size_t WorkerIndex);
+        bool TryRunOne();
+        bool TryPop(std::size_t QueueIndex, bool Steal, QueuedTask& OutTask);
+        void Execute(QueuedTask& Entry);
+        std::size_t CurrentQueueIndex() const;
+
+    private:
+        std::vector<std::unique_ptr<WorkQueue>> mQueues{};
+        std::vector<std::thread> mWorkers{};
+
+        std::mutex mSleepMutex{};
+        std::condition_variable mWake{};
+        std::atomic<std::size_t> mQueuedCount{ 0 };
+        std::atomic<std::size_t> mNextQueue{ 0 };
+        bool mStopping{ false };
+    };
+}
@@ -1,28 +1,179 @@
 #include "UfbxAssetLoader.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
 #include <string>
+#include <utility>
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <Windows.h>
+    #include <Psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
 
 using namespace asset;
 
 namespace {
+    // ufbx batches small allocations into chunks of up to 16MB, so the scene
+    // arena mostly sees a few large requests and its doubling blocks reach
+    // the size of a typical scene in a handful of system allocations.
+    constexpr std::size_t SceneArenaBlockSize{ std::size_t{ 1 } << 20 };
+
     std::string ToString(const ufbx_string& String) {
         if (String.data == nullptr) {
             return std::string{};
         }
         return std::string{ String.data, String.length };
     }
+
+    // Routes ufbx's batched parse tasks (deflate decoding, ASCII array parsing)
+    // onto the importer's worker pool. ufbx issues tasks in UFBX_THREAD_GROUP_COUNT
+    // rotating groups and waits on one group at a time.
+    struct UfbxThreadBridge final {
+    public:
+        ThreadPool* Pool{ nullptr };
+        std::array<ThreadPool::TaskGroup, UFBX_THREAD_GROUP_COUNT> Groups{};
+    };
+
+    void RunUfbxTasks(void* User, ufbx_thread_pool_context Context, std::uint32_t Group, std::uint32_t StartIndex, std::uint32_t Count) {
+        UfbxThreadBridge& Bridge{ *static_cast<UfbxThreadBridge*>(User) };
+        for (std::uint32_t Index{ StartIndex }; Index < StartIndex + Count; ++Index) {
+            Bridge.Pool->Submit(Bridge.Groups[Group], [Context, Index]() { ufbx_thread_pool_run_task(Context, Index); });
+        }
+    }
+
+    void WaitUfbxTasks(void* User, ufbx_thread_pool_context Context, std::uint32_t Group, std::uint32_t MaxIndex) {
+        static_cast<void>(Context);
+        static_cast<void>(MaxIndex);
+        UfbxThreadBridge& Bridge{ *static_cast<UfbxThreadBridge*>(User) };
+        Bridge.Pool->Wait(Bridge.Groups[Group]);
+    }
+
+    ufbx_progress_result ReportUfbxProgress(void* User, const ufbx_progress* Progress) {
+        ImportProgress Report{};
+        Report.Stage = ImportStage::Parse;
+        Report.BytesRead = Progress->bytes_read;
+        Report.BytesTotal = Progress->bytes_total;
+        const ImportProgressCallback& Callback{ *static_cast<const ImportProgressCallback*>(User) };
+        return Callback(Report) ? UFBX_PROGRESS_CONTINUE : UFBX_PROGRESS_CANCEL;
+    }
+
+    // ufbx frees and reallocates its temporaries throughout the parse, which
+    // a monotonic arena would never reclaim, so they stay on the heap and are
+    // only counted for ParseStats::TempBytes.
+    struct HeapUsage final {
+    public:
+        std::uint64_t Bytes{ 0 };
+        std::uint64_t PeakBytes{ 0 };
+    };
+
+    void* TrackedAlloc(void* User, std::size_t Size) {
+        void* Pointer{ std::malloc(std::max<std::size_t>(Size, 1)) };
+        if (Pointer != nullptr) {
+            HeapUsage& Usage{ *static_cast<HeapUsage*>(User) };
+            Usage.Bytes += Size;
+            Usage.PeakBytes = std::max(Usage.PeakBytes, Usage.Bytes);
+        }
+        return Pointer;
+    }
+
+    void* TrackedRealloc(void* User, void* OldPointer, std::size_t OldSize, std::size_t NewSize) {
+        void* NewPointer{ std::realloc(OldPointer, std::max<std::size_t>(NewSize, 1)) };
+        if (NewPointer != nullptr) {
+            HeapUsage& Usage{ *static_cast<HeapUsage*>(User) };
+            Usage.Bytes = Usage.Bytes - OldSize + NewSize;
+            Usage.PeakBytes = std::max(Usage.PeakBytes, Usage.Bytes);
+        }
+        return NewPointer;
+    }
+
+    void TrackedFree(void* User, void* Pointer, std::size_t Size) {
+        std::free(Pointer);
+        static_cast<HeapUsage*>(User)->Bytes -= Size;
+    }
+
+    ufbx_allocator_opts LimitedAllocator(ufbx_allocator_opts Options, const ParseLimits& Limits) {
+        Options.memory_limit = Limits.MemoryLimit;
+        Options.allocation_limit = Limits.AllocationLimit;
+        return Options;
+    }
+
+    ufbx_allocator_opts TrackedHeapAllocator(HeapUsage& Usage) {
+        ufbx_allocator_opts Options{};
+        Options.allocator.alloc_fn = &TrackedAlloc;
+        Options.allocator.realloc_fn = &TrackedRealloc;
+        Options.allocator.free_fn = &TrackedFree;
+        Options.allocator.user = &Usage;
+        return Options;
+    }
+
+    std::uint64_t ProcessPeakResidentBytes() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS Counters{};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters))) {
+            return 0;
+        }
+        return static_cast<std::uint64_t>(Counters.PeakWorkingSetSize);
+#else
+        rusage Usage{};
+        if (getrusage(RUSAGE_SELF, &Usage) != 0) {
+            return 0;
+        }
+#ifdef __APPLE__
+        return static_cast<std::uint64_t>(Usage.ru_maxrss);
+#else
+        return static_cast<std::uint64_t>(Usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+}
+
+namespace asset {
+    std::string_view ImportProfileName(ImportProfile Profile) {
+        switch (Profile) {
+        case ImportProfile::GeometryOnly:
+            return "geometry";
+        case ImportProfile::HierarchyOnly:
+            return "hierarchy";
+        case ImportProfile::Full:
+        default:
+            return "full";
+        }
+    }
+
+    std::optional<ImportProfile> ParseImportProfile(std::string_view Name) {
+        for (const ImportProfile Profile : { ImportProfile::Full, ImportProfile::GeometryOnly, ImportProfile::HierarchyOnly }) {
+            if (Name == ImportProfileName(Profile)) {
+                return Profile;
+            }
+        }
+        return std::nullopt;
+    }
 }
 
 UfbxAssetLoader::SceneHandle::SceneHandle()
     : mScene{ nullptr } {
 }
 
-UfbxAssetLoader::SceneHandle::SceneHandle(ufbx_scene* Scene)
-    : mScene{ Scene } {
+UfbxAssetLoader::SceneHandle::SceneHandle(ufbx_scene* Scene, std::unique_ptr<ScratchArena> Arena)
+    : mScene{ Scene }
+    , mArena{ std::move(Arena) } {
 }
 
 UfbxAssetLoader::SceneHandle::SceneHandle(SceneHandle&& Other) noexcept
-    : mScene{ Other.mScene } {
+    : mScene{ Other.mScene }
+    , mArena{ std::move(Other.mArena) } {
     Other.mScene = nullptr;
 }
 
@@ -30,6 +181,7 @@ UfbxAssetLoader::SceneHandle& UfbxAssetLoader::SceneHandle::operator=(SceneHandl
     if (this != &Other) {
         Reset();
         mScene = Other.mScene;
+        mArena = std::move(Other.mArena);
         Other.mScene = nullptr;
     }
     return *this;
@@ -48,12 +200,18 @@ void UfbxAssetLoader::SceneHandle::Reset() {
         ufbx_free_scene(mScene);
         mScene = nullptr;
     }
+    mArena.reset();
 }
 
 UfbxAssetLoader::UfbxAssetLoader(GraphicsAPI Api)
     : mApi{ Api } {
 }
 
+UfbxAssetLoader::UfbxAssetLoader(GraphicsAPI Api, ThreadPool* Pool)
+    : mApi{ Api }
+    , mThreadPool{ Pool } {
+}
+
 Mat4 UfbxAssetLoader::ToMat4(const ufbx_matrix& Matrix) {
     Mat4 Out{ 1.0f };
     Out.mValue[0][0] = static_cast<float>(Matrix.cols[0].x);
@@ -84,26 +242,98 @@ void UfbxAssetLoader::LoadAndTraverse(std::string_view FilePath, std::span<IScen
         Opts.target_axes = ufbx_axes_right_handed_y_up;
     }
     Opts.target_unit_meters = 1.0;
+    if (mProfile == ImportProfile::GeometryOnly) {
+        Opts.ignore_animation = true;
+        Opts.ignore_embedded = true;
+    }
+    else if (mProfile == ImportProfile::HierarchyOnly) {
+        Opts.ignore_all_content = true;
+    }
+    UfbxThreadBridge Bridge{};
+    if (mThreadPool != nullptr && mThreadPool->GetWorkerCount() > 1) {
+        Bridge.Pool = mThreadPool;
+        Opts.thread_opts.pool.run_fn = &RunUfbxTasks;
+        Opts.thread_opts.pool.wait_fn = &WaitUfbxTasks;
+        Opts.thread_opts.pool.user = &Bridge;
+    }
+    if (mProgress != nullptr && *mProgress) {
+        Opts.progress_cb.fn = &ReportUfbxProgress;
+        Opts.progress_cb.user = const_cast<ImportProgressCallback*>(mProgress);
+    }
+    // ufbx_load_memory still resolves external files relative to this.
+    Opts.filename = ufbx_string{ FilePath.data(), FilePath.size() };
+
+    mStats = ParseStats{};
+    const std::chrono::steady_clock::time_point ParseStart{ std::chrono::steady_clock::now() };
+    MappedFile Source{};
+    if (!Source.Open(std::string{ FilePath })) {
+        throw AssetError{ std::string{ "could not open FBX file: " } + std::string{ FilePath } };
+    }
+    // The scene arena never holds more than the memory limit, so the limit
+    // bounds what is reserved as well as what ufbx asks for.
+    std::size_t BlockSize{ SceneArenaBlockSize };
+    if (mLimits.MemoryLimit != 0) {
+        BlockSize = std::min(BlockSize, mLimits.MemoryLimit);
+    }
+    std::unique_ptr<ScratchArena> SceneArena{ std::make_unique<ScratchArena>(BlockSize) };
+    SceneArena->SetReserveLimit(mLimits.MemoryLimit);
+    HeapUsage TempUsage{};
+    Opts.temp_allocator = LimitedAllocator(TrackedHeapAllocator(TempUsage), mLimits);
+    Opts.result_allocator = LimitedAllocator(SceneArena->UfbxAllocator(), mLimits);
+
     ufbx_error Error{};
-    ufbx_scene* Scene{ ufbx_load_file(std::string{ FilePath }.c_str(), &Opts, &Error) };
+    ufbx_scene* Scene{ ufbx_load_memory(Source.Data(), Source.Size(), &Opts, &Error) };
     if (Scene == nullptr) {
+        if (Error.type == UFBX_ERROR_CANCELLED) {
+            throw AssetError{ "import cancelled" };
+        }
         std::string Description{ ToString(Error.description) };
         if (!Description.empty()) {
-            throw AssetError{ std::string{ "ufbx_load_file failed: " } + Description };
+            throw AssetError{ std::string{ "ufbx_load_memory failed: " } + Description };
         }
-        throw AssetError{ "ufbx_load_file failed: unknown error" };
+        throw AssetError{ "ufbx_load_memory failed: unknown error" };
     }
-    SceneHandle Handle{ Scene };
+    mStats.InputBytes = Source.Size();
+    mStats.ParseSeconds = std::chrono::duration<double>{ std::chrono::steady_clock::now() - ParseStart }.count();
+    mStats.TempBytes = TempUsage.PeakBytes;
+    mStats.SceneBytes = SceneArena->GetStats().PeakBytes;
+    mStats.PeakResidentBytes = ProcessPeakResidentBytes();
+    // The scene owns copies of everything it needs from the input, so it is
+    // not kept through the traversal.
+    Source.Close();
+    SceneHandle Handle{ Scene, std::move(SceneArena) };
     if (Handle.GetScene()->root_node != nullptr) {
         TraverseNode(*Handle.GetScene(), *Handle.GetScene()->root_node, nullptr, Visitors);
-        return;
     }
-    for (std::size_t Index{ 0 }; Index < Handle.GetScene()->nodes.count; ++Index) {
-        const ufbx_node* Node{ Handle.GetScene()->nodes.data[Index] };
-        if (Node != nullptr) {
-            TraverseNode(*Handle.GetScene(), *Node, Node->parent, Visitors);
+    else {
+        for (std::size_t Index{ 0 }; Index < Handle.GetScene()->nodes.count; ++Index) {
+            const ufbx_node* Node{ Handle.GetScene()->nodes.data[Index] };
+            if (Node != nullptr) {
+                TraverseNode(*Handle.GetScene(), *Node, Node->parent, Visitors);
+            }
         }
     }
+    for (ISceneNodeVisitor* Visitor : Visitors) {
+        if (Visitor != nullptr) {
+            Visitor->OnSceneEnd(*Handle.GetScene());
+        }
+    }
+}
+
+void UfbxAssetLoader::SetProfile(ImportProfile Profile) {
+    mProfile = Profile;
+}
+
+void UfbxAssetLoader::SetProgressCallback(const ImportProgressCallback* Callback) {
+    mProgress = Callback;
+}
+
+void UfbxAssetLoader::SetLimits(const ParseLimits& Limits) {
+    mLimits = Limits;
+}
+
+const ParseStats& UfbxAssetLoader::GetStats() const {
+    return mStats;
 }
 
 void UfbxAssetLoader::TraverseNode(const ufbx_scene& Scene, const ufbx_node& Node, const ufbx_node* Parent, std::span<ISceneNodeVisitor* const> Visitors) {
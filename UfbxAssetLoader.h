@@ -1,15 +1,60 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
 #include "Common.h"
 #include "SceneVisitor.h"
+#include "ScratchArena.h"
+#include "ThreadPool.h"
 
 namespace asset {
+    // How much of the scene ufbx is asked to load. Everything a profile skips
+    // is never decoded, and the importer drops the visitors that would have
+    // consumed it.
+    enum class ImportProfile : std::uint8_t {
+        // Everything ufbx can load.
+        Full,
+        // Hierarchy, meshes, skins and materials. Animation curves and
+        // embedded media are skipped; cooked output matches Full.
+        GeometryOnly,
+        // Node names and transforms only: no meshes and no materials.
+        HierarchyOnly,
+    };
+
+    std::string_view ImportProfileName(ImportProfile Profile);
+    std::optional<ImportProfile> ParseImportProfile(std::string_view Name);
+
+    // Caps handed to ufbx so one pathological file fails with an AssetError
+    // instead of exhausting memory for a whole batch. Each limit applies to
+    // ufbx's temporary and scene allocators separately; 0 means unlimited.
+    struct ParseLimits final {
+    public:
+        std::size_t MemoryLimit{ 0 };
+        std::size_t AllocationLimit{ 0 };
+    };
+
+    struct ParseStats final {
+    public:
+        std::uint64_t InputBytes{ 0 };
+        double ParseSeconds{ 0.0 };
+        // High-water marks of ufbx's temporary heap and of the scene arena.
+        std::uint64_t TempBytes{ 0 };
+        std::uint64_t SceneBytes{ 0 };
+        // Peak resident set of the whole process once the parse finished.
+        // Monotonic, and shared by every file parsed concurrently in a batch.
+        std::uint64_t PeakResidentBytes{ 0 };
+    };
+
     class UfbxAssetLoader final {
     private:
         struct SceneHandle final {
         public:
             SceneHandle();
-            explicit SceneHandle(ufbx_scene* Scene);
+            SceneHandle(ufbx_scene* Scene, std::unique_ptr<ScratchArena> Arena);
 
             SceneHandle(const SceneHandle& Other) = delete;
             SceneHandle& operator=(const SceneHandle& Other) = delete;
@@ -24,10 +69,14 @@ namespace asset {
 
         private:
             ufbx_scene* mScene{ nullptr };
+            // ufbx_free_scene calls back into the scene allocator, so the
+            // arena is released after the scene.
+            std::unique_ptr<ScratchArena> mArena{};
         };
 
     public:
         explicit UfbxAssetLoader(GraphicsAPI Api);
+        UfbxAssetLoader(GraphicsAPI Api, ThreadPool* Pool);
         ~UfbxAssetLoader() = default;
 
         UfbxAssetLoader(const UfbxAssetLoader& Other) = delete;
@@ -36,13 +85,27 @@ namespace asset {
         UfbxAssetLoader& operator=(UfbxAssetLoader&& Other) noexcept = default;
 
     public:
+        // Maps the file and parses it with ufbx_load_memory; ufbx's own
+        // allocations are served from large-block arenas.
         void LoadAndTraverse(std::string_view FilePath, std::span<ISceneNodeVisitor* const> Visitors);
 
+        void SetProfile(ImportProfile Profile);
+        void SetLimits(const ParseLimits& Limits);
+        // Receives ImportStage::Parse progress; may be null. Not owned.
+        void SetProgressCallback(const ImportProgressCallback* Callback);
+        // Parse of the last LoadAndTraverse; traversal is not included.
+        const ParseStats& GetStats() const;
+
     private:
         static Mat4 ToMat4(const ufbx_matrix& Matrix);
         void TraverseNode(const ufbx_scene& Scene, const ufbx_node& Node, const ufbx_node* Parent, std::span<ISceneNodeVisitor* const> Visitors);
 
     private:
         GraphicsAPI mApi{ GraphicsAPI::DirectX };
+        ThreadPool* mThreadPool{ nullptr };
+        ImportProfile mProfile{ ImportProfile::Full };
+        ParseLimits mLimits{};
+        const ImportProgressCallback* mProgress{ nullptr };
+        ParseStats mStats{};
     };
 }
@@ -0,0 +1,126 @@
+#include "VertexGather.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if !defined(UFBX_REAL_IS_FLOAT) && (defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ASSET_GATHER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    static_assert(sizeof(asset::Vec3) == sizeof(float) * 3);
+
+    asset::Vec3 NormalizeOne(const asset::Vec3& Value) {
+        const float LengthValue{ std::sqrt((Value.mX * Value.mX) + (Value.mY * Value.mY) + (Value.mZ * Value.mZ)) };
+        if (LengthValue <= 0.0f) {
+            return asset::Vec3{ 0.0f, 1.0f, 0.0f };
+        }
+        const float InvLength{ 1.0f / LengthValue };
+        return asset::Vec3{ Value.mX * InvLength, Value.mY * InvLength, Value.mZ * InvLength };
+    }
+
+#ifdef ASSET_GATHER_SSE2
+    static_assert(std::is_same_v<ufbx_real, double>);
+
+    __m128 LoadReal2(const ufbx_real* Source) {
+        return _mm_cvtpd_ps(_mm_loadu_pd(Source));
+    }
+#endif
+}
+
+namespace asset {
+    void GatherVertexVec2(const ufbx_vertex_vec2& Attribute, std::span<Vec2> Out) {
+        const ufbx_vec2* Values{ Attribute.values.data };
+        const std::uint32_t* Indices{ Attribute.indices.data };
+#ifdef ASSET_GATHER_SSE2
+        for (std::size_t Corner{ 0 }; Corner < Out.size(); ++Corner) {
+            _mm_storel_pi(reinterpret_cast<__m64*>(&Out[Corner]), LoadReal2(&Values[Indices[Corner]].x));
+        }
+#else
+        for (std::size_t Corner{ 0 }; Corner < Out.size(); ++Corner) {
+            const ufbx_vec2& Value{ Values[Indices[Corner]] };
+            Out[Corner] = Vec2{ static_cast<float>(Value.x), static_cast<float>(Value.y) };
+        }
+#endif
+    }
+
+    void GatherVertexVec3(const ufbx_vertex_vec3& Attribute, std::span<Vec3> Out) {
+        const ufbx_vec3* Values{ Attribute.values.data };
+        const std::uint32_t* Indices{ Attribute.indices.data };
+#ifdef ASSET_GATHER_SSE2
+        for (std::size_t Corner{ 0 }; Corner < Out.size(); ++Corner) {
+            const ufbx_real* Source{ &Values[Indices[Corner]].x };
+            _mm_storel_pi(reinterpret_cast<__m64*>(&Out[Corner].mX), LoadReal2(Source));
+            _mm_store_ss(&Out[Corner].mZ, _mm_cvtsd_ss(_mm_setzero_ps(), _mm_load_sd(Source + 2)));
+        }
+#else
+        for (std::size_t Corner{ 0 }; Corner < Out.size(); ++Corner) {
+            const ufbx_vec3& Value{ Values[Indices[Corner]] };
+            Out[Corner] = Vec3{ static_cast<float>(Value.x), static_cast<float>(Value.y), static_cast<float>(Value.z) };
+        }
+#endif
+    }
+
+    void GatherVertexVec4(const ufbx_vertex_vec4& Attribute, std::span<Vec4> Out) {
+        const ufbx_vec4* Values{ Attribute.values.data };
+        const std::uint32_t* Indices{ Attribute.indices.data };
+#ifdef ASSET_GATHER_SSE2
+        for (std::size_t Corner{ 0 }; Corner < Out.size(); ++Corner) {
+            const ufbx_real* Source{ &Values[Indices[Corner]].x };
+            _mm_storeu_ps(&Out[Corner].mX, _mm_movelh_ps(LoadReal2(Source), LoadReal2(Source + 2)));
+        }
+#else
+        for (std::size_t Corner{ 0 }; Corner < Out.size(); ++Corner) {
+            const ufbx_vec4& Value{ Values[Indices[Corner]] };
+            Out[Corner] = Vec4{ static_cast<float>(Value.x), static_cast<float>(Value.y), static_cast<float>(Value.z), static_cast<float>(Value.w) };
+        }
+#endif
+    }
+
+    void NormalizeVec3s(std::span<Vec3> Values) {
+        std::size_t Index{ 0 };
+#ifdef ASSET_GATHER_SSE2
+        float* Data{ reinterpret_cast<float*>(Values.data()) };
+        const __m128 Zero{ _mm_setzero_ps() };
+        const __m128 One{ _mm_set1_ps(1.0f) };
+        for (; Index + 4 <= Values.size(); Index += 4) {
+            float* Block{ Data + Index * 3 };
+            // x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3 -> X, Y, Z lanes.
+            const __m128 A{ _mm_loadu_ps(Block) };
+            const __m128 B{ _mm_loadu_ps(Block + 4) };
+            const __m128 C{ _mm_loadu_ps(Block + 8) };
+            const __m128 X2Y2X3Y3{ _mm_shuffle_ps(B, C, _MM_SHUFFLE(2, 1, 3, 2)) };
+            const __m128 Y0Z0Y1Z1{ _mm_shuffle_ps(A, B, _MM_SHUFFLE(1, 0, 2, 1)) };
+            const __m128 X{ _mm_shuffle_ps(A, X2Y2X3Y3, _MM_SHUFFLE(2, 0, 3, 0)) };
+            const __m128 Y{ _mm_shuffle_ps(Y0Z0Y1Z1, X2Y2X3Y3, _MM_SHUFFLE(3, 1, 2, 0)) };
+            const __m128 Z{ _mm_shuffle_ps(Y0Z0Y1Z1, C, _MM_SHUFFLE(3, 0, 3, 1)) };
+
+            // Same operation order as NormalizeOne so results are identical;
+            // NaN lengths fall through to the multiply there too.
+            const __m128 LengthSquared{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(X, X), _mm_mul_ps(Y, Y)), _mm_mul_ps(Z, Z)) };
+            const __m128 Length{ _mm_sqrt_ps(LengthSquared) };
+            const __m128 InvLength{ _mm_div_ps(One, Length) };
+            const __m128 Valid{ _mm_cmpnle_ps(Length, Zero) };
+            const __m128 NX{ _mm_and_ps(Valid, _mm_mul_ps(X, InvLength)) };
+            const __m128 NY{ _mm_or_ps(_mm_and_ps(Valid, _mm_mul_ps(Y, InvLength)), _mm_andnot_ps(Valid, One)) };
+            const __m128 NZ{ _mm_and_ps(Valid, _mm_mul_ps(Z, InvLength)) };
+
+            const __m128 X0Y0X1Y1{ _mm_unpacklo_ps(NX, NY) };
+            const __m128 X2Y2X3Y3Out{ _mm_unpackhi_ps(NX, NY) };
+            const __m128 Z0Z0X1X1{ _mm_shuffle_ps(NZ, X0Y0X1Y1, _MM_SHUFFLE(2, 2, 0, 0)) };
+            const __m128 Y1Y1Z1Z1{ _mm_shuffle_ps(X0Y0X1Y1, NZ, _MM_SHUFFLE(1, 1, 3, 3)) };
+            const __m128 Z2Z2X3X3{ _mm_shuffle_ps(NZ, X2Y2X3Y3Out, _MM_SHUFFLE(2, 2, 2, 2)) };
+            const __m128 Y3Y3Z3Z3{ _mm_shuffle_ps(X2Y2X3Y3Out, NZ, _MM_SHUFFLE(3, 3, 3, 3)) };
+            _mm_storeu_ps(Block, _mm_shuffle_ps(X0Y0X1Y1, Z0Z0X1X1, _MM_SHUFFLE(2, 0, 1, 0)));
+            _mm_storeu_ps(Block + 4, _mm_shuffle_ps(Y1Y1Z1Z1, X2Y2X3Y3Out, _MM_SHUFFLE(1, 0, 2, 0)));
+            _mm_storeu_ps(Block + 8, _mm_shuffle_ps(Z2Z2X3X3, Y3Y3Z3Z3, _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+#endif
+        for (; Index < Values.size(); ++Index) {
+            Values[Index] = NormalizeOne(Values[Index]);
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <span>
+
+#include "Common.h"
+
+namespace asset {
+    // Columnar corner gathers for MeshHierarchyBuilder: Out[i] is the
+    // attribute value of corner i, converted from ufbx_real to float, for
+    // every i < Out.size(). On SSE2 targets the index indirection and the
+    // double-to-float conversion run two lanes per instruction.
+    void GatherVertexVec2(const ufbx_vertex_vec2& Attribute, std::span<Vec2> Out);
+    void GatherVertexVec3(const ufbx_vertex_vec3& Attribute, std::span<Vec3> Out);
+    void GatherVertexVec4(const ufbx_vertex_vec4& Attribute, std::span<Vec4> Out);
+
+    // Normalises in place, four vectors per iteration on SSE2 targets.
+    // Zero-length vectors become +Y. Results match a scalar sqrt followed by
+    // a multiply with the reciprocal bit for bit.
+    void NormalizeVec3s(std::span<Vec3> Values);
+}
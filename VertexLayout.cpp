@@ -0,0 +1,66 @@
+#include "VertexLayout.h"
+
+#include <cstring>
+
+namespace {
+    // A constant Size lets the compiler turn each copy into plain moves.
+    template <std::size_t Size>
+    void ScatterElements(std::span<const std::byte> Source, std::byte* Destination, std::size_t Stride) {
+        const std::size_t Count{ Source.size() / Size };
+        for (std::size_t Vertex{ 0 }; Vertex < Count; ++Vertex) {
+            std::memcpy(Destination + Vertex * Stride, Source.data() + Vertex * Size, Size);
+        }
+    }
+}
+
+namespace asset {
+    const VertexLayoutAttribute* VertexLayout::Find(BinaryStream Stream) const {
+        for (const VertexLayoutAttribute& Attribute : Attributes) {
+            if (Attribute.Stream == Stream) {
+                return &Attribute;
+            }
+        }
+        return nullptr;
+    }
+
+    bool VertexLayout::Has(BinaryStream Stream) const {
+        return Find(Stream) != nullptr;
+    }
+
+    VertexLayout BuildVertexLayout(const PackedVertexView& Vertices) {
+        VertexLayout Layout{};
+        for (std::size_t Stream{ 0 }; Stream < Vertices.Streams.size(); ++Stream) {
+            const PackedVertexStream& Packed{ Vertices.Streams[Stream] };
+            if (Packed.Bytes.empty()) {
+                continue;
+            }
+            Layout.Attributes.push_back(VertexLayoutAttribute{ static_cast<BinaryStream>(Stream), Packed.Format, Layout.Stride });
+            Layout.Stride += static_cast<std::uint32_t>(BinaryElementSize(Packed.Format));
+        }
+        return Layout;
+    }
+
+    void InterleaveVertices(const PackedVertexView& Vertices, const VertexLayout& Layout, std::span<std::byte> Out) {
+        // Stream by stream, so each source is read front to back once.
+        for (const VertexLayoutAttribute& Attribute : Layout.Attributes) {
+            const std::span<const std::byte> Source{ Vertices.Get(Attribute.Stream).Bytes };
+            std::byte* Destination{ Out.data() + Attribute.Offset };
+            switch (BinaryElementSize(Attribute.Format)) {
+            case 4:
+                ScatterElements<4>(Source, Destination, Layout.Stride);
+                break;
+            case 8:
+                ScatterElements<8>(Source, Destination, Layout.Stride);
+                break;
+            case 12:
+                ScatterElements<12>(Source, Destination, Layout.Stride);
+                break;
+            case 16:
+                ScatterElements<16>(Source, Destination, Layout.Stride);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "AssetBinaryFormat.h"
+#include "VertexQuantization.h"
+
+namespace asset {
+    // One attribute of an interleaved vertex: the stream it comes from, its
+    // stored format and its byte offset inside the vertex. Its shader
+    // location is the BinaryStream value; see shaders/lit.vert.
+    struct VertexLayoutAttribute final {
+    public:
+        BinaryStream Stream{ BinaryStream::Positions };
+        BinaryElementFormat Format{ BinaryElementFormat::None };
+        std::uint32_t Offset{ 0 };
+
+        bool operator==(const VertexLayoutAttribute& Other) const = default;
+    };
+
+    // The streams a mesh carries packed into one vertex, in BinaryStream
+    // order and without padding. Every stored format is a multiple of four
+    // bytes, so every attribute stays 4-byte aligned. Meshes with equal
+    // layouts can share vertex array state.
+    struct VertexLayout final {
+    public:
+        std::vector<VertexLayoutAttribute> Attributes{};
+        std::uint32_t Stride{ 0 };
+
+        const VertexLayoutAttribute* Find(BinaryStream Stream) const;
+        bool Has(BinaryStream Stream) const;
+
+        bool operator==(const VertexLayout& Other) const = default;
+    };
+
+    // Layout of every stream present in Vertices.
+    VertexLayout BuildVertexLayout(const PackedVertexView& Vertices);
+
+    // Writes Vertices into Out in Layout, Stride bytes per vertex. Out must
+    // hold VertexCount() * Stride bytes.
+    void InterleaveVertices(const PackedVertexView& Vertices, const VertexLayout& Layout, std::span<std::byte> Out);
+}
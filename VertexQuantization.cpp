@@ -0,0 +1,412 @@
+#include "VertexQuantization.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+using namespace asset;
+
+namespace {
+    constexpr float Snorm16Scale{ 32767.0f };
+    constexpr float Unorm16Scale{ 65535.0f };
+    constexpr float Unorm8Scale{ 255.0f };
+
+    std::size_t StreamIndex(BinaryStream Stream) {
+        return static_cast<std::size_t>(Stream);
+    }
+
+    template <typename T>
+    PackedVertexStream MakeStream(std::span<const T> Values, BinaryElementFormat Format) {
+        if (Values.empty()) {
+            return PackedVertexStream{};
+        }
+        return PackedVertexStream{ std::as_bytes(Values), Format };
+    }
+
+    bool IsUnitRange(float Value) {
+        return Value >= 0.0f && Value <= 1.0f;
+    }
+
+    float SignNotZero(float Value) {
+        return Value >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    // Same steps as OctahedralDecode in shaders/lit.vert.
+    Vec3 DecodeOctahedral(std::int16_t EncodedX, std::int16_t EncodedY) {
+        const float X{ std::max(static_cast<float>(EncodedX) / Snorm16Scale, -1.0f) };
+        const float Y{ std::max(static_cast<float>(EncodedY) / Snorm16Scale, -1.0f) };
+        const float Z{ 1.0f - std::abs(X) - std::abs(Y) };
+        const float Fold{ std::max(-Z, 0.0f) };
+        const float FoldedX{ X >= 0.0f ? X - Fold : X + Fold };
+        const float FoldedY{ Y >= 0.0f ? Y - Fold : Y + Fold };
+        const float Length{ std::sqrt(FoldedX * FoldedX + FoldedY * FoldedY + Z * Z) };
+        return Vec3{ FoldedX / Length, FoldedY / Length, Z / Length };
+    }
+
+    // Projects onto the octahedron |x| + |y| + |z| = 1 and folds the lower
+    // half over the upper one. Of the four snorm16 neighbours of the exact
+    // point, the one that decodes closest to Value is kept. Angles this small
+    // are lost in a float dot product, so candidates are ranked by the
+    // tangent of their angle in double. Zero vectors encode as +Z.
+    std::array<std::int16_t, 2> EncodeOctahedral(const Vec3& Value) {
+        const float Sum{ std::abs(Value.mX) + std::abs(Value.mY) + std::abs(Value.mZ) };
+        if (!(Sum > 0.0f)) {
+            return std::array<std::int16_t, 2>{ 0, 0 };
+        }
+        float X{ Value.mX / Sum };
+        float Y{ Value.mY / Sum };
+        if (Value.mZ < 0.0f) {
+            const float FoldedX{ (1.0f - std::abs(Y)) * SignNotZero(X) };
+            const float FoldedY{ (1.0f - std::abs(X)) * SignNotZero(Y) };
+            X = FoldedX;
+            Y = FoldedY;
+        }
+        const float BaseX{ std::floor(std::clamp(X, -1.0f, 1.0f) * Snorm16Scale) };
+        const float BaseY{ std::floor(std::clamp(Y, -1.0f, 1.0f) * Snorm16Scale) };
+        std::array<std::int16_t, 2> Best{};
+        double BestTangent{ std::numeric_limits<double>::infinity() };
+        for (int Candidate{ 0 }; Candidate < 4; ++Candidate) {
+            const float CandidateX{ std::min(BaseX + static_cast<float>(Candidate & 1), Snorm16Scale) };
+            const float CandidateY{ std::min(BaseY + static_cast<float>(Candidate >> 1), Snorm16Scale) };
+            const std::int16_t EncodedX{ static_cast<std::int16_t>(CandidateX) };
+            const std::int16_t EncodedY{ static_cast<std::int16_t>(CandidateY) };
+            const Vec3 Decoded{ DecodeOctahedral(EncodedX, EncodedY) };
+            const double Dot{ static_cast<double>(Decoded.mX) * Value.mX + static_cast<double>(Decoded.mY) * Value.mY + static_cast<double>(Decoded.mZ) * Value.mZ };
+            const double CrossX{ static_cast<double>(Decoded.mY) * Value.mZ - static_cast<double>(Decoded.mZ) * Value.mY };
+            const double CrossY{ static_cast<double>(Decoded.mZ) * Value.mX - static_cast<double>(Decoded.mX) * Value.mZ };
+            const double CrossZ{ static_cast<double>(Decoded.mX) * Value.mY - static_cast<double>(Decoded.mY) * Value.mX };
+            const double Tangent{ std::sqrt(CrossX * CrossX + CrossY * CrossY + CrossZ * CrossZ) / Dot };
+            if (Dot > 0.0 && Tangent < BestTangent) {
+                BestTangent = Tangent;
+                Best = std::array<std::int16_t, 2>{ EncodedX, EncodedY };
+            }
+        }
+        return Best;
+    }
+
+    // Round to nearest even, with overflow to infinity and subnormals kept.
+    std::uint16_t FloatToHalf(float Value) {
+        const std::uint32_t Bits{ std::bit_cast<std::uint32_t>(Value) };
+        const std::uint32_t Sign{ (Bits >> 16) & 0x8000u };
+        const std::uint32_t Magnitude{ Bits & 0x7FFFFFFFu };
+        if (Magnitude >= 0x47800000u) {
+            return static_cast<std::uint16_t>(Sign | (Magnitude > 0x7F800000u ? 0x7E00u : 0x7C00u));
+        }
+        if (Magnitude < 0x38800000u) {
+            // Below the smallest normal half: count units of 2^-24.
+            const float Units{ std::nearbyint(std::bit_cast<float>(Magnitude) * 16777216.0f) };
+            return static_cast<std::uint16_t>(Sign | static_cast<std::uint32_t>(Units));
+        }
+        const std::uint32_t Rounded{ Magnitude + 0x0FFFu + ((Magnitude >> 13) & 1u) };
+        return static_cast<std::uint16_t>(Sign | ((Rounded - 0x38000000u) >> 13));
+    }
+
+    float HalfToFloat(std::uint16_t Value) {
+        const std::uint32_t Sign{ static_cast<std::uint32_t>(Value & 0x8000u) << 16 };
+        const std::uint32_t Exponent{ (Value >> 10) & 0x1Fu };
+        const std::uint32_t Mantissa{ Value & 0x03FFu };
+        if (Exponent == 0) {
+            const float Magnitude{ static_cast<float>(Mantissa) / 16777216.0f };
+            return Sign != 0 ? -Magnitude : Magnitude;
+        }
+        if (Exponent == 0x1Fu) {
+            return std::bit_cast<float>(Sign | 0x7F800000u | (Mantissa << 13));
+        }
+        return std::bit_cast<float>(Sign | ((Exponent + 112) << 23) | (Mantissa << 13));
+    }
+
+    std::uint16_t ToUnorm16(float Value) {
+        return static_cast<std::uint16_t>(std::lround(std::clamp(Value, 0.0f, 1.0f) * Unorm16Scale));
+    }
+
+    std::uint8_t ToUnorm8(float Value) {
+        return static_cast<std::uint8_t>(std::lround(std::clamp(Value, 0.0f, 1.0f) * Unorm8Scale));
+    }
+
+    // Rounding each weight alone can leave the sum at 253..257; the
+    // difference goes to the largest weight so the vertex keeps full weight.
+    std::array<std::uint8_t, 4> QuantizeWeights(const Vec4& Weights) {
+        const std::array<float, 4> Values{ Weights.mX, Weights.mY, Weights.mZ, Weights.mW };
+        const float Sum{ Values[0] + Values[1] + Values[2] + Values[3] };
+        std::array<std::uint8_t, 4> Quantized{};
+        if (!(Sum > 0.0f)) {
+            return Quantized;
+        }
+        int Total{ 0 };
+        std::size_t Largest{ 0 };
+        for (std::size_t Index{ 0 }; Index < Values.size(); ++Index) {
+            Quantized[Index] = ToUnorm8(Values[Index] / Sum);
+            Total += Quantized[Index];
+            if (Values[Index] > Values[Largest]) {
+                Largest = Index;
+            }
+        }
+        Quantized[Largest] = static_cast<std::uint8_t>(std::clamp(Quantized[Largest] + (255 - Total), 0, 255));
+        return Quantized;
+    }
+
+    BinaryElementFormat ChooseDirectionFormat(std::span<const Vec3> Values) {
+        return Values.empty() ? BinaryElementFormat::None : BinaryElementFormat::OctSnorm16;
+    }
+
+    BinaryElementFormat ChooseTexCoordFormat(std::span<const Vec2> Values) {
+        if (Values.empty()) {
+            return BinaryElementFormat::None;
+        }
+        bool UnitRange{ true };
+        bool HalfRange{ true };
+        for (const Vec2& Value : Values) {
+            UnitRange = UnitRange && IsUnitRange(Value.mX) && IsUnitRange(Value.mY);
+            HalfRange = HalfRange && std::abs(Value.mX) <= MaxHalfTexCoord && std::abs(Value.mY) <= MaxHalfTexCoord;
+            if (!HalfRange) {
+                return BinaryElementFormat::Float2;
+            }
+        }
+        return UnitRange ? BinaryElementFormat::Unorm16x2 : BinaryElementFormat::Half2;
+    }
+
+    BinaryElementFormat ChooseUnitVec4Format(std::span<const Vec4> Values) {
+        if (Values.empty()) {
+            return BinaryElementFormat::None;
+        }
+        const bool UnitRange{ std::all_of(Values.begin(), Values.end(), [](const Vec4& Value) {
+            return IsUnitRange(Value.mX) && IsUnitRange(Value.mY) && IsUnitRange(Value.mZ) && IsUnitRange(Value.mW);
+        }) };
+        return UnitRange ? BinaryElementFormat::Unorm8x4 : BinaryElementFormat::Float4;
+    }
+
+    BinaryElementFormat ChooseBoneIndexFormat(std::span<const UVec4> Values) {
+        if (Values.empty()) {
+            return BinaryElementFormat::None;
+        }
+        const bool ByteRange{ std::all_of(Values.begin(), Values.end(), [](const UVec4& Value) {
+            return std::max({ Value.mX, Value.mY, Value.mZ, Value.mW }) < 256u;
+        }) };
+        return ByteRange ? BinaryElementFormat::Uint8x4 : BinaryElementFormat::Uint4;
+    }
+
+    // Encodes Values element by element; Encode returns one element's bytes.
+    template <typename T, typename Encoder>
+    void EncodeStream(std::span<const T> Values, std::vector<std::byte>& Out, Encoder Encode) {
+        Out.resize(Values.size() * 4);
+        std::byte* Cursor{ Out.data() };
+        for (const T& Value : Values) {
+            const auto Element{ Encode(Value) };
+            static_assert(sizeof(Element) == 4);
+            std::memcpy(Cursor, &Element, sizeof(Element));
+            Cursor += sizeof(Element);
+        }
+    }
+
+    void QuantizeStream(std::span<const Vec3> Values, BinaryElementFormat Format, std::vector<std::byte>& Out) {
+        if (Format == BinaryElementFormat::OctSnorm16) {
+            EncodeStream(Values, Out, EncodeOctahedral);
+        }
+    }
+
+    void QuantizeStream(std::span<const Vec2> Values, BinaryElementFormat Format, std::vector<std::byte>& Out) {
+        if (Format == BinaryElementFormat::Half2) {
+            EncodeStream(Values, Out, [](const Vec2& Value) { return std::array<std::uint16_t, 2>{ FloatToHalf(Value.mX), FloatToHalf(Value.mY) }; });
+        }
+        else if (Format == BinaryElementFormat::Unorm16x2) {
+            EncodeStream(Values, Out, [](const Vec2& Value) { return std::array<std::uint16_t, 2>{ ToUnorm16(Value.mX), ToUnorm16(Value.mY) }; });
+        }
+    }
+
+    template <typename T, typename Decoder>
+    void DecodeStream(const PackedVertexStream& Stream, std::vector<T>& Out, Decoder Decode) {
+        Out.resize(Stream.Bytes.size() / 4);
+        const std::byte* Cursor{ Stream.Bytes.data() };
+        for (T& Value : Out) {
+            Value = Decode(Cursor);
+            Cursor += 4;
+        }
+    }
+
+    template <typename T>
+    void CopyStream(const PackedVertexStream& Stream, std::vector<T>& Out) {
+        Out.resize(Stream.Bytes.size() / sizeof(T));
+        if (!Out.empty()) {
+            std::memcpy(Out.data(), Stream.Bytes.data(), Stream.Bytes.size());
+        }
+    }
+
+    template <typename T>
+    std::array<T, 2> LoadPair(const std::byte* Bytes) {
+        std::array<T, 2> Pair{};
+        std::memcpy(Pair.data(), Bytes, sizeof(Pair));
+        return Pair;
+    }
+
+    void DequantizeStream(const PackedVertexStream& Stream, std::vector<Vec3>& Out) {
+        if (Stream.Format == BinaryElementFormat::Float3) {
+            CopyStream(Stream, Out);
+        }
+        else if (Stream.Format == BinaryElementFormat::OctSnorm16) {
+            DecodeStream(Stream, Out, [](const std::byte* Bytes) {
+                const std::array<std::int16_t, 2> Encoded{ LoadPair<std::int16_t>(Bytes) };
+                return DecodeOctahedral(Encoded[0], Encoded[1]);
+            });
+        }
+        else {
+            Out.clear();
+        }
+    }
+
+    void DequantizeStream(const PackedVertexStream& Stream, std::vector<Vec2>& Out) {
+        if (Stream.Format == BinaryElementFormat::Float2) {
+            CopyStream(Stream, Out);
+        }
+        else if (Stream.Format == BinaryElementFormat::Half2) {
+            DecodeStream(Stream, Out, [](const std::byte* Bytes) {
+                const std::array<std::uint16_t, 2> Encoded{ LoadPair<std::uint16_t>(Bytes) };
+                return Vec2{ HalfToFloat(Encoded[0]), HalfToFloat(Encoded[1]) };
+            });
+        }
+        else if (Stream.Format == BinaryElementFormat::Unorm16x2) {
+            DecodeStream(Stream, Out, [](const std::byte* Bytes) {
+                const std::array<std::uint16_t, 2> Encoded{ LoadPair<std::uint16_t>(Bytes) };
+                return Vec2{ static_cast<float>(Encoded[0]) / Unorm16Scale, static_cast<float>(Encoded[1]) / Unorm16Scale };
+            });
+        }
+        else {
+            Out.clear();
+        }
+    }
+
+    void DequantizeStream(const PackedVertexStream& Stream, std::vector<Vec4>& Out) {
+        if (Stream.Format == BinaryElementFormat::Float4) {
+            CopyStream(Stream, Out);
+        }
+        else if (Stream.Format == BinaryElementFormat::Unorm8x4) {
+            DecodeStream(Stream, Out, [](const std::byte* Bytes) {
+                const auto Channel = [&](std::size_t Index) { return static_cast<float>(std::to_integer<std::uint8_t>(Bytes[Index])) / Unorm8Scale; };
+                return Vec4{ Channel(0), Channel(1), Channel(2), Channel(3) };
+            });
+        }
+        else {
+            Out.clear();
+        }
+    }
+
+    void DequantizeStream(const PackedVertexStream& Stream, std::vector<UVec4>& Out) {
+        if (Stream.Format == BinaryElementFormat::Uint4) {
+            CopyStream(Stream, Out);
+        }
+        else if (Stream.Format == BinaryElementFormat::Uint8x4) {
+            DecodeStream(Stream, Out, [](const std::byte* Bytes) {
+                const auto Index = [&](std::size_t Component) { return static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(Bytes[Component])); };
+                return UVec4{ Index(0), Index(1), Index(2), Index(3) };
+            });
+        }
+        else {
+            Out.clear();
+        }
+    }
+}
+
+namespace asset {
+    PackedVertexView::PackedVertexView(const VertexAttributeView& Vertices) {
+        Streams[StreamIndex(BinaryStream::Positions)] = MakeStream(Vertices.Positions, BinaryElementFormat::Float3);
+        Streams[StreamIndex(BinaryStream::Normals)] = MakeStream(Vertices.Normals, BinaryElementFormat::Float3);
+        for (std::size_t Index{ 0 }; Index < Vertices.TexCoords.size(); ++Index) {
+            Streams[StreamIndex(BinaryStream::TexCoord0) + Index] = MakeStream(Vertices.TexCoords[Index], BinaryElementFormat::Float2);
+        }
+        Streams[StreamIndex(BinaryStream::Colors)] = MakeStream(Vertices.Colors, BinaryElementFormat::Float4);
+        Streams[StreamIndex(BinaryStream::Tangents)] = MakeStream(Vertices.Tangents, BinaryElementFormat::Float3);
+        Streams[StreamIndex(BinaryStream::Bitangents)] = MakeStream(Vertices.Bitangents, BinaryElementFormat::Float3);
+        Streams[StreamIndex(BinaryStream::BoneIndices)] = MakeStream(Vertices.BoneIndices, BinaryElementFormat::Uint4);
+        Streams[StreamIndex(BinaryStream::BoneWeights)] = MakeStream(Vertices.BoneWeights, BinaryElementFormat::Float4);
+    }
+
+    const PackedVertexStream& PackedVertexView::Get(BinaryStream Stream) const {
+        return Streams[StreamIndex(Stream)];
+    }
+
+    std::size_t PackedVertexView::VertexCount() const {
+        const PackedVertexStream& Positions{ Get(BinaryStream::Positions) };
+        return Positions.Format == BinaryElementFormat::Float3 ? Positions.Bytes.size() / sizeof(Vec3) : 0;
+    }
+
+    bool PackedVertexView::Empty() const {
+        return VertexCount() == 0;
+    }
+
+    std::size_t PackedVertexView::ByteSize() const {
+        std::size_t Bytes{ 0 };
+        for (const PackedVertexStream& Stream : Streams) {
+            Bytes += Stream.Bytes.size();
+        }
+        return Bytes;
+    }
+
+    std::size_t PackedVertexView::FloatByteSize() const {
+        std::size_t Bytes{ 0 };
+        for (std::size_t Index{ 0 }; Index < Streams.size(); ++Index) {
+            if (!Streams[Index].Bytes.empty()) {
+                Bytes += VertexCount() * BinaryElementSize(FloatVertexFormats[Index]);
+            }
+        }
+        return Bytes;
+    }
+
+    VertexFormats ChooseQuantizedFormats(const VertexAttributeView& Vertices) {
+        VertexFormats Formats{};
+        Formats[StreamIndex(BinaryStream::Positions)] = Vertices.Positions.empty() ? BinaryElementFormat::None : BinaryElementFormat::Float3;
+        Formats[StreamIndex(BinaryStream::Normals)] = ChooseDirectionFormat(Vertices.Normals);
+        for (std::size_t Index{ 0 }; Index < Vertices.TexCoords.size(); ++Index) {
+            Formats[StreamIndex(BinaryStream::TexCoord0) + Index] = ChooseTexCoordFormat(Vertices.TexCoords[Index]);
+        }
+        Formats[StreamIndex(BinaryStream::Colors)] = ChooseUnitVec4Format(Vertices.Colors);
+        Formats[StreamIndex(BinaryStream::Tangents)] = ChooseDirectionFormat(Vertices.Tangents);
+        Formats[StreamIndex(BinaryStream::Bitangents)] = ChooseDirectionFormat(Vertices.Bitangents);
+        Formats[StreamIndex(BinaryStream::BoneIndices)] = ChooseBoneIndexFormat(Vertices.BoneIndices);
+        Formats[StreamIndex(BinaryStream::BoneWeights)] = ChooseUnitVec4Format(Vertices.BoneWeights);
+        return Formats;
+    }
+
+    void QuantizeVertices(const VertexAttributeView& Vertices, const VertexFormats& Formats, QuantizedVertexStreams& Out) {
+        for (std::vector<std::byte>& Stream : Out) {
+            Stream.clear();
+        }
+        const auto FormatOf = [&](BinaryStream Stream) { return Formats[StreamIndex(Stream)]; };
+        const auto OutputOf = [&](BinaryStream Stream) -> std::vector<std::byte>& { return Out[StreamIndex(Stream)]; };
+
+        QuantizeStream(Vertices.Normals, FormatOf(BinaryStream::Normals), OutputOf(BinaryStream::Normals));
+        for (std::size_t Index{ 0 }; Index < Vertices.TexCoords.size(); ++Index) {
+            const BinaryStream Stream{ static_cast<BinaryStream>(StreamIndex(BinaryStream::TexCoord0) + Index) };
+            QuantizeStream(Vertices.TexCoords[Index], FormatOf(Stream), OutputOf(Stream));
+        }
+        if (FormatOf(BinaryStream::Colors) == BinaryElementFormat::Unorm8x4) {
+            EncodeStream(Vertices.Colors, OutputOf(BinaryStream::Colors), [](const Vec4& Value) {
+                return std::array<std::uint8_t, 4>{ ToUnorm8(Value.mX), ToUnorm8(Value.mY), ToUnorm8(Value.mZ), ToUnorm8(Value.mW) };
+            });
+        }
+        QuantizeStream(Vertices.Tangents, FormatOf(BinaryStream::Tangents), OutputOf(BinaryStream::Tangents));
+        QuantizeStream(Vertices.Bitangents, FormatOf(BinaryStream::Bitangents), OutputOf(BinaryStream::Bitangents));
+        if (FormatOf(BinaryStream::BoneIndices) == BinaryElementFormat::Uint8x4) {
+            EncodeStream(Vertices.BoneIndices, OutputOf(BinaryStream::BoneIndices), [](const UVec4& Value) {
+                return std::array<std::uint8_t, 4>{ static_cast<std::uint8_t>(Value.mX), static_cast<std::uint8_t>(Value.mY), static_cast<std::uint8_t>(Value.mZ), static_cast<std::uint8_t>(Value.mW) };
+            });
+        }
+        if (FormatOf(BinaryStream::BoneWeights) == BinaryElementFormat::Unorm8x4) {
+            EncodeStream(Vertices.BoneWeights, OutputOf(BinaryStream::BoneWeights), QuantizeWeights);
+        }
+    }
+
+    void DequantizeVertices(const PackedVertexView& Packed, VertexAttributes& Out) {
+        DequantizeStream(Packed.Get(BinaryStream::Positions), Out.Positions);
+        DequantizeStream(Packed.Get(BinaryStream::Normals), Out.Normals);
+        for (std::size_t Index{ 0 }; Index < Out.TexCoords.size(); ++Index) {
+            DequantizeStream(Packed.Streams[StreamIndex(BinaryStream::TexCoord0) + Index], Out.TexCoords[Index]);
+        }
+        DequantizeStream(Packed.Get(BinaryStream::Colors), Out.Colors);
+        DequantizeStream(Packed.Get(BinaryStream::Tangents), Out.Tangents);
+        DequantizeStream(Packed.Get(BinaryStream::Bitangents), Out.Bitangents);
+        DequantizeStream(Packed.Get(BinaryStream::BoneIndices), Out.BoneIndices);
+        DequantizeStream(Packed.Get(BinaryStream::BoneWeights), Out.BoneWeights);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "AssetBinaryFormat.h"
+#include "Common.h"
+
+namespace asset {
+    // Vertex streams are the BinaryStream values before Indices.
+    inline constexpr std::size_t VertexStreamCount{ static_cast<std::size_t>(BinaryStream::Indices) };
+
+    using VertexFormats = std::array<BinaryElementFormat, VertexStreamCount>;
+
+    // Format of each vertex stream when it is not quantised.
+    inline constexpr VertexFormats FloatVertexFormats{
+        BinaryElementFormat::Float3,
+        BinaryElementFormat::Float3,
+        BinaryElementFormat::Float2,
+        BinaryElementFormat::Float2,
+        BinaryElementFormat::Float2,
+        BinaryElementFormat::Float2,
+        BinaryElementFormat::Float4,
+        BinaryElementFormat::Float3,
+        BinaryElementFormat::Float3,
+        BinaryElementFormat::Uint4,
+        BinaryElementFormat::Float4,
+    };
+
+    // Texture coordinates up to this magnitude are stored as Half2, which
+    // rounds them by at most 2^-11.
+    inline constexpr float MaxHalfTexCoord{ 2.0f };
+
+    // One vertex stream as stored: tightly packed elements of Format.
+    struct PackedVertexStream final {
+    public:
+        std::span<const std::byte> Bytes{};
+        BinaryElementFormat Format{ BinaryElementFormat::None };
+    };
+
+    // Every vertex stream of a mesh in the format it is stored in, float or
+    // quantised, indexed by BinaryStream. This is what the viewer uploads.
+    struct PackedVertexView final {
+    public:
+        PackedVertexView() = default;
+        explicit PackedVertexView(const VertexAttributeView& Vertices);
+
+        std::array<PackedVertexStream, VertexStreamCount> Streams{};
+
+        const PackedVertexStream& Get(BinaryStream Stream) const;
+        std::size_t VertexCount() const;
+        bool Empty() const;
+        // Bytes over every present stream, and what the same streams take
+        // as float.
+        std::size_t ByteSize() const;
+        std::size_t FloatByteSize() const;
+    };
+
+    // Encoded bytes per vertex stream; empty for streams kept as float.
+    using QuantizedVertexStreams = std::array<std::vector<std::byte>, VertexStreamCount>;
+
+    // Picks the smallest format that holds each stream within the limits in
+    // AssetBinaryFormat.h: octahedral normals, tangents and bitangents,
+    // Unorm16x2 or Half2 texture coordinates, Unorm8x4 colours and weights
+    // and Uint8x4 bone indices. Streams whose values do not fit, such as
+    // colours above 1 or more than 256 bones, keep their float format; empty
+    // streams get None.
+    VertexFormats ChooseQuantizedFormats(const VertexAttributeView& Vertices);
+
+    // Encodes every stream whose entry in Formats is not its float format.
+    void QuantizeVertices(const VertexAttributeView& Vertices, const VertexFormats& Formats, QuantizedVertexStreams& Out);
+
+    // Expands Packed back into float streams, for consumers that need the
+    // values on the CPU. Streams absent from Packed are cleared in Out.
+    void DequantizeVertices(const PackedVertexView& Packed, VertexAttributes& Out);
+}
@@ -1,5 +1,6 @@
 #include "ViewerMath.h"
 
+#include <algorithm>
 #include <cstddef>
 
 namespace asset {
@@ -44,4 +45,36 @@ namespace asset {
     UVec4 ToAssetUVec4(const glm::uvec4& Value) {
         return UVec4{ Value.x, Value.y, Value.z, Value.w };
     }
+
+    FrustumPlanes ExtractFrustumPlanes(const glm::mat4& ViewProjection) {
+        const glm::vec4 Row0{ ViewProjection[0][0], ViewProjection[1][0], ViewProjection[2][0], ViewProjection[3][0] };
+        const glm::vec4 Row1{ ViewProjection[0][1], ViewProjection[1][1], ViewProjection[2][1], ViewProjection[3][1] };
+        const glm::vec4 Row2{ ViewProjection[0][2], ViewProjection[1][2], ViewProjection[2][2], ViewProjection[3][2] };
+        const glm::vec4 Row3{ ViewProjection[0][3], ViewProjection[1][3], ViewProjection[2][3], ViewProjection[3][3] };
+
+        FrustumPlanes Planes{ Row3 + Row0, Row3 - Row0, Row3 + Row1, Row3 - Row1, Row3 + Row2, Row3 - Row2 };
+        for (glm::vec4& Plane : Planes) {
+            const float Length{ glm::length(glm::vec3{ Plane }) };
+            if (Length > 0.0f) {
+                Plane /= Length;
+            }
+        }
+        return Planes;
+    }
+
+    bool SphereInFrustum(const FrustumPlanes& Planes, const glm::vec3& Center, float Radius) {
+        for (const glm::vec4& Plane : Planes) {
+            if (glm::dot(glm::vec3{ Plane }, Center) + Plane.w < -Radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    float MaxAxisScale(const glm::mat4& Transform) {
+        const float ScaleX{ glm::length(glm::vec3{ Transform[0] }) };
+        const float ScaleY{ glm::length(glm::vec3{ Transform[1] }) };
+        const float ScaleZ{ glm::length(glm::vec3{ Transform[2] }) };
+        return std::max(ScaleX, std::max(ScaleY, ScaleZ));
+    }
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include <glm/glm.hpp>
 
 #include "NumericTypes.h"
@@ -15,4 +17,11 @@ namespace asset {
     Vec3 ToAssetVec3(const glm::vec3& Value);
     Vec4 ToAssetVec4(const glm::vec4& Value);
     UVec4 ToAssetUVec4(const glm::uvec4& Value);
+
+    // Six normalized planes (left, right, bottom, top, near, far) facing inward.
+    using FrustumPlanes = std::array<glm::vec4, 6>;
+    FrustumPlanes ExtractFrustumPlanes(const glm::mat4& ViewProjection);
+    bool SphereInFrustum(const FrustumPlanes& Planes, const glm::vec3& Center, float Radius);
+    // Largest axis scale of an affine transform, for scaling bounding radii.
+    float MaxAxisScale(const glm::mat4& Transform);
 }
@@ -1,9 +1,17 @@
+#include <algorithm>
 #include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
 #include <filesystem>
-#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <optional>
+#include <span>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <glad/glad.h>
@@ -20,12 +28,16 @@
 
 #include "Camera.h"
 #include "AssetBinaryReader.h"
-#include "AssetBinaryWriter.h"
+#include "AssetBinaryView.h"
 #include "AssetBundle.h"
+#include "BatchConverter.h"
 #include "Common.h"
 #include "FbxAssetImporter.h"
 #include "FontAtlas.h"
+#include "GeometryArena.h"
 #include "Input.h"
+#include "LodSelection.h"
+#include "MeshletCulling.h"
 #include "Model.h"
 #include "Renderer.h"
 #include "Shader.h"
@@ -53,10 +65,27 @@ namespace {
         Vertices.BoneWeights.push_back(BoneWeights);
     }
 
+    // One entry per mesh; every node that references the mesh is an instance
+    // drawn by the same instanced call.
     struct ModelEntry final {
     public:
         asset::Model Model{};
-        const asset::ModelNode* Node{ nullptr };
+        const asset::ModelMesh* Mesh{ nullptr };
+        std::vector<glm::mat4> InstanceTransforms{};
+        // Non-resident entries are uploaded from the mapped file the first time
+        // the bounds of any instance intersect the view frustum.
+        std::uint32_t GeometryIndex{ asset::BinaryNoGeometry };
+        bool Resident{ true };
+        glm::vec3 BoundsCenter{ 0.0f };
+        float BoundsRadius{ 0.0f };
+        // Empty unless the mesh was cooked with LODs. While InstanceLevels is
+        // set, the uploaded instances are SortedTransforms, grouped by level
+        // with LevelInstanceCounts[L] instances at level L.
+        std::vector<asset::LodLevel> LodLevels{};
+        std::vector<std::size_t> InstanceLevels{};
+        std::vector<std::size_t> SelectedLevels{};
+        std::vector<std::size_t> LevelInstanceCounts{};
+        std::vector<glm::mat4> SortedTransforms{};
     };
 
     std::optional<std::string> FindMaterialTextureName(const asset::Material& MaterialData) {
@@ -206,32 +235,269 @@ namespace {
         glViewport(0, 0, Width, Height);
     }
 
-    std::vector<std::string> LoadListEntries(const std::string& ListPath) {
-        std::vector<std::string> Entries{};
-        std::ifstream Input{ ListPath };
-        if (!Input.is_open()) {
-            return Entries;
+    // Unsigned decimal; values that do not fit std::size_t are rejected.
+    std::optional<std::size_t> ParseCount(std::string_view Text) {
+        std::size_t Value{ 0 };
+        const char* End{ Text.data() + Text.size() };
+        const std::from_chars_result Parsed{ std::from_chars(Text.data(), End, Value) };
+        if (Text.empty() || Parsed.ec != std::errc{} || Parsed.ptr != End) {
+            return std::nullopt;
         }
-        std::string Line{};
-        while (std::getline(Input, Line)) {
-            if (!Line.empty()) {
-                Entries.push_back(Line);
+        return Value;
+    }
+
+    // Non-negative decimal such as "0.5" or "30"; 0 leaves the budget off.
+    std::optional<double> ParseSeconds(std::string_view Text) {
+        double Value{ 0.0 };
+        const char* End{ Text.data() + Text.size() };
+        const std::from_chars_result Parsed{ std::from_chars(Text.data(), End, Value, std::chars_format::fixed) };
+        if (Text.empty() || Parsed.ec != std::errc{} || Parsed.ptr != End || !std::isfinite(Value) || Value < 0.0) {
+            return std::nullopt;
+        }
+        return Value;
+    }
+
+    void ConvertListFile(const Fs::path& ListPath, const asset::BatchConvertOptions& Options) {
+        const std::vector<asset::ConvertJob> Jobs{ asset::BatchConverter::LoadJobList(ListPath, std::cout) };
+        if (Jobs.empty()) {
+            return;
+        }
+        const auto Start{ std::chrono::steady_clock::now() };
+        asset::BatchConverter Converter{ Options };
+        const std::vector<asset::ConvertResult> Results{ Converter.Run(Jobs, std::cout) };
+        const std::chrono::duration<double> Elapsed{ std::chrono::steady_clock::now() - Start };
+        asset::BatchConverter::PrintSummary(Results, Elapsed.count(), std::cout);
+    }
+
+    // FBXLoader --convert <list.txt> [--jobs N] [--max-inflight N] [--force] [--compress] [--optimize] [--meshlets] [--lods] [--quantize] [--index32] [--split-indices] [--profile full|geometry|hierarchy] [--time-budget SECONDS] [--memory-limit MB] [--allocation-limit N]
+    int RunHeadlessConvert(int ArgCount, char** ArgValues) {
+        if (ArgCount < 3) {
+            std::cerr << "Usage: --convert <list.txt> [--jobs N] [--max-inflight N] [--force] [--compress] [--optimize] [--meshlets] [--lods] [--quantize] [--index32] [--split-indices] [--profile full|geometry|hierarchy] [--time-budget SECONDS] [--memory-limit MB] [--allocation-limit N]\n";
+            return 1;
+        }
+        asset::BatchConvertOptions Options{};
+        for (int Index{ 3 }; Index < ArgCount; ++Index) {
+            const std::string_view Flag{ ArgValues[Index] };
+            if (Flag == "--force") {
+                Options.Incremental = false;
+                continue;
+            }
+            if (Flag == "--compress") {
+                Options.Compress = true;
+                continue;
+            }
+            if (Flag == "--optimize") {
+                Options.OptimizeMeshes = true;
+                continue;
+            }
+            if (Flag == "--meshlets") {
+                Options.BuildMeshlets = true;
+                continue;
+            }
+            if (Flag == "--lods") {
+                Options.BuildLods = true;
+                continue;
+            }
+            if (Flag == "--quantize") {
+                Options.QuantizeVertices = true;
+                continue;
+            }
+            if (Flag == "--index32") {
+                Options.ShortIndices = false;
+                continue;
             }
+            if (Flag == "--split-indices") {
+                Options.SplitForShortIndices = true;
+                continue;
+            }
+            if (Index + 1 >= ArgCount) {
+                std::cerr << "Missing value for " << Flag << "\n";
+                return 1;
+            }
+            if (Flag == "--profile") {
+                const std::optional<asset::ImportProfile> Profile{ asset::ParseImportProfile(ArgValues[Index + 1]) };
+                if (!Profile.has_value()) {
+                    std::cerr << "Invalid value for " << Flag << ": " << ArgValues[Index + 1] << "\n";
+                    return 1;
+                }
+                Options.Profile = Profile.value();
+                ++Index;
+                continue;
+            }
+            if (Flag == "--time-budget") {
+                const std::optional<double> Seconds{ ParseSeconds(ArgValues[Index + 1]) };
+                if (!Seconds.has_value()) {
+                    std::cerr << "Invalid value for " << Flag << ": " << ArgValues[Index + 1] << "\n";
+                    return 1;
+                }
+                Options.TimeBudgetSeconds = Seconds.value();
+                ++Index;
+                continue;
+            }
+            const std::optional<std::size_t> Value{ ParseCount(ArgValues[Index + 1]) };
+            if (!Value.has_value()) {
+                std::cerr << "Invalid value for " << Flag << ": " << ArgValues[Index + 1] << "\n";
+                return 1;
+            }
+            if (Flag == "--jobs") {
+                Options.WorkerCount = Value.value();
+            }
+            else if (Flag == "--max-inflight") {
+                Options.MaxInFlight = Value.value();
+            }
+            else if (Flag == "--memory-limit") {
+                constexpr std::size_t BytesPerMegabyte{ 1024 * 1024 };
+                if (Value.value() > std::numeric_limits<std::size_t>::max() / BytesPerMegabyte) {
+                    std::cerr << "Invalid value for " << Flag << ": " << ArgValues[Index + 1] << "\n";
+                    return 1;
+                }
+                Options.Limits.MemoryLimit = Value.value() * BytesPerMegabyte;
+            }
+            else if (Flag == "--allocation-limit") {
+                Options.Limits.AllocationLimit = Value.value();
+            }
+            else {
+                std::cerr << "Unknown option: " << Flag << "\n";
+                return 1;
+            }
+            ++Index;
         }
-        return Entries;
+        ConvertListFile(Fs::path{ ArgValues[2] }, Options);
+        return 0;
     }
 
-    Fs::path MakeBinaryPath(const Fs::path& FbxPath) {
-        Fs::path OutputPath{ FbxPath };
-        OutputPath.replace_extension(".fbxbin");
-        return OutputPath;
+    // Comma-separated list such as "1,2,4,8"; Parse turns one item into a value.
+    template <typename T, typename ParseItem>
+    std::optional<std::vector<T>> ParseList(std::string_view Text, ParseItem Parse) {
+        std::vector<T> Values{};
+        while (true) {
+            const std::size_t Comma{ Text.find(',') };
+            const std::optional<T> Value{ Parse(Text.substr(0, Comma)) };
+            if (!Value.has_value()) {
+                return std::nullopt;
+            }
+            Values.push_back(Value.value());
+            if (Comma == std::string_view::npos) {
+                return Values;
+            }
+            Text.remove_prefix(Comma + 1);
+        }
     }
 
-    bool ConvertFbxToBinary(const Fs::path& FbxPath, const Fs::path& BinaryPath) {
-        asset::FbxAssetImporter Importer{ asset::GraphicsAPI::OpenGL };
-        asset::AssetBundle Bundle{ Importer.LoadFromFile(FbxPath.string()) };
-        asset::AssetBinaryWriter Writer{};
-        return Writer.WriteToFile(BinaryPath.string(), Bundle);
+    // Imports File once per profile and worker count, keeping the best of
+    // Repeat runs, and prints parse, mesh extraction and total import time
+    // with the parse speedup over the first worker count of the list.
+    // Profiles default to the converter's GeometryOnly. The mesh, SubMesh and
+    // triangle counts of each profile put the extraction time in context,
+    // e.g. the same geometry split over many materials.
+    void BenchmarkParse(const std::string& File, std::span<const std::size_t> WorkerCounts, std::span<const asset::ImportProfile> Profiles, std::size_t Repeat) {
+        const double FileMegabytes{ static_cast<double>(Fs::file_size(File)) / (1024.0 * 1024.0) };
+        std::cout << File << std::fixed << std::setprecision(1) << " (" << FileMegabytes << " MB), best of " << Repeat
+            << ", hardware threads: " << asset::ThreadPool::DefaultWorkerCount() << "\n";
+        for (const asset::ImportProfile Profile : Profiles) {
+            std::size_t MeshCount{ 0 };
+            std::size_t SubMeshCount{ 0 };
+            std::size_t TriangleCount{ 0 };
+            std::ostringstream Rows{};
+            Rows << std::fixed;
+            double BaselineParseSeconds{ 0.0 };
+            for (const std::size_t WorkerCount : WorkerCounts) {
+                double ParseSeconds{ std::numeric_limits<double>::max() };
+                double ImportSeconds{ std::numeric_limits<double>::max() };
+                double ExtractSeconds{ std::numeric_limits<double>::max() };
+                for (std::size_t Run{ 0 }; Run < Repeat; ++Run) {
+                    asset::FbxAssetImporter Importer{ asset::GraphicsAPI::OpenGL };
+                    Importer.SetWorkerCount(WorkerCount);
+                    Importer.SetProfile(Profile);
+                    const auto Start{ std::chrono::steady_clock::now() };
+                    const asset::AssetBundle Bundle{ Importer.LoadFromFile(File) };
+                    const std::chrono::duration<double> Elapsed{ std::chrono::steady_clock::now() - Start };
+                    const double RunParseSeconds{ Importer.GetParseStats().ParseSeconds };
+                    ParseSeconds = std::min(ParseSeconds, RunParseSeconds);
+                    ImportSeconds = std::min(ImportSeconds, Elapsed.count());
+                    ExtractSeconds = std::min(ExtractSeconds, Elapsed.count() - RunParseSeconds);
+                    const asset::ModelResult& Meshes{ Bundle.GetModelResult() };
+                    MeshCount = Meshes.MeshCount();
+                    SubMeshCount = 0;
+                    TriangleCount = 0;
+                    for (std::uint32_t MeshIndex{ 0 }; MeshIndex < Meshes.MeshCount(); ++MeshIndex) {
+                        for (const asset::ModelMesh::SubMesh& SubMesh : Meshes.GetMesh(MeshIndex).GetSubMeshes()) {
+                            ++SubMeshCount;
+                            TriangleCount += SubMesh.IndexCount / 3;
+                        }
+                    }
+                }
+                if (BaselineParseSeconds == 0.0) {
+                    BaselineParseSeconds = ParseSeconds;
+                }
+                const double Speedup{ (ParseSeconds > 0.0) ? BaselineParseSeconds / ParseSeconds : 0.0 };
+                Rows << "    workers " << std::setw(2) << WorkerCount << std::setprecision(1)
+                    << ": parse " << std::setw(7) << ParseSeconds * 1000.0 << " ms"
+                    << ", extract " << std::setw(7) << ExtractSeconds * 1000.0 << " ms"
+                    << ", import " << std::setw(7) << ImportSeconds * 1000.0 << " ms"
+                    << ", parse speedup " << std::setprecision(2) << Speedup << "x\n";
+            }
+            std::cout << "  " << asset::ImportProfileName(Profile) << ": " << MeshCount << " meshes, " << SubMeshCount << " SubMeshes, "
+                << TriangleCount << " triangles\n" << Rows.str();
+        }
+        std::cout << std::defaultfloat;
+    }
+
+    // FBXLoader --bench-parse <file.fbx> [--workers N,N,...] [--profile full|geometry|hierarchy[,...]] [--repeat N]
+    int RunParseBenchmark(int ArgCount, char** ArgValues) {
+        if (ArgCount < 3) {
+            std::cerr << "Usage: --bench-parse <file.fbx> [--workers N,N,...] [--profile full|geometry|hierarchy[,...]] [--repeat N]\n";
+            return 1;
+        }
+        std::vector<std::size_t> WorkerCounts{ 1, 2, 4, 8 };
+        std::vector<asset::ImportProfile> Profiles{ asset::ImportProfile::GeometryOnly };
+        std::size_t Repeat{ 3 };
+        for (int Index{ 3 }; Index < ArgCount; Index += 2) {
+            const std::string_view Flag{ ArgValues[Index] };
+            if (Index + 1 >= ArgCount) {
+                std::cerr << "Missing value for " << Flag << "\n";
+                return 1;
+            }
+            const std::string_view Text{ ArgValues[Index + 1] };
+            bool Valid{ false };
+            if (Flag == "--workers") {
+                const std::optional<std::vector<std::size_t>> Values{ ParseList<std::size_t>(Text, ParseCount) };
+                Valid = Values.has_value();
+                if (Valid) {
+                    WorkerCounts = Values.value();
+                }
+            }
+            else if (Flag == "--profile") {
+                const std::optional<std::vector<asset::ImportProfile>> Values{ ParseList<asset::ImportProfile>(Text, asset::ParseImportProfile) };
+                Valid = Values.has_value();
+                if (Valid) {
+                    Profiles = Values.value();
+                }
+            }
+            else if (Flag == "--repeat") {
+                const std::optional<std::size_t> Value{ ParseCount(Text) };
+                Valid = Value.has_value() && Value.value() > 0;
+                if (Valid) {
+                    Repeat = Value.value();
+                }
+            }
+            else {
+                std::cerr << "Unknown option: " << Flag << "\n";
+                return 1;
+            }
+            if (!Valid) {
+                std::cerr << "Invalid value for " << Flag << ": " << Text << "\n";
+                return 1;
+            }
+        }
+        try {
+            BenchmarkParse(ArgValues[2], WorkerCounts, Profiles, Repeat);
+        }
+        catch (const std::exception& Exception) {
+            std::cerr << "Import failed: " << Exception.what() << "\n";
+            return 1;
+        }
+        return 0;
     }
 
     void BuildMaterialTextures(const std::vector<asset::Material>& Materials, std::vector<asset::Texture2D>& MaterialTextures) {
@@ -252,61 +518,270 @@ namespace {
         }
     }
 
-    void BuildModelEntries(const asset::ModelResult& Result, std::vector<ModelEntry>& Models) {
+    glm::mat4 ComputeWorldMatrix(const asset::ModelNode& Node) {
+        glm::mat4 World{ 1.0f };
+
+        std::vector<const asset::ModelNode*> Chain{ Node.GetChildChain() };
+
+        for (std::size_t Index{ 0 }; Index < Chain.size(); ++Index) {
+            const asset::ModelNode* Current{ Chain[Index] };
+            World = World * asset::ToGlmMat4(Current->GetNodeToParent());
+            World = World * asset::ToGlmMat4(Current->GetGeometryToNode());
+        }
+
+        return World;
+    }
+
+    // Groups Nodes by mesh in first-reference order. Entries come back
+    // non-resident with their instance transforms filled in, and upload
+    // into Arena.
+    void GroupModelEntries(const asset::ModelResult& Result, const std::vector<const asset::ModelNode*>& Nodes, asset::GeometryArena& Arena, std::vector<ModelEntry>& Models) {
+        constexpr std::size_t NoEntry{ static_cast<std::size_t>(-1) };
+        Models.clear();
+        std::vector<std::size_t> EntryIndices(Result.MeshCount(), NoEntry);
+        for (const asset::ModelNode* Node : Nodes) {
+            // Null for nodes without a mesh and for mesh indices past the table.
+            const asset::ModelMesh* Mesh{ Result.FindMesh(*Node) };
+            if (Mesh == nullptr) {
+                continue;
+            }
+            std::size_t& EntryIndex{ EntryIndices[Node->GetMeshIndex()] };
+            if (EntryIndex == NoEntry) {
+                EntryIndex = Models.size();
+                ModelEntry Entry{};
+                Entry.Model.SetArena(&Arena);
+                Entry.Mesh = Mesh;
+                Entry.GeometryIndex = Node->GetMeshIndex();
+                Entry.LodLevels = asset::BuildLodLevels(*Entry.Mesh);
+                Entry.Resident = false;
+                Models.push_back(std::move(Entry));
+            }
+            Models[EntryIndex].InstanceTransforms.push_back(ComputeWorldMatrix(*Node));
+        }
+    }
+
+    void BuildModelEntries(const asset::ModelResult& Result, asset::GeometryArena& Arena, std::vector<ModelEntry>& Models) {
         Models.clear();
         const asset::ModelNode* Root{ Result.GetRoot() };
         if (Root == nullptr) {
             return;
         }
+        std::vector<const asset::ModelNode*> Nodes{};
         std::vector<const asset::ModelNode*> Stack{};
         Stack.push_back(Root);
         while (!Stack.empty()) {
             const asset::ModelNode* Node{ Stack.back() };
             Stack.pop_back();
-            if (!Node->Vertices().Empty()) {
-                asset::Model ModelInstance{};
-                ModelInstance.Create(Node->Vertices(), Node->Indices(), GL_TRIANGLES);
-                ModelEntry Entry{};
-                Entry.Model = std::move(ModelInstance);
-                Entry.Node = Node;
-                Models.push_back(std::move(Entry));
-            }
+            Nodes.push_back(Node);
             const std::vector<asset::ModelNode*>& Children{ Node->GetChildren() };
             for (std::size_t Index{ Children.size() }; Index > 0; --Index) {
                 Stack.push_back(Children[Index - 1]);
             }
         }
+        GroupModelEntries(Result, Nodes, Arena, Models);
+        std::erase_if(Models, [](const ModelEntry& Entry) { return Entry.Mesh->Vertices().Empty(); });
+        for (ModelEntry& Entry : Models) {
+            Entry.Model.Create(Entry.Mesh->Vertices(), Entry.Mesh->Indices(), GL_TRIANGLES);
+            Entry.Model.SetInstanceTransforms(Entry.InstanceTransforms);
+            Entry.BoundsCenter = Entry.Model.GetBounds().Center();
+            Entry.BoundsRadius = Entry.Model.GetBoundingSphereRadius();
+            Entry.Resident = true;
+        }
+    }
+
+    // Geometry uploaded from a view since the last report. FloatBytes is what
+    // the same vertex streams take as float.
+    struct UploadStats final {
+    public:
+        std::size_t MeshCount{ 0 };
+        std::size_t VertexCount{ 0 };
+        std::size_t VertexBytes{ 0 };
+        std::size_t FloatBytes{ 0 };
+        std::size_t IndexBytes{ 0 };
+        double Seconds{ 0.0 };
+    };
+
+    // Streams go to the GPU in the format they are stored in, so quantised
+    // files and 16-bit indices upload fewer bytes.
+    void UploadGeometry(ModelEntry& Entry, const asset::GeometryView& Geometry, UploadStats& Stats) {
+        const auto Start{ std::chrono::steady_clock::now() };
+        const bool Created{ Geometry.ShortIndices.empty() ? Entry.Model.Create(Geometry.Packed, Geometry.Indices, GL_TRIANGLES) : Entry.Model.Create(Geometry.Packed, Geometry.ShortIndices, GL_TRIANGLES) };
+        if (!Created) {
+            return;
+        }
+        const std::chrono::duration<double> Elapsed{ std::chrono::steady_clock::now() - Start };
+        ++Stats.MeshCount;
+        Stats.VertexCount += Geometry.Packed.VertexCount();
+        Stats.VertexBytes += Geometry.Packed.ByteSize();
+        Stats.FloatBytes += Geometry.Packed.FloatByteSize();
+        Stats.IndexBytes += Geometry.Indices.size_bytes() + Geometry.ShortIndices.size_bytes();
+        Stats.Seconds += Elapsed.count();
+    }
+
+    // The time is what the driver took to accept the buffers on the CPU; the
+    // saving assumes float streams would have gone at the same rate.
+    void PrintUploadStats(const UploadStats& Stats) {
+        if (Stats.VertexCount == 0) {
+            return;
+        }
+        const double Milliseconds{ Stats.Seconds * 1000.0 };
+        const double MillisecondsPerByte{ Milliseconds / static_cast<double>(Stats.VertexBytes + Stats.IndexBytes) };
+        const double SavedMilliseconds{ MillisecondsPerByte * static_cast<double>(Stats.FloatBytes - Stats.VertexBytes) };
+        const double Megabytes{ static_cast<double>(Stats.VertexBytes + Stats.IndexBytes) / (1024.0 * 1024.0) };
+        std::cout << "[Upload] " << Stats.MeshCount << " meshes, " << std::fixed << std::setprecision(1)
+            << static_cast<double>(Stats.VertexBytes) / static_cast<double>(Stats.VertexCount) << " bytes/vertex ("
+            << static_cast<double>(Stats.FloatBytes) / static_cast<double>(Stats.VertexCount) << " as float), "
+            << Megabytes << " MB in " << std::setprecision(2) << Milliseconds << " ms, ~" << SavedMilliseconds << " ms saved\n" << std::defaultfloat;
+    }
+
+    void PrintArenaStats(const asset::GeometryArenaStats& Stats) {
+        constexpr double Megabyte{ 1024.0 * 1024.0 };
+        std::cout << "[Arena] " << Stats.SliceCount << " meshes in " << Stats.PoolCount << " pools, " << std::fixed << std::setprecision(1)
+            << static_cast<double>(Stats.VertexBytesUsed) / Megabyte << "/" << static_cast<double>(Stats.VertexBytesReserved) / Megabyte << " MB vertices, "
+            << static_cast<double>(Stats.IndexBytesUsed) / Megabyte << "/" << static_cast<double>(Stats.IndexBytesReserved) / Megabyte << " MB indices\n" << std::defaultfloat;
     }
 
-    bool LoadBinaryAsset(const std::string& Path, asset::AssetBundle& Bundle, std::vector<ModelEntry>& Models, std::vector<asset::Texture2D>& MaterialTextures) {
+    // Only the table of contents is read here. Meshes with stored bounds are
+    // left non-resident and uploaded straight from the mapping once visible.
+    void BuildModelEntries(asset::AssetBinaryView& View, const asset::ModelResult& Result, const std::vector<asset::ModelNode*>& Nodes, asset::GeometryArena& Arena, std::vector<ModelEntry>& Models, UploadStats& Uploads) {
+        GroupModelEntries(Result, std::vector<const asset::ModelNode*>{ Nodes.begin(), Nodes.end() }, Arena, Models);
+        std::erase_if(Models, [&](ModelEntry& Entry) {
+            const std::optional<asset::BinaryGeometryBounds> Bounds{ View.GetGeometryBounds(Entry.GeometryIndex) };
+            if (Bounds.has_value()) {
+                const glm::vec3 Min{ asset::ToGlmVec3(Bounds->Min) };
+                const glm::vec3 Max{ asset::ToGlmVec3(Bounds->Max) };
+                Entry.BoundsCenter = (Min + Max) * 0.5f;
+                Entry.BoundsRadius = glm::length(Max - Min) * 0.5f;
+                return false;
+            }
+            const asset::GeometryView Geometry{ View.GetGeometry(Entry.GeometryIndex) };
+            if (Geometry.Packed.Empty()) {
+                return true;
+            }
+            UploadGeometry(Entry, Geometry, Uploads);
+            Entry.Model.SetInstanceTransforms(Entry.InstanceTransforms);
+            Entry.BoundsCenter = Entry.Model.GetBounds().Center();
+            Entry.BoundsRadius = Entry.Model.GetBoundingSphereRadius();
+            View.ReleaseGeometry(Entry.GeometryIndex);
+            Entry.Resident = true;
+            return false;
+        });
+    }
+
+    bool LoadBinaryAsset(const std::string& Path, asset::AssetBinaryView& SceneView, asset::AssetBundle& Bundle, asset::GeometryArena& Arena, std::vector<ModelEntry>& Models, std::vector<asset::Texture2D>& MaterialTextures, UploadStats& Uploads) {
         Fs::path FilePath{ Path };
         if (FilePath.extension() != ".fbxbin") {
             std::cout << "Wrong file type - " << Path << "\nOnly .fbxbin files are supported.\n";
             return false;
         }
+        asset::AssetBinaryView View{};
+        if (View.Open(Path)) {
+            const std::vector<asset::ModelNode*> Nodes{ View.LoadHierarchy(Bundle) };
+            SceneView = std::move(View);
+            BuildMaterialTextures(Bundle.GetMaterials(), MaterialTextures);
+            BuildModelEntries(SceneView, Bundle.GetModelResult(), Nodes, Arena, Models, Uploads);
+            std::cout << "[Drop] " << Path << "\n";
+            return true;
+        }
         asset::AssetBinaryReader Reader{};
         if (!Reader.ReadFromFile(Path, Bundle)) {
             std::cout << "Failed to load binary asset: " << Path << "\n";
             return false;
         }
+        SceneView.Close();
         BuildMaterialTextures(Bundle.GetMaterials(), MaterialTextures);
-        BuildModelEntries(Bundle.GetModelResult(), Models);
+        BuildModelEntries(Bundle.GetModelResult(), Arena, Models);
         std::cout << "[Drop] " << Path << "\n";
         return true;
     }
 
-    glm::mat4 ComputeWorldMatrix(const asset::ModelNode& Node) {
-        glm::mat4 World{ 1.0f };
+    void StreamVisibleModels(asset::AssetBinaryView& SceneView, std::vector<ModelEntry>& Models, const glm::mat4& ViewProjection, UploadStats& Uploads) {
+        const asset::FrustumPlanes Planes{ asset::ExtractFrustumPlanes(ViewProjection) };
+        for (ModelEntry& Entry : Models) {
+            if (Entry.Resident) {
+                continue;
+            }
+            const bool Visible{ std::any_of(Entry.InstanceTransforms.begin(), Entry.InstanceTransforms.end(), [&](const glm::mat4& World) {
+                const glm::vec3 Center{ World * glm::vec4{ Entry.BoundsCenter, 1.0f } };
+                return asset::SphereInFrustum(Planes, Center, Entry.BoundsRadius * asset::MaxAxisScale(World));
+            }) };
+            if (!Visible) {
+                continue;
+            }
+            const asset::GeometryView Geometry{ SceneView.GetGeometry(Entry.GeometryIndex) };
+            UploadGeometry(Entry, Geometry, Uploads);
+            Entry.Model.SetInstanceTransforms(Entry.InstanceTransforms);
+            SceneView.ReleaseGeometry(Entry.GeometryIndex);
+            Entry.Resident = true;
+        }
+    }
 
-        std::vector<const asset::ModelNode*> Chain{ Node.GetChildChain() };
+    // Selects a level for every instance and re-uploads the instances grouped
+    // by level when the selection changed since the last frame. Without LODs,
+    // or with Enabled false, every instance is drawn at level 0.
+    void AssignLodLevels(ModelEntry& Entry, asset::LodSelector& Selector, bool Enabled) {
+        if (!Enabled || Entry.LodLevels.empty()) {
+            if (!Entry.InstanceLevels.empty()) {
+                Entry.InstanceLevels.clear();
+                Entry.Model.SetInstanceTransforms(Entry.InstanceTransforms);
+            }
+            Entry.LevelInstanceCounts.assign(1, Entry.InstanceTransforms.size());
+            return;
+        }
+        Entry.SelectedLevels.clear();
+        for (const glm::mat4& World : Entry.InstanceTransforms) {
+            Entry.SelectedLevels.push_back(Selector.Select(Entry.LodLevels, World, Entry.BoundsCenter, Entry.BoundsRadius));
+        }
+        if (Entry.SelectedLevels == Entry.InstanceLevels) {
+            return;
+        }
+        std::swap(Entry.SelectedLevels, Entry.InstanceLevels);
+        Entry.LevelInstanceCounts.assign(Entry.LodLevels.size(), 0);
+        for (const std::size_t Level : Entry.InstanceLevels) {
+            ++Entry.LevelInstanceCounts[Level];
+        }
+        std::vector<std::size_t> Next(Entry.LodLevels.size(), 0);
+        for (std::size_t Level{ 1 }; Level < Next.size(); ++Level) {
+            Next[Level] = Next[Level - 1] + Entry.LevelInstanceCounts[Level - 1];
+        }
+        Entry.SortedTransforms.resize(Entry.InstanceTransforms.size());
+        for (std::size_t Instance{ 0 }; Instance < Entry.InstanceTransforms.size(); ++Instance) {
+            Entry.SortedTransforms[Next[Entry.InstanceLevels[Instance]]++] = Entry.InstanceTransforms[Instance];
+        }
+        Entry.Model.SetInstanceTransforms(Entry.SortedTransforms);
+    }
 
-        for (std::size_t Index{ 0 }; Index < Chain.size(); ++Index) {
-            const asset::ModelNode* Current{ Chain[Index] };
-            World = World * asset::ToGlmMat4(Current->GetNodeToParent());
-            World = World * asset::ToGlmMat4(Current->GetGeometryToNode());
+    // Submits the meshlets of [IndexOffset, IndexOffset + IndexCount) that
+    // survive culling for InstanceCount instances from FirstInstance;
+    // Meshlets is sorted by IndexOffset. BaseVertex is that of the SubMesh.
+    void DrawCulledRange(const asset::Model& ModelInstance, const std::vector<asset::ModelMesh::Meshlet>& Meshlets, std::size_t IndexOffset, std::size_t IndexCount, std::size_t BaseVertex, std::size_t FirstInstance, std::size_t InstanceCount, asset::MeshletCuller& Culler, std::vector<asset::IndexRange>& Ranges) {
+        const auto First{ std::lower_bound(Meshlets.begin(), Meshlets.end(), IndexOffset, [](const asset::ModelMesh::Meshlet& Meshlet, std::size_t Offset) { return Meshlet.IndexOffset < Offset; }) };
+        const auto Last{ std::lower_bound(First, Meshlets.end(), IndexOffset + IndexCount, [](const asset::ModelMesh::Meshlet& Meshlet, std::size_t Offset) { return Meshlet.IndexOffset < Offset; }) };
+        Ranges.clear();
+        Culler.Cull(std::span<const asset::ModelMesh::Meshlet>{ First, Last }, Ranges);
+        for (const asset::IndexRange& Range : Ranges) {
+            ModelInstance.DrawRangeInstanced(Range.IndexOffset, Range.IndexCount, FirstInstance, InstanceCount, BaseVertex);
         }
+    }
 
-        return World;
+    void PrintMeshletStats(const asset::MeshletCullStats& Stats) {
+        if (Stats.TriangleCount == 0) {
+            return;
+        }
+        std::cout << "[Meshlets] drew " << Stats.SubmittedTriangles() << " of " << Stats.TriangleCount << " triangles; culled "
+            << Stats.CulledMeshletCount << " of " << Stats.MeshletCount << " meshlets (frustum " << Stats.FrustumCulledTriangles
+            << " tris, backface " << Stats.BackfaceCulledTriangles << " tris)\n";
+    }
+
+    void PrintLodStats(const asset::LodStats& Stats) {
+        if (Stats.FullTriangles == 0) {
+            return;
+        }
+        std::cout << "[LOD] drew " << Stats.SubmittedTriangles << " of " << Stats.FullTriangles << " triangles; instances per level";
+        for (const std::size_t Count : Stats.InstancesPerLevel) {
+            std::cout << " " << Count;
+        }
+        std::cout << "\n";
     }
 
     std::string FindSystemFontTtf() {
@@ -374,66 +849,19 @@ namespace {
 }
 
 int main(int ArgCount, char** ArgValues) {
+    if (ArgCount > 1 && std::string_view{ ArgValues[1] } == "--convert") {
+        return RunHeadlessConvert(ArgCount, ArgValues);
+    }
+    if (ArgCount > 1 && std::string_view{ ArgValues[1] } == "--bench-parse") {
+        return RunParseBenchmark(ArgCount, ArgValues);
+    }
+
 #ifndef _DEBUG
     if (ArgCount > 1) {
-        const std::string ListPath{ ArgValues[1] };
-        const std::vector<std::string> Entries{ LoadListEntries(ListPath) };
-        if (Entries.empty()) {
-            std::cout << "No entries found in list file: " << ListPath << "\n";
-        }
-        const Fs::path BaseDir{ Fs::path{ ListPath }.parent_path() };
-        for (std::size_t Index{ 0 }; Index < Entries.size(); ++Index) {
-            Fs::path FbxPath{ Entries[Index] };
-            if (FbxPath.is_relative()) {
-                FbxPath = BaseDir / FbxPath;
-            }
-            if (!Fs::exists(FbxPath)) {
-                std::cout << "Missing FBX file: " << FbxPath.string() << "\n";
-                continue;
-            }
-            const std::string Extension{ FbxPath.extension().string() };
-            if (Extension != ".fbx" && Extension != ".FBX") {
-                std::cout << "Skipping non-FBX entry: " << FbxPath.string() << "\n";
-                continue;
-            }
-            const Fs::path BinaryPath{ MakeBinaryPath(FbxPath) };
-            if (ConvertFbxToBinary(FbxPath, BinaryPath)) {
-                std::cout << "Binary saved: " << BinaryPath.string() << "\n";
-            }
-            else {
-                std::cout << "Binary save failed: " << BinaryPath.string() << "\n";
-            }
-        }
+        ConvertListFile(Fs::path{ ArgValues[1] }, asset::BatchConvertOptions{});
     }
 #else 
-    const std::string ListPath{ "Asset/list.txt" };
-    const std::vector<std::string> Entries{ LoadListEntries(ListPath) };
-    if (Entries.empty()) {
-        std::cout << "No entries found in list file: " << ListPath << "\n";
-    }
-    const Fs::path BaseDir{ Fs::path{ ListPath }.parent_path() };
-    for (std::size_t Index{ 0 }; Index < Entries.size(); ++Index) {
-        Fs::path FbxPath{ Entries[Index] };
-        if (FbxPath.is_relative()) {
-            FbxPath = BaseDir / FbxPath;
-        }
-        if (!Fs::exists(FbxPath)) {
-            std::cout << "Missing FBX file: " << FbxPath.string() << "\n";
-            continue;
-        }
-        const std::string Extension{ FbxPath.extension().string() };
-        if (Extension != ".fbx" && Extension != ".FBX") {
-            std::cout << "Skipping non-FBX entry: " << FbxPath.string() << "\n";
-            continue;
-        }
-        const Fs::path BinaryPath{ MakeBinaryPath(FbxPath) };
-        if (ConvertFbxToBinary(FbxPath, BinaryPath)) {
-            std::cout << "Binary saved: " << BinaryPath.string() << "\n";
-        }
-        else {
-            std::cout << "Binary save failed: " << BinaryPath.string() << "\n";
-        }
-    }
+    ConvertListFile(Fs::path{ "Asset/list.txt" }, asset::BatchConvertOptions{});
 #endif 
 
     if (!glfwInit()) {
@@ -534,9 +962,23 @@ int main(int ArgCount, char** ArgValues) {
     asset::Model AxisModel{ CreateAxisModel() };
     asset::Model CubeModel{ CreateTexturedCube() };
 
+    // Holds the geometry of every entry in Models, so it is declared first
+    // and outlives them.
+    asset::GeometryArena Arena{};
     std::vector<ModelEntry> Models{};
     std::vector<asset::Texture2D> MaterialTextures{};
     asset::AssetBundle Bundle{};
+    asset::AssetBinaryView SceneView{};
+    asset::MeshletCuller Culler{};
+    std::vector<asset::IndexRange> CulledRanges{};
+    asset::LodSelector Lods{};
+    // M toggles meshlet culling and L LOD selection; their stats are printed
+    // once per second.
+    bool MeshletCulling{ true };
+    bool LodSelection{ true };
+    // Uploads from the view are reported with the same once-per-second stats.
+    UploadStats Uploads{};
+    float StatsSeconds{ 0.0f };
 
     glm::vec3 LightPosition{ 2.0f, 1.5f, 2.0f };
     glm::vec3 LightColor{ 1.0f, 1.0f, 1.0f };
@@ -552,7 +994,7 @@ int main(int ArgCount, char** ArgValues) {
         {
             const auto Dropped{ InputHandler.ConsumeDroppedFiles() };
             for (const auto& Path : Dropped) {
-                LoadBinaryAsset(Path, Bundle, Models, MaterialTextures);
+                LoadBinaryAsset(Path, SceneView, Bundle, Arena, Models, MaterialTextures, Uploads);
             }
 
         }
@@ -560,6 +1002,14 @@ int main(int ArgCount, char** ArgValues) {
         if (InputHandler.KeyPressed(GLFW_KEY_ESCAPE)) {
             glfwSetWindowShouldClose(Window, GLFW_TRUE);
         }
+        if (InputHandler.KeyPressed(GLFW_KEY_M)) {
+            MeshletCulling = !MeshletCulling;
+            std::cout << "[Meshlets] culling " << (MeshletCulling ? "on" : "off") << "\n";
+        }
+        if (InputHandler.KeyPressed(GLFW_KEY_L)) {
+            LodSelection = !LodSelection;
+            std::cout << "[LOD] selection " << (LodSelection ? "on" : "off") << "\n";
+        }
 
         if (InputHandler.MouseDown(GLFW_MOUSE_BUTTON_LEFT)) {
             const glm::vec2 Delta{ InputHandler.MouseDelta() };
@@ -616,6 +1066,7 @@ int main(int ArgCount, char** ArgValues) {
 
         LitShader.Use();
         LitShader.SetMat4("uModel", glm::mat4{ 1.0f });
+        LitShader.SetInt("uInstanced", 0);
         LitShader.SetMat4("uView", View);
         LitShader.SetMat4("uProj", Projection);
         LitShader.SetVec3("uCameraPos", CameraInstance.Position());
@@ -636,11 +1087,16 @@ int main(int ArgCount, char** ArgValues) {
             CubeModel.Draw();
         }
 
+        StreamVisibleModels(SceneView, Models, Projection * View, Uploads);
+        LitShader.SetInt("uInstanced", 1);
+        Culler.Begin(Projection * View, CameraInstance.Position());
+        Lods.Begin(CameraInstance.Position(), CameraInstance.FovYRadians(), static_cast<float>(FramebufferHeight));
+
         for (ModelEntry& Entry : Models) {
+            if (!Entry.Resident) {
+                continue;
+            }
             asset::Model& ModelInstance{ Entry.Model };
-            const asset::ModelNode* Node{ Entry.Node };
-            const glm::mat4 ModelMatrix{ ComputeWorldMatrix(*Node) };
-            LitShader.SetMat4("uModel", ModelMatrix);
             auto BindMaterialTexture = [&](std::size_t MaterialIndex) {
                 if (MaterialIndex < MaterialTextures.size() && MaterialTextures[MaterialIndex].Id() != 0) {
                     MaterialTextures[MaterialIndex].Bind(0);
@@ -656,18 +1112,61 @@ int main(int ArgCount, char** ArgValues) {
                     glBindTexture(GL_TEXTURE_2D, 0);
                 }
             };
-            const std::vector<asset::ModelNode::SubMesh>& SubMeshes{ Node->GetSubMeshes() };
+            AssignLodLevels(Entry, Lods, LodSelection);
+            // Meshlets only cover level 0, the first group of instances.
+            const std::vector<glm::mat4>& Uploaded{ Entry.InstanceLevels.empty() ? Entry.InstanceTransforms : Entry.SortedTransforms };
+            const std::size_t FullDetailInstances{ Entry.LevelInstanceCounts.front() };
+            const std::vector<asset::ModelMesh::Meshlet>& Meshlets{ Entry.Mesh->Meshlets() };
+            const bool CullMeshlets{ MeshletCulling && !Meshlets.empty() && FullDetailInstances > 0 };
+            if (CullMeshlets) {
+                Culler.SetInstances(std::span<const glm::mat4>{ Uploaded }.first(FullDetailInstances));
+            }
+            const std::vector<asset::ModelMesh::SubMesh>& SubMeshes{ Entry.Mesh->GetSubMeshes() };
             if (SubMeshes.empty()) {
                 BindFallbackTexture();
-                ModelInstance.Draw();
+                if (CullMeshlets) {
+                    DrawCulledRange(ModelInstance, Meshlets, 0, Meshlets.back().IndexOffset + Meshlets.back().IndexCount, 0, 0, FullDetailInstances, Culler, CulledRanges);
+                    continue;
+                }
+                ModelInstance.DrawInstanced();
                 continue;
             }
-            for (const asset::ModelNode::SubMesh& SubMesh : SubMeshes) {
-                if (!BindMaterialTexture(SubMesh.MaterialIndex)) {
-                    BindFallbackTexture();
+            std::size_t FirstInstance{ 0 };
+            for (std::size_t Level{ 0 }; Level < Entry.LevelInstanceCounts.size(); ++Level) {
+                const std::size_t InstanceCount{ Entry.LevelInstanceCounts[Level] };
+                if (InstanceCount == 0) {
+                    continue;
+                }
+                const std::vector<asset::ModelMesh::SubMesh>& Ranges{ Entry.LodLevels.empty() ? SubMeshes : Entry.LodLevels[Level].Ranges };
+                for (const asset::ModelMesh::SubMesh& Range : Ranges) {
+                    if (!BindMaterialTexture(Range.MaterialIndex)) {
+                        BindFallbackTexture();
+                    }
+                    if (Level == 0 && CullMeshlets) {
+                        DrawCulledRange(ModelInstance, Meshlets, Range.IndexOffset, Range.IndexCount, Range.BaseVertex, FirstInstance, InstanceCount, Culler, CulledRanges);
+                        continue;
+                    }
+                    ModelInstance.DrawRangeInstanced(Range.IndexOffset, Range.IndexCount, FirstInstance, InstanceCount, Range.BaseVertex);
                 }
-                ModelInstance.DrawRange(SubMesh.IndexOffset, SubMesh.IndexCount);
+                FirstInstance += InstanceCount;
+            }
+        }
+        Arena.EndDraws();
+
+        StatsSeconds += DeltaTime;
+        if (StatsSeconds >= 1.0f) {
+            if (MeshletCulling) {
+                PrintMeshletStats(Culler.GetStats());
+            }
+            if (LodSelection) {
+                PrintLodStats(Lods.GetStats());
+            }
+            if (Uploads.MeshCount > 0) {
+                PrintArenaStats(Arena.GetStats());
             }
+            PrintUploadStats(Uploads);
+            Uploads = UploadStats{};
+            StatsSeconds = 0.0f;
         }
 
         glfwSwapBuffers(Window);
@@ -10,6 +10,9 @@ layout(location = 7) in vec3 aTangent;
 layout(location = 8) in vec3 aBitangent;
 layout(location = 9) in uvec4 aBoneIndex;
 layout(location = 10) in vec4 aBoneWeight;
+layout(location = 11) in mat4 aInstanceModel;
+// 1 when aNormal holds an octahedral snorm16 pair in xy instead of a vector.
+layout(location = 15) in float aOctahedralNormal;
 
 
 out VS_OUT
@@ -21,16 +24,28 @@ out VS_OUT
 } vs_out;
 
 uniform mat4 uModel;
+uniform int uInstanced;
 uniform mat4 uView;
 uniform mat4 uProj;
 
+vec3 OctahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += (n.x >= 0.0) ? -t : t;
+    n.y += (n.y >= 0.0) ? -t : t;
+    return normalize(n);
+}
+
 void main()
 {
-    vec4 world = uModel * vec4(aPos, 1.0);
+    mat4 model = (uInstanced != 0) ? aInstanceModel : uModel;
+    vec4 world = model * vec4(aPos, 1.0);
     vs_out.WorldPos = world.xyz;
 
-    mat3 nrmMat = mat3(transpose(inverse(uModel)));
-    vs_out.WorldNormal = normalize(nrmMat * aNormal);
+    mat3 nrmMat = mat3(transpose(inverse(model)));
+    vec3 normal = (aOctahedralNormal != 0.0) ? OctahedralDecode(aNormal.xy) : aNormal;
+    vs_out.WorldNormal = normalize(nrmMat * normal);
 
     vs_out.UV = aUV1;
     vs_out.Color = aColor;